@@ -1,2 +1,2 @@
 #! /bin/sh
-g++ src/*.cpp src/imgui/*.cpp -o bin/linux/SDL2GamepadTest.x86_64 -lSDL2 
+g++ src/*.cpp src/imgui/*.cpp -o bin/linux/SDL2GamepadTest.x86_64 -lSDL2 -pthread -lrt
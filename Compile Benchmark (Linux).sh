@@ -0,0 +1,11 @@
+#! /bin/sh
+g++ -O2 tools/renderer_benchmark.cpp src/imgui/*.cpp -o bin/linux/RendererBenchmark.x86_64 -lSDL2 -pthread
+g++ -O2 tools/hash_benchmark.cpp src/imgui/*.cpp -o bin/linux/HashBenchmark.x86_64 -lSDL2 -pthread
+g++ -O2 tools/tessellation_benchmark.cpp src/imgui/*.cpp -o bin/linux/TessellationBenchmark.x86_64 -lSDL2 -pthread
+g++ -O2 tools/mapping_benchmark.cpp -o bin/linux/MappingBenchmark.x86_64 -lSDL2
+g++ -O2 tools/action_benchmark.cpp -o bin/linux/ActionBenchmark.x86_64 -lSDL2
+g++ -O2 tools/combo_benchmark.cpp -o bin/linux/ComboBenchmark.x86_64 -lSDL2
+g++ -O2 tools/shared_pad_benchmark.cpp -o bin/linux/SharedPadBenchmark.x86_64 -pthread -lrt
+g++ -O2 tools/dsu_benchmark.cpp -o bin/linux/DSUBenchmark.x86_64 -lSDL2
+g++ -O2 tools/calibration_benchmark.cpp -o bin/linux/CalibrationBenchmark.x86_64 -lSDL2
+g++ -O2 tools/report_rate_benchmark.cpp -o bin/linux/ReportRateBenchmark.x86_64 -lSDL2 -pthread
@@ -0,0 +1,426 @@
+#pragma once
+#include "sdl_gamepad.h"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Turns SDLGamepadState into game actions ("Jump", "Fire", "Pause"...) through a binding table, so that consumers don't test
+// state.A and state.LeftTrigger one by one. A binding is a chord of buttons that must be down, buttons that must be up (to keep
+// "A" and "LB + A" apart), and axis thresholds. An action is on when any of its bindings matches.
+//
+// Bindings get compiled when the table is loaded: every distinct axis threshold becomes a bit above the 21 button bits, and
+// every binding a pair of 64 bit masks. Each input tick, a pad's state is packed into one 64 bit word, and a binding matches when
+// (input & required) == required && (input & forbidden) == 0. A table that is known at compile time can go through
+// compileActionBindings() as a constexpr, which leaves no compiling at run time, and can be evaluated with packActionInput() and
+// evaluateActionBindings() directly (which is what ActionMap does with a table loaded at run time).
+namespace GamepadInput {
+    enum Button : uint64_t {
+        None = 0,
+        A = 1ull << 0,
+        B = 1ull << 1,
+        X = 1ull << 2,
+        Y = 1ull << 3,
+        DPadUp = 1ull << 4,
+        DPadDown = 1ull << 5,
+        DPadLeft = 1ull << 6,
+        DPadRight = 1ull << 7,
+        LeftShoulder = 1ull << 8,
+        RightShoulder = 1ull << 9,
+        LeftStickClick = 1ull << 10,
+        RightStickClick = 1ull << 11,
+        Start = 1ull << 12,
+        Back = 1ull << 13,
+        Guide = 1ull << 14,
+        Touchpad = 1ull << 15,
+        Misc = 1ull << 16,
+        Paddle1 = 1ull << 17,
+        Paddle2 = 1ull << 18,
+        Paddle3 = 1ull << 19,
+        Paddle4 = 1ull << 20,
+    };
+    static constexpr int buttonCount = 21;
+    static constexpr const char * buttonNames[buttonCount] = {
+        "A", "B", "X", "Y", "DPadUp", "DPadDown", "DPadLeft", "DPadRight", "LeftShoulder", "RightShoulder", "LeftStickClick",
+        "RightStickClick", "Start", "Back", "Guide", "Touchpad", "Misc", "Paddle1", "Paddle2", "Paddle3", "Paddle4",
+    };
+
+    enum Axis : uint8_t {
+        LeftX,
+        LeftY,
+        RightX,
+        RightY,
+        LeftTrigger,
+        RightTrigger,
+        AxisCount,
+    };
+    static constexpr const char * axisNames[AxisCount] = {"LeftX", "LeftY", "RightX", "RightY", "LeftTrigger", "RightTrigger"};
+
+    // Axis thresholds take the bits above the buttons (the upper half of the word, leaving the bits in between free).
+    static constexpr int firstThresholdBit = 32;
+    static constexpr int maxThresholds = 32;
+
+    // Which side of a threshold an axis has to be on.
+    enum Comparison : uint8_t {
+        Greater,
+        Less,
+    };
+
+    inline uint64_t packButtons(const SDLGamepadState & state){
+        return uint64_t(state.A != 0) | uint64_t(state.B != 0) << 1 | uint64_t(state.X != 0) << 2 | uint64_t(state.Y != 0) << 3
+            | uint64_t(state.DPadUp != 0) << 4 | uint64_t(state.DPadDown != 0) << 5 | uint64_t(state.DPadLeft != 0) << 6
+            | uint64_t(state.DPadRight != 0) << 7 | uint64_t(state.LeftShoulder != 0) << 8 | uint64_t(state.RightShoulder != 0) << 9
+            | uint64_t(state.LeftStickClick != 0) << 10 | uint64_t(state.RightStickClick != 0) << 11 | uint64_t(state.Start != 0) << 12
+            | uint64_t(state.Back != 0) << 13 | uint64_t(state.Guide != 0) << 14 | uint64_t(state.Touchpad != 0) << 15
+            | uint64_t(state.Misc != 0) << 16 | uint64_t(state.Paddle1 != 0) << 17 | uint64_t(state.Paddle2 != 0) << 18
+            | uint64_t(state.Paddle3 != 0) << 19 | uint64_t(state.Paddle4 != 0) << 20;
+    }
+
+    inline void packAxes(const SDLGamepadState & state, float axes[AxisCount]){
+        axes[LeftX] = state.LeftStick.x;
+        axes[LeftY] = state.LeftStick.y;
+        axes[RightX] = state.RightStick.x;
+        axes[RightY] = state.RightStick.y;
+        axes[LeftTrigger] = state.LeftTrigger;
+        axes[RightTrigger] = state.RightTrigger;
+    }
+}
+
+// An axis is past a threshold when it is above it (Greater) or below it (Less), whatever the sign of the threshold: LeftY < -0.5
+// is the stick pushed up, LeftY < 0 is it pushed up at all, and RightTrigger > 0 is the trigger pulled at all.
+struct AxisThreshold{
+    GamepadInput::Axis axis = GamepadInput::LeftX;
+    GamepadInput::Comparison comparison = GamepadInput::Greater;
+    float value = 0.0f;
+
+    constexpr bool operator==(const AxisThreshold & other) const{
+        return axis == other.axis && comparison == other.comparison && value == other.value;
+    }
+};
+
+// One row of a binding table. Up to two axis thresholds, which all have to be past for the binding to match.
+struct ActionBinding{
+    int action = 0;
+    uint64_t buttons = GamepadInput::None;      // All of these down
+    uint64_t without = GamepadInput::None;      // None of these down
+    int thresholdCount = 0;
+    AxisThreshold thresholds[2] = {};
+
+    constexpr ActionBinding() = default;
+    constexpr ActionBinding(int bindingAction, uint64_t down, uint64_t up = GamepadInput::None): action(bindingAction), buttons(down), without(up){}
+    constexpr ActionBinding(int bindingAction, uint64_t down, AxisThreshold threshold, uint64_t up = GamepadInput::None):
+        action(bindingAction), buttons(down), without(up), thresholdCount(1), thresholds{threshold, {}}{}
+    constexpr ActionBinding(int bindingAction, uint64_t down, AxisThreshold first, AxisThreshold second, uint64_t up = GamepadInput::None):
+        action(bindingAction), buttons(down), without(up), thresholdCount(2), thresholds{first, second}{}
+};
+
+struct CompiledActionBinding{
+    uint64_t required = 0;
+    uint64_t forbidden = 0;
+    int action = 0;
+};
+
+// A compiled table with room for a fixed number of bindings and thresholds, so that it can be built as a constexpr.
+// ok is false if the table needs more than 32 distinct thresholds, or has an action out of range.
+template <size_t BindingCount> struct ActionProgram{
+    std::array<CompiledActionBinding, BindingCount> bindings{};
+    std::array<AxisThreshold, GamepadInput::maxThresholds> thresholds{};
+    int bindingCount = 0;
+    int thresholdCount = 0;
+    int actionCount = 0;
+    bool ok = true;
+};
+
+// Shared by the constexpr and the run time compilers: returns the bit of a threshold, adding it to the table if it's new,
+// or -1 when the table is full.
+template <typename Thresholds> constexpr int actionThresholdBit(Thresholds & thresholds, int & thresholdCount, const AxisThreshold & threshold){
+    for (int i = 0; i < thresholdCount; i++){
+        if (thresholds[i] == threshold){
+            return GamepadInput::firstThresholdBit + i;
+        }
+    }
+    if (thresholdCount == GamepadInput::maxThresholds){
+        return -1;
+    }
+    thresholds[thresholdCount] = threshold;
+    return GamepadInput::firstThresholdBit + thresholdCount++;
+}
+
+template <typename Thresholds> constexpr bool compileActionBinding(const ActionBinding & binding, Thresholds & thresholds, int & thresholdCount,
+    CompiledActionBinding & compiled){
+    compiled.required = binding.buttons;
+    compiled.forbidden = binding.without;
+    compiled.action = binding.action;
+    for (int i = 0; i < binding.thresholdCount; i++){
+        int bit = actionThresholdBit(thresholds, thresholdCount, binding.thresholds[i]);
+        if (bit < 0){
+            return false;
+        }
+        compiled.required |= 1ull << bit;
+    }
+    return binding.action >= 0;
+}
+
+// E.g. static constexpr auto program = compileActionBindings(table); static_assert(program.ok);
+template <size_t BindingCount> constexpr ActionProgram<BindingCount> compileActionBindings(const ActionBinding (&table)[BindingCount]){
+    ActionProgram<BindingCount> program;
+    for (size_t i = 0; i < BindingCount; i++){
+        program.ok = compileActionBinding(table[i], program.thresholds, program.thresholdCount, program.bindings[i]) && program.ok;
+        program.actionCount = table[i].action + 1 > program.actionCount ? table[i].action + 1 : program.actionCount;
+    }
+    program.bindingCount = int(BindingCount);
+    return program;
+}
+
+// Packs a pad's buttons and the thresholds of a program into one input word.
+template <typename Thresholds> inline uint64_t packActionInput(const Thresholds & thresholds, int thresholdCount, const SDLGamepadState & state){
+    uint64_t input = GamepadInput::packButtons(state);
+    float axes[GamepadInput::AxisCount];
+    GamepadInput::packAxes(state, axes);
+    for (int i = 0; i < thresholdCount; i++){
+        const AxisThreshold & threshold = thresholds[i];
+        const float value = axes[threshold.axis];
+        const bool past = threshold.comparison == GamepadInput::Greater ? value > threshold.value : value < threshold.value;
+        input |= uint64_t(past) << (GamepadInput::firstThresholdBit + i);
+    }
+    return input;
+}
+
+// Sets the bit of every action that has a binding matching the input. The action bits must be cleared beforehand.
+// With a static constexpr ActionProgram, the masks are constants and the loop can be unrolled into plain bit tests.
+template <typename Bindings> inline void evaluateActionBindings(const Bindings & bindings, int bindingCount, uint64_t input, uint64_t * actions){
+    for (int i = 0; i < bindingCount; i++){
+        const CompiledActionBinding & binding = bindings[i];
+        const bool matches = ((input & binding.required) == binding.required) & ((input & binding.forbidden) == 0);
+        actions[binding.action >> 6] |= uint64_t(matches) << (binding.action & 63);
+    }
+}
+
+// The action state of every pad, updated from a compiled table once per input tick. Actions are bits, so actionPressed() and
+// friends are a shift and a mask.
+class ActionMap{
+private:
+    struct PadActions{
+        SDL_JoystickID id;
+        std::vector<uint64_t> current;
+        std::vector<uint64_t> previous;
+        bool seen;
+    };
+
+    std::vector<CompiledActionBinding> bindings;
+    std::vector<AxisThreshold> thresholds;
+    std::vector<std::string> actionNames;
+    int actionCount = 0;
+    int words = 0;
+    std::vector<PadActions> pads;
+
+    const PadActions * find(SDL_JoystickID pad) const{
+        for (const PadActions & actions: pads){
+            if (actions.id == pad){
+                return &actions;
+            }
+        }
+        return nullptr;
+    }
+
+    static bool testBit(const std::vector<uint64_t> & bits, int action){
+        return (bits[size_t(action) >> 6] >> (action & 63)) & 1;
+    }
+
+    void resize(int count){
+        actionCount = count;
+        words = (count + 63) / 64;
+        pads.clear();
+    }
+
+    // The parser for loadText(). Returns false on an unknown name.
+    static bool parseTerm(const std::string & term, ActionBinding & binding){
+        bool negate = !term.empty() && term[0] == '!';
+        std::string name = term.substr(negate ? 1 : 0);
+        size_t comparison = name.find_first_of("<>");
+        if (comparison != std::string::npos){
+            if (negate || binding.thresholdCount == 2){
+                return false;
+            }
+            std::string axis = name.substr(0, comparison);
+            for (int i = 0; i < GamepadInput::AxisCount; i++){
+                if (axis == GamepadInput::axisNames[i]){
+                    char * end;
+                    float value = strtof(name.c_str() + comparison + 1, &end);
+                    if (end == name.c_str() + comparison + 1 || *end != '\0'){
+                        return false;
+                    }
+                    binding.thresholds[binding.thresholdCount++] = {GamepadInput::Axis(i),
+                        name[comparison] == '>' ? GamepadInput::Greater : GamepadInput::Less, value};
+                    return true;
+                }
+            }
+            return false;
+        }
+        for (int i = 0; i < GamepadInput::buttonCount; i++){
+            if (name == GamepadInput::buttonNames[i]){
+                (negate ? binding.without : binding.buttons) |= 1ull << i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    // Replaces the bindings. Returns false (and keeps the previous ones) if the table doesn't fit in the threshold bits.
+    bool load(const ActionBinding * table, size_t count){
+        std::vector<CompiledActionBinding> newBindings(count);
+        std::vector<AxisThreshold> newThresholds(GamepadInput::maxThresholds);
+        int thresholdCount = 0;
+        int newActionCount = 0;
+        for (size_t i = 0; i < count; i++){
+            if (!compileActionBinding(table[i], newThresholds, thresholdCount, newBindings[i])){
+                return false;
+            }
+            newActionCount = table[i].action + 1 > newActionCount ? table[i].action + 1 : newActionCount;
+        }
+        newThresholds.resize(thresholdCount);
+        bindings.swap(newBindings);
+        thresholds.swap(newThresholds);
+        actionNames.clear();
+        resize(newActionCount);
+        return true;
+    }
+
+    template <size_t BindingCount> bool load(const ActionProgram<BindingCount> & program){
+        if (!program.ok){
+            return false;
+        }
+        bindings.assign(program.bindings.begin(), program.bindings.begin() + program.bindingCount);
+        thresholds.assign(program.thresholds.begin(), program.thresholds.begin() + program.thresholdCount);
+        actionNames.clear();
+        resize(program.actionCount);
+        return true;
+    }
+
+    // Loads bindings from text, one per line: "<action> = <term> + <term>...", where a term is a button ("A"), a button that
+    // must be up ("!LeftShoulder"), or an axis threshold ("RightTrigger > 0.5", "LeftY < -0.5"). Actions are numbered in the
+    // order they first appear, see actionIndex(). Lines starting with '#' are comments.
+    bool loadText(const std::string & text){
+        std::vector<ActionBinding> table;
+        std::vector<std::string> names;
+        size_t lineStart = 0;
+        while (lineStart < text.size()){
+            size_t lineEnd = text.find('\n', lineStart);
+            lineEnd = lineEnd == std::string::npos ? text.size() : lineEnd;
+            std::string line;
+            for (size_t i = lineStart; i < lineEnd; i++){
+                if (text[i] != ' ' && text[i] != '\t' && text[i] != '\r'){
+                    line += text[i];
+                }
+            }
+            lineStart = lineEnd + 1;
+            if (line.empty() || line[0] == '#'){
+                continue;
+            }
+            size_t equals = line.find('=');
+            if (equals == std::string::npos || equals == 0 || equals + 1 == line.size()){
+                return false;
+            }
+            ActionBinding binding;
+            std::string name = line.substr(0, equals);
+            binding.action = int(names.size());
+            for (int i = 0; i < int(names.size()); i++){
+                if (names[i] == name){
+                    binding.action = i;
+                }
+            }
+            if (binding.action == int(names.size())){
+                names.push_back(name);
+            }
+            size_t termStart = equals + 1;
+            while (termStart <= line.size()){
+                size_t termEnd = line.find('+', termStart);
+                termEnd = termEnd == std::string::npos ? line.size() : termEnd;
+                if (!parseTerm(line.substr(termStart, termEnd - termStart), binding)){
+                    return false;
+                }
+                termStart = termEnd + 1;
+            }
+            table.push_back(binding);
+        }
+        if (!load(table.data(), table.size())){
+            return false;
+        }
+        actionNames = names;
+        return true;
+    }
+
+    // The number of an action loaded by loadText(), or -1.
+    int actionIndex(const std::string & name) const{
+        for (int i = 0; i < int(actionNames.size()); i++){
+            if (actionNames[i] == name){
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    // Evaluates every binding for every pad. Call it once per input tick, after the pads polled their state.
+    // Pads that aren't in the list anymore are forgotten.
+    void update(const std::vector<SDLGamepad *> & gamepads){
+        for (PadActions & actions: pads){
+            actions.seen = false;
+        }
+        for (const SDLGamepad * gamepad: gamepads){
+            update(gamepad->id, gamepad->state);
+        }
+        for (size_t i = 0; i < pads.size();){
+            if (pads[i].seen){
+                i++;
+            }
+            else {
+                pads.erase(pads.begin() + i);
+            }
+        }
+    }
+
+    // Evaluates every binding for one pad, for states that don't come from an SDLGamepad (e.g. replays or network pads).
+    void update(SDL_JoystickID pad, const SDLGamepadState & state){
+        PadActions * actions = nullptr;
+        for (PadActions & existing: pads){
+            if (existing.id == pad){
+                actions = &existing;
+            }
+        }
+        if (!actions){
+            pads.push_back({pad, std::vector<uint64_t>(words), std::vector<uint64_t>(words), false});
+            actions = &pads.back();
+        }
+        actions->seen = true;
+        actions->previous.swap(actions->current);
+
+        const uint64_t input = packActionInput(thresholds, int(thresholds.size()), state);
+        memset(actions->current.data(), 0, sizeof(uint64_t) * size_t(words));
+        evaluateActionBindings(bindings, int(bindings.size()), input, actions->current.data());
+    }
+
+    int getActionCount() const{
+        return actionCount;
+    }
+
+    // Went on this tick.
+    bool actionPressed(SDL_JoystickID pad, int action) const{
+        const PadActions * actions = find(pad);
+        return actions && action >= 0 && action < actionCount && testBit(actions->current, action) && !testBit(actions->previous, action);
+    }
+
+    bool actionHeld(SDL_JoystickID pad, int action) const{
+        const PadActions * actions = find(pad);
+        return actions && action >= 0 && action < actionCount && testBit(actions->current, action);
+    }
+
+    // Went off this tick.
+    bool actionReleased(SDL_JoystickID pad, int action) const{
+        const PadActions * actions = find(pad);
+        return actions && action >= 0 && action < actionCount && !testBit(actions->current, action) && testBit(actions->previous, action);
+    }
+};
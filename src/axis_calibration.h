@@ -0,0 +1,382 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_gamecontroller.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+
+// SDLGamepad turns raw axes into -1.0 - 1.0 (sticks) and 0.0 - 1.0 (triggers) by dividing by SDL_JOYSTICK_AXIS_MAX, which is only
+// right for a pad that rests at exactly 0 and reaches both ends. Worn sticks rest off centre, jitter around where they rest, and
+// stop short of the ends. The calibration learns all three from the values the pad sends while it is used, and corrects them in
+// pollState():
+//
+//   centre     the mean of the values while the axis rests: the stick or trigger barely moves, at the spot it comes back to when
+//              it is let go
+//   noise      four standard deviations of those values, which becomes a dead band around the centre and short of the ends
+//   extents    the lowest and highest values seen, held for two polls so that single spikes don't count
+//
+// Until an axis has been pushed at least halfway in a direction, that half keeps its nominal extent. The correction of an axis is
+// four floats, recomputed every 64 polls learned from, and applying it takes a few operations without any division. Once every
+// axis has learned its centre, only one poll in 8 is learned from, since learning costs more than applying.
+
+// The correction of one axis: output = sign(d) * min((|d| - noise) * scale, 1) with d = raw - centre, and 0 inside the noise.
+// Written without branches, since a moving stick crosses its centre and dead band at random.
+struct AxisCorrection{
+    float center = 0.0f;
+    float noise = 0.0f;
+    // For values above and below the centre.
+    float scales[2] = {1.0f, 1.0f};
+
+    float apply(float raw) const{
+        const float distance = raw - center;
+        // (x + |x|) / 2 is max(x, 0), which GCC turns into a branch when it's written as one.
+        float magnitude = std::fabs(distance) - noise;
+        magnitude = 0.5f * (magnitude + std::fabs(magnitude)) * scales[distance < 0.0f];
+        return std::copysign(magnitude < 1.0f ? magnitude : 1.0f, distance);
+    }
+};
+
+// The streaming statistics of one axis.
+struct AxisLearner{
+    // How little an axis moves between two polls to count as still (about 330 of 32767).
+    static constexpr float restMotion = 0.01f;
+    // How far from the centre a resting axis can be, and how far from 0 a worn axis can rest at all.
+    static constexpr float restRange = 0.05f;
+    static constexpr float maxOffset = 0.25f;
+    // Past this many resting samples, the centre and noise become an exponential average that follows slow drift.
+    static constexpr uint32_t maxWeight = 1024;
+    // Votes a spot needs to become the centre: still samples for the first one, and returns (see add()) for one that replaces a
+    // centre already learned, which then moves at most maxMove towards it.
+    static constexpr uint32_t firstVotes = 64;
+    static constexpr uint32_t moveVotes = 16;
+    static constexpr float maxMove = restRange;
+    // A half of the axis keeps its nominal extent until it is seen to go this far from the centre.
+    static constexpr float minExtent = 0.5f;
+    static constexpr float maxNoise = 0.1f;
+
+    float center = 0.0f;
+    float variance = 0.0f;
+    uint32_t restSamples = 0;
+    float minimum = 0.0f;
+    float maximum = 0.0f;
+    float previous = 0.0f;
+    // A stick held still looks like a stick at rest. Until there is a centre, it is the spot the axis is still at most often: still
+    // samples vote for a candidate spot (Boyer-Moore majority vote). After that, only returns vote: a held stick returns once
+    // when it is pulled back to where it is held, and every time it is let go it returns to the real centre, which votes against
+    // the candidate. So holding a stick off centre, however long, doesn't move the centre.
+    float candidate = 0.0f;
+    float candidateVariance = 0.0f;
+    uint32_t candidateSamples = 0;
+    uint32_t votes = 0;
+
+    // Welford's mean and variance, with the weight of a new value held at 1 / maxWeight once there are that many.
+    static void accumulate(float raw, float & mean, float & meanVariance, uint32_t & count){
+        const float weight = count < maxWeight ? 1.0f / float(++count) : 1.0f / float(maxWeight);
+        const float distance = raw - mean;
+        mean += distance * weight;
+        meanVariance += ((raw - mean) * distance - meanVariance) * weight;
+    }
+
+    bool isStill(float raw) const{
+        return std::fabs(raw - previous) < restMotion;
+    }
+
+    // Whether the axis has learned its centre with full weight, and no spot is being voted for, so that learning from fewer polls
+    // only makes the centre and extents follow the pad a little slower.
+    bool settled() const{
+        return restSamples >= maxWeight && votes == 0;
+    }
+
+    // still tells whether the whole stick (or trigger) barely moved since the last poll, see isStill(), and returned whether it
+    // came to a stop this poll after it was pushed at least halfway, which is what letting go of it looks like.
+    void add(float raw, bool still, bool returned){
+        if (still){
+            if (restSamples && std::fabs(raw - center) < restRange){
+                accumulate(raw, center, variance, restSamples);
+                votes -= votes != 0 && returned;
+            }
+            else if (std::fabs(raw) < maxOffset){
+                const bool vote = !restSamples || returned;
+                if (vote && votes == 0){
+                    candidateVariance = 0.0f;
+                    candidateSamples = 0;
+                }
+                const bool near = (vote && votes == 0) || std::fabs(raw - candidate) < restRange;
+                if (near && (vote || votes)){
+                    accumulate(raw, candidate, candidateVariance, candidateSamples);
+                }
+                if (vote){
+                    votes = near ? votes + 1 : votes - 1;
+                }
+                if (votes >= (restSamples ? moveVotes : firstVotes)){
+                    center = restSamples ? center + std::max(-maxMove, std::min(candidate - center, maxMove)) : candidate;
+                    variance = candidateVariance;
+                    restSamples = candidateSamples;
+                    votes = 0;
+                }
+            }
+        }
+        minimum = std::min(minimum, std::max(raw, previous));
+        maximum = std::max(maximum, std::min(raw, previous));
+        previous = raw;
+    }
+
+    float negativeExtent() const{
+        return center - minimum;
+    }
+
+    float positiveExtent() const{
+        return maximum - center;
+    }
+
+    // Triggers only have the positive half, and rest at its start.
+    AxisCorrection correction(bool trigger) const{
+        AxisCorrection result;
+        result.center = restSamples ? center : 0.0f;
+        result.noise = restSamples >= 16 ? std::min(4.0f * std::sqrt(variance), maxNoise) : 0.0f;
+        // A learned end is the highest of many noisy values, so twice the noise short of it is a dead band too, and a full push
+        // reads 1 through the jitter.
+        const float positive = positiveExtent() >= minExtent ? positiveExtent() - 2.0f * result.noise : 1.0f - result.center;
+        const float negative = negativeExtent() >= minExtent ? negativeExtent() - 2.0f * result.noise : 1.0f + result.center;
+        result.scales[0] = 1.0f / std::max(positive - result.noise, minExtent);
+        result.scales[1] = trigger ? 0.0f : 1.0f / std::max(negative - result.noise, minExtent);
+        return result;
+    }
+};
+
+// The calibration of the six axes of a pad, in the order LeftX, LeftY, RightX, RightY, LeftTrigger, RightTrigger.
+struct SDLGamepadCalibration{
+    static constexpr int axisCount = 6;
+    static constexpr uint32_t refreshInterval = 64;
+    // Once every axis is settled, one poll in this many is learned from, and the others are only corrected. Still then means
+    // still since the last poll learned from.
+    static constexpr uint32_t settledInterval = 8;
+    // How far from its centre a stick or trigger has to be pushed for coming back to rest to count as a return.
+    static constexpr float pushDistance = 0.5f;
+    static constexpr const char * axisNames[axisCount] = {"LeftX", "LeftY", "RightX", "RightY", "LeftTrigger", "RightTrigger"};
+
+    AxisLearner learners[axisCount];
+    AxisCorrection corrections[axisCount];
+    // Off keeps the corrections as they are.
+    bool learning = true;
+    uint32_t samples = 0;
+    // Whether every axis was settled after the last poll learned from, and the polls counted towards the next one since.
+    bool settled = false;
+    uint32_t skipped = 0;
+    // Whether each stick (both of its axes) and trigger was pushed at least pushDistance since it last came to rest.
+    bool pushed[axisCount] = {};
+
+    static constexpr bool isTrigger(int axis){
+        return axis >= 4;
+    }
+
+    void refresh(){
+        for (int axis = 0; axis < axisCount; axis++){
+            corrections[axis] = learners[axis].correction(isTrigger(axis));
+        }
+    }
+
+    void reset(){
+        *this = SDLGamepadCalibration();
+    }
+
+    // Learns from a poll's raw axes, and replaces them with the corrected ones.
+    void process(float * const axes[axisCount]){
+        // Copied first, since the compiler can't tell that the pointers don't point into the calibration.
+        float raw[axisCount];
+        for (int axis = 0; axis < axisCount; axis++){
+            raw[axis] = *axes[axis];
+        }
+        if (learning && (!settled || ++skipped % settledInterval == 0)){
+            // A stick rests only when both of its axes do: one axis of a stick pushed slowly along the other barely moves.
+            bool still[axisCount];
+            bool out[axisCount];
+            for (int axis = 0; axis < axisCount; axis++){
+                still[axis] = learners[axis].isStill(raw[axis]);
+                out[axis] = std::fabs(raw[axis] - learners[axis].center) >= pushDistance;
+            }
+            for (int axis = 0; axis < axisCount; axis++){
+                const int other = isTrigger(axis) ? axis : axis ^ 1;
+                const bool stickStill = still[axis] && still[other];
+                const bool stickOut = out[axis] || out[other];
+                const bool returned = stickStill && !stickOut && pushed[axis];
+                pushed[axis] = stickOut || (pushed[axis] && !stickStill);
+                learners[axis].add(raw[axis], stickStill, returned);
+            }
+            settled = true;
+            for (const AxisLearner & learner: learners){
+                settled = settled && learner.settled();
+            }
+            if (++samples % refreshInterval == 0){
+                refresh();
+            }
+        }
+        for (int axis = 0; axis < axisCount; axis++){
+            *axes[axis] = corrections[axis].apply(raw[axis]);
+        }
+    }
+};
+
+// Keeps what the calibration learned for every pad, so that a pad starts out calibrated the next time it connects. Pads are told
+// apart by serial number where SDL has one (SDL_GameControllerGetSerial()), and otherwise by joystick GUID and USB vendor and
+// product, which can't tell two pads of the same model apart. Used from the main thread only, when pads connect and disconnect.
+//
+// The file is plain text, one line per pad: "<key>" and then "<centre> <variance> <rest samples> <minimum> <maximum>"
+// for each axis, after a header line with the file version.
+class GamepadCalibrationStore{
+private:
+    static constexpr int version = 1;
+
+    std::string path;
+    std::map<std::string, SDLGamepadCalibration> calibrations;
+    bool dirty = false;
+
+    static std::string header(){
+        char text[64];
+        snprintf(text, sizeof(text), "SDLGamepadCalibration %d", version);
+        return text;
+    }
+
+    static std::string formatCalibration(const std::string & key, const SDLGamepadCalibration & calibration){
+        std::string line = key;
+        for (const AxisLearner & learner: calibration.learners){
+            char text[128];
+            snprintf(text, sizeof(text), " %.7g %.7g %u %.7g %.7g", learner.center, learner.variance, learner.restSamples,
+                learner.minimum, learner.maximum);
+            line += text;
+        }
+        return line + "\n";
+    }
+
+    // Returns false for lines that don't hold a complete calibration.
+    static bool parseCalibration(const std::string & line, std::string & key, SDLGamepadCalibration & calibration){
+        const size_t keyEnd = line.find(' ');
+        if (keyEnd == std::string::npos || keyEnd == 0){
+            return false;
+        }
+        key = line.substr(0, keyEnd);
+        calibration = SDLGamepadCalibration();
+        const char * cursor = line.c_str() + keyEnd;
+        for (AxisLearner & learner: calibration.learners){
+            int used = 0;
+            unsigned int restSamples;
+            if (sscanf(cursor, " %f %f %u %f %f%n", &learner.center, &learner.variance, &restSamples, &learner.minimum,
+                &learner.maximum, &used) != 5){
+                return false;
+            }
+            learner.restSamples = std::min<uint32_t>(restSamples, AxisLearner::maxWeight);
+            learner.previous = learner.center;
+            cursor += used;
+        }
+        calibration.refresh();
+        return true;
+    }
+
+public:
+    GamepadCalibrationStore(const std::string & filePath): path(filePath){}
+
+    GamepadCalibrationStore(const GamepadCalibrationStore &) = delete;
+    GamepadCalibrationStore & operator=(const GamepadCalibrationStore &) = delete;
+
+    // The key of an open controller, without spaces.
+    static std::string key(SDL_GameController * controller){
+        std::string result;
+        const char * serial = SDL_GameControllerGetSerial(controller);
+        if (serial && serial[0]){
+            result = std::string("serial:") + serial;
+        }
+        else {
+            char guid[33];
+            SDL_JoystickGetGUIDString(SDL_JoystickGetGUID(SDL_GameControllerGetJoystick(controller)), guid, sizeof(guid));
+            char text[64];
+            snprintf(text, sizeof(text), "guid:%s:%04x:%04x", guid, SDL_GameControllerGetVendor(controller), SDL_GameControllerGetProduct(controller));
+            result = text;
+        }
+        std::replace_if(result.begin(), result.end(), [](char c){ return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }, '_');
+        return result;
+    }
+
+    bool find(const std::string & key, SDLGamepadCalibration & calibration) const{
+        auto found = calibrations.find(key);
+        if (found == calibrations.end()){
+            return false;
+        }
+        calibration = found->second;
+        return true;
+    }
+
+    void store(const std::string & key, const SDLGamepadCalibration & calibration){
+        calibrations[key] = calibration;
+        dirty = true;
+    }
+
+    size_t size() const{
+        return calibrations.size();
+    }
+
+    // Adds the calibrations from the file. Returns false if there is no file, or it was written by another version.
+    bool load(){
+        FILE * file = fopen(path.c_str(), "rb");
+        if (!file){
+            return false;
+        }
+        std::string text;
+        char buffer[4096];
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0){
+            text.append(buffer, read);
+        }
+        fclose(file);
+
+        size_t lineStart = 0;
+        bool first = true;
+        while (lineStart < text.size()){
+            size_t lineEnd = text.find('\n', lineStart);
+            lineEnd = lineEnd == std::string::npos ? text.size() : lineEnd;
+            std::string line = text.substr(lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 1;
+            if (first){
+                if (line != header()){
+                    return false;
+                }
+                first = false;
+                continue;
+            }
+            std::string key;
+            SDLGamepadCalibration calibration;
+            if (parseCalibration(line, key, calibration)){
+                calibrations[key] = calibration;
+            }
+        }
+        return !first;
+    }
+
+    // Writes the calibrations if any were stored since the last load() or save(), through a temporary file that replaces the old one.
+    bool save(){
+        if (!dirty){
+            return true;
+        }
+        std::string text = header() + "\n";
+        for (const auto & calibration: calibrations){
+            text += formatCalibration(calibration.first, calibration.second);
+        }
+        std::string temporaryPath = path + ".tmp";
+        bool ok = false;
+        if (FILE * file = fopen(temporaryPath.c_str(), "wb")){
+            ok = fwrite(text.data(), 1, text.size(), file) == text.size();
+            ok = (fclose(file) == 0) && ok;
+        }
+#ifdef _WIN32
+        if (ok){
+            remove(path.c_str()); // rename() doesn't replace existing files on Windows
+        }
+#endif
+        ok = ok && rename(temporaryPath.c_str(), path.c_str()) == 0;
+        dirty = !ok;
+        return ok;
+    }
+};
@@ -0,0 +1,446 @@
+#pragma once
+#include "action_bindings.h"
+#include "sdl_gamepad.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+// Recognizes sequence inputs (quarter circle + punch, dashes, double taps...) from the changes in pad states.
+// Every state change becomes input events: the direction (numpad notation, 5 is neutral, 8 is up) moving to a new value, and
+// buttons that some combo uses being pressed (releases and other buttons don't count, so "X X" is a double tap).
+// A combo is a list of steps, each one a direction, or buttons pressed together (while holding a direction or not), that must be
+// the last events in a row, with at most gapFrames between two steps and totalFrames from the first step to the last one.
+//
+// load() compiles all combos into one deterministic automaton, Aho-Corasick style: a trie of the steps, turned into a DFA over
+// the classes of events that the steps tell apart. A pad's state is then a DFA state and the frames of its last few events, and
+// each event is one table lookup, whatever the number of combos. The timing windows are only checked for the combos that the
+// DFA says just ended.
+struct ComboStep{
+    int direction = 0;                  // 1 - 9, or 0 for any direction (for button steps)
+    uint64_t buttons = 0;               // GamepadInput::Button flags pressed together, or 0 for a direction step
+};
+
+struct ComboDefinition{
+    std::string name = "";
+    std::vector<ComboStep> steps;
+    uint32_t gapFrames = 0;             // 0 for no limit
+    uint32_t totalFrames = 0;           // 0 for no limit
+};
+
+namespace ComboInput {
+    static constexpr int maxSteps = 16;
+    // Buttons that combos can use, across the whole ruleset. The event classes are tabulated for every combination of them.
+    static constexpr int maxButtons = 10;
+
+    // The direction of a pad in numpad notation, from the DPad or the left stick.
+    inline int direction(const SDLGamepadState & state, float threshold){
+        int x = (state.DPadRight || state.LeftStick.x >= threshold) - (state.DPadLeft || state.LeftStick.x <= -threshold);
+        int y = (state.DPadUp || state.LeftStick.y <= -threshold) - (state.DPadDown || state.LeftStick.y >= threshold);
+        return 5 + x + 3 * y;
+    }
+}
+
+class ComboRecognizer{
+private:
+    struct PadCombos{
+        SDL_JoystickID id;
+        uint32_t state;
+        uint8_t direction;
+        uint8_t eventCount;             // Up to maxSteps, the number of frames in the ring that are valid
+        uint8_t ringStart;
+        bool seen;
+        uint64_t buttons;
+        uint32_t frames[ComboInput::maxSteps];
+        std::vector<int> recognized;
+    };
+
+    std::vector<ComboDefinition> combos;
+    uint64_t relevantButtons = 0;
+    int relevantCount = 0;
+    int classCount = 0;
+    // The class of a direction event is its direction - 1, button events are looked up by direction and relevant buttons.
+    std::vector<uint16_t> buttonClasses;            // [(direction - 1) << relevantCount | compressed buttons]
+    std::vector<uint32_t> transitions;              // [state * classCount + class]
+    std::vector<uint32_t> outputStart;              // Combos that end in a state: outputs[outputStart[state]..outputStart[state + 1]]
+    std::vector<int> outputs;
+    std::vector<PadCombos> pads;
+    std::vector<std::string> names;
+
+    // Packs the buttons of a mask into its low bits, and back.
+    static uint32_t compress(uint64_t buttons, uint64_t mask){
+        uint32_t compressed = 0;
+        int bit = 0;
+        for (uint64_t remaining = mask; remaining; remaining &= remaining - 1, bit++){
+            compressed |= uint32_t((buttons & remaining & (~remaining + 1)) != 0) << bit;
+        }
+        return compressed;
+    }
+
+    static uint64_t expand(uint32_t compressed, uint64_t mask){
+        uint64_t buttons = 0;
+        int bit = 0;
+        for (uint64_t remaining = mask; remaining; remaining &= remaining - 1, bit++){
+            if ((compressed >> bit) & 1){
+                buttons |= remaining & (~remaining + 1);
+            }
+        }
+        return buttons;
+    }
+
+    static bool matches(const ComboStep & step, bool buttonEvent, int direction, uint64_t buttons){
+        if (step.buttons == 0){
+            return !buttonEvent && step.direction == direction;
+        }
+        return buttonEvent && (step.direction == 0 || step.direction == direction) && (buttons & step.buttons) == step.buttons;
+    }
+
+    bool timely(const PadCombos & pad, const ComboDefinition & combo) const{
+        const int count = int(combo.steps.size());
+        uint32_t next = pad.frames[(pad.ringStart + pad.eventCount - 1) % ComboInput::maxSteps];
+        const uint32_t last = next;
+        for (int i = 2; i <= count; i++){
+            const uint32_t frame = pad.frames[(pad.ringStart + pad.eventCount - i) % ComboInput::maxSteps];
+            if (combo.gapFrames && next - frame > combo.gapFrames){
+                return false;
+            }
+            next = frame;
+        }
+        return !combo.totalFrames || last - next <= combo.totalFrames;
+    }
+
+    void feed(PadCombos & pad, int eventClass, uint32_t frame){
+        pad.state = transitions[size_t(pad.state) * size_t(classCount) + size_t(eventClass)];
+        if (pad.eventCount < ComboInput::maxSteps){
+            pad.frames[(pad.ringStart + pad.eventCount++) % ComboInput::maxSteps] = frame;
+        }
+        else {
+            pad.frames[pad.ringStart] = frame;
+            pad.ringStart = uint8_t((pad.ringStart + 1) % ComboInput::maxSteps);
+        }
+        for (uint32_t i = outputStart[pad.state]; i < outputStart[pad.state + 1]; i++){
+            if (timely(pad, combos[size_t(outputs[i])])){
+                pad.recognized.push_back(outputs[i]);
+            }
+        }
+    }
+
+    // The parser for loadText(). A step is a direction digit, buttons joined by '+', or a digit and buttons ("6+X").
+    static bool parseStep(const std::string & token, ComboStep & step){
+        step = ComboStep();
+        size_t start = 0;
+        if (!token.empty() && token[0] >= '1' && token[0] <= '9'){
+            step.direction = token[0] - '0';
+            start = (token.size() > 1 && token[1] == '+') ? 2 : 1;
+            if (start == 1 && token.size() > 1){
+                return false;
+            }
+        }
+        while (start < token.size()){
+            size_t end = token.find('+', start);
+            end = end == std::string::npos ? token.size() : end;
+            const std::string button = token.substr(start, end - start);
+            int index = -1;
+            for (int i = 0; i < GamepadInput::buttonCount; i++){
+                if (button == GamepadInput::buttonNames[i]){
+                    index = i;
+                }
+            }
+            if (index < 0){
+                return false;
+            }
+            step.buttons |= 1ull << index;
+            start = end + 1;
+        }
+        return step.direction != 0 || step.buttons != 0;
+    }
+
+public:
+    // How far the left stick has to go to count as a direction.
+    float stickThreshold = 0.5f;
+
+    // Compiles the combos. Returns false (and keeps the previous ones) if a combo is empty or longer than maxSteps, if the
+    // combos use more than maxButtons different buttons, or if the automaton would get too big.
+    bool load(const std::vector<ComboDefinition> & definitions){
+        uint64_t newRelevant = 0;
+        for (const ComboDefinition & combo: definitions){
+            if (combo.steps.empty() || combo.steps.size() > size_t(ComboInput::maxSteps)){
+                return false;
+            }
+            for (const ComboStep & step: combo.steps){
+                if (step.direction < 0 || step.direction > 9 || (step.buttons == 0 && step.direction == 0)){
+                    return false;
+                }
+                newRelevant |= step.buttons;
+            }
+        }
+        int newRelevantCount = 0;
+        for (uint64_t remaining = newRelevant; remaining; remaining &= remaining - 1){
+            newRelevantCount++;
+        }
+        if (newRelevantCount > ComboInput::maxButtons){
+            return false;
+        }
+
+        // The trie, with a predicate (a distinct step) on every edge.
+        std::vector<ComboStep> predicates;
+        struct Node{
+            std::vector<std::pair<int, int>> edges;         // predicate, child
+            std::vector<int> ends;
+        };
+        std::vector<Node> trie(1);
+        for (size_t c = 0; c < definitions.size(); c++){
+            int node = 0;
+            for (const ComboStep & step: definitions[c].steps){
+                int predicate = 0;
+                while (predicate < int(predicates.size()) && !(predicates[predicate].direction == step.direction && predicates[predicate].buttons == step.buttons)){
+                    predicate++;
+                }
+                if (predicate == int(predicates.size())){
+                    predicates.push_back(step);
+                }
+                int child = -1;
+                for (const auto & edge: trie[size_t(node)].edges){
+                    if (edge.first == predicate){
+                        child = edge.second;
+                    }
+                }
+                if (child < 0){
+                    child = int(trie.size());
+                    trie[size_t(node)].edges.push_back({predicate, child});
+                    trie.emplace_back();
+                }
+                node = child;
+            }
+            trie[size_t(node)].ends.push_back(int(c));
+        }
+
+        // Event classes: events that satisfy the same predicates behave the same. Direction events get one class per direction,
+        // button events are grouped by the set of predicates they satisfy.
+        std::vector<std::vector<char>> classPredicates;
+        for (int direction = 1; direction <= 9; direction++){
+            std::vector<char> satisfied(predicates.size());
+            for (size_t p = 0; p < predicates.size(); p++){
+                satisfied[p] = matches(predicates[p], false, direction, 0);
+            }
+            classPredicates.push_back(satisfied);
+        }
+        std::map<std::vector<char>, int> buttonClassIds;
+        std::vector<uint16_t> newButtonClasses(size_t(9) << newRelevantCount);
+        for (int direction = 1; direction <= 9; direction++){
+            for (uint32_t compressed = 0; compressed < (1u << newRelevantCount); compressed++){
+                std::vector<char> satisfied(predicates.size());
+                for (size_t p = 0; p < predicates.size(); p++){
+                    satisfied[p] = matches(predicates[p], true, direction, expand(compressed, newRelevant));
+                }
+                auto existing = buttonClassIds.find(satisfied);
+                if (existing == buttonClassIds.end()){
+                    existing = buttonClassIds.emplace(satisfied, int(classPredicates.size())).first;
+                    classPredicates.push_back(satisfied);
+                }
+                newButtonClasses[(size_t(direction - 1) << newRelevantCount) | compressed] = uint16_t(existing->second);
+            }
+        }
+
+        // Subset construction. A DFA state is the set of trie nodes that the last events lead to, the root being always there
+        // so that a combo can start at any event. State 0 (just the root) comes first, and most transitions of the other states
+        // only follow root edges, which makes them the same as state 0's.
+        const size_t newClassCount = classPredicates.size();
+        std::vector<std::vector<int>> states = {{}};
+        std::map<std::vector<int>, uint32_t> stateIds = {{{}, 0}};
+        std::vector<uint32_t> newTransitions;
+        std::vector<int> next;
+        for (size_t s = 0; s < states.size(); s++){
+            for (size_t c = 0; c < newClassCount; c++){
+                next.clear();
+                auto follow = [&](int node){
+                    for (const auto & edge: trie[size_t(node)].edges){
+                        if (classPredicates[c][size_t(edge.first)]){
+                            next.push_back(edge.second);
+                        }
+                    }
+                };
+                for (int node: states[s]){
+                    follow(node);
+                }
+                if (s > 0 && next.empty()){
+                    newTransitions.push_back(newTransitions[c]);
+                    continue;
+                }
+                follow(0);
+                std::sort(next.begin(), next.end());
+                next.erase(std::unique(next.begin(), next.end()), next.end());
+                auto existing = stateIds.find(next);
+                if (existing == stateIds.end()){
+                    if (states.size() == 1u << 20){
+                        return false;
+                    }
+                    existing = stateIds.emplace(next, uint32_t(states.size())).first;
+                    states.push_back(next);
+                }
+                newTransitions.push_back(existing->second);
+            }
+        }
+
+        outputStart.assign(1, 0);
+        outputs.clear();
+        for (const std::vector<int> & state: states){
+            size_t first = outputs.size();
+            for (int node: state){
+                outputs.insert(outputs.end(), trie[size_t(node)].ends.begin(), trie[size_t(node)].ends.end());
+            }
+            std::sort(outputs.begin() + long(first), outputs.end());
+            outputStart.push_back(uint32_t(outputs.size()));
+        }
+        relevantButtons = newRelevant;
+        relevantCount = newRelevantCount;
+        combos = definitions;
+        names.clear();
+        for (const ComboDefinition & combo: combos){
+            names.push_back(combo.name);
+        }
+        classCount = int(newClassCount);
+        buttonClasses.swap(newButtonClasses);
+        transitions.swap(newTransitions);
+        pads.clear();
+        return true;
+    }
+
+    // Loads combos from text, one per line: "<name> = <step> <step>... [gap <frames>] [total <frames>]", e.g.
+    // "Fireball = 2 3 6 X gap 8 total 20" or "Dash = 6 5 6 gap 6". Lines starting with '#' are comments.
+    bool loadText(const std::string & text){
+        std::vector<ComboDefinition> definitions;
+        size_t lineStart = 0;
+        while (lineStart < text.size()){
+            size_t lineEnd = text.find('\n', lineStart);
+            lineEnd = lineEnd == std::string::npos ? text.size() : lineEnd;
+            std::string line = text.substr(lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 1;
+            size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#'){
+                continue;
+            }
+            size_t equals = line.find('=');
+            if (equals == std::string::npos){
+                return false;
+            }
+            ComboDefinition combo;
+            combo.name = line.substr(first, line.find_last_not_of(" \t", equals - 1) + 1 - first);
+            std::vector<std::string> tokens;
+            size_t tokenStart = line.find_first_not_of(" \t\r", equals + 1);
+            while (tokenStart != std::string::npos){
+                size_t tokenEnd = line.find_first_of(" \t\r", tokenStart);
+                tokens.push_back(line.substr(tokenStart, tokenEnd == std::string::npos ? std::string::npos : tokenEnd - tokenStart));
+                tokenStart = tokenEnd == std::string::npos ? tokenEnd : line.find_first_not_of(" \t\r", tokenEnd);
+            }
+            for (size_t i = 0; i < tokens.size(); i++){
+                if ((tokens[i] == "gap" || tokens[i] == "total") && i + 1 < tokens.size()){
+                    char * end;
+                    unsigned long frames = strtoul(tokens[i + 1].c_str(), &end, 10);
+                    if (*end != '\0'){
+                        return false;
+                    }
+                    (tokens[i] == "gap" ? combo.gapFrames : combo.totalFrames) = uint32_t(frames);
+                    i++;
+                    continue;
+                }
+                ComboStep step;
+                if (!parseStep(tokens[i], step)){
+                    return false;
+                }
+                combo.steps.push_back(step);
+            }
+            definitions.push_back(combo);
+        }
+        return load(definitions);
+    }
+
+    // The number of a combo, or -1.
+    int comboIndex(const std::string & name) const{
+        for (int i = 0; i < int(names.size()); i++){
+            if (names[i] == name){
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    const ComboDefinition & getCombo(int combo) const{
+        return combos[size_t(combo)];
+    }
+
+    int getStateCount() const{
+        return int(outputStart.size()) - 1;
+    }
+
+    // Steps the automaton of every pad with the changes since the last call. Call it once per input tick, after the pads polled
+    // their state, with a frame counter (or any other clock the combo windows are counted in). Pads that aren't in the list
+    // anymore are forgotten.
+    void update(const std::vector<SDLGamepad *> & gamepads, uint32_t frame){
+        for (PadCombos & pad: pads){
+            pad.seen = false;
+        }
+        for (const SDLGamepad * gamepad: gamepads){
+            update(gamepad->id, gamepad->state, frame);
+        }
+        for (size_t i = 0; i < pads.size();){
+            if (pads[i].seen){
+                i++;
+            }
+            else {
+                pads.erase(pads.begin() + i);
+            }
+        }
+    }
+
+    // Steps the automaton of one pad, for states that don't come from an SDLGamepad (e.g. replays or network pads).
+    void update(SDL_JoystickID id, const SDLGamepadState & state, uint32_t frame){
+        PadCombos * pad = nullptr;
+        for (PadCombos & existing: pads){
+            if (existing.id == id){
+                pad = &existing;
+            }
+        }
+        if (!pad){
+            pads.push_back({id, 0, 5, 0, 0, false, 0, {}, {}});
+            pad = &pads.back();
+        }
+        pad->seen = true;
+        pad->recognized.clear();
+        if (transitions.empty()){
+            return;
+        }
+        const int direction = ComboInput::direction(state, stickThreshold);
+        const uint64_t buttons = GamepadInput::packButtons(state);
+        const uint64_t pressed = buttons & ~pad->buttons;
+        if (direction != pad->direction){
+            pad->direction = uint8_t(direction);
+            feed(*pad, direction - 1, frame);
+        }
+        if (pressed & relevantButtons){
+            feed(*pad, buttonClasses[(size_t(direction - 1) << relevantCount) | compress(pressed, relevantButtons)], frame);
+        }
+        pad->buttons = buttons;
+        std::sort(pad->recognized.begin(), pad->recognized.end());
+    }
+
+    // The combos that a pad finished on the last update, in the order they were loaded in (a state change can finish more than
+    // one, like a fireball and the plain punch it ends with).
+    const std::vector<int> & recognized(SDL_JoystickID id) const{
+        static const std::vector<int> none;
+        for (const PadCombos & pad: pads){
+            if (pad.id == id){
+                return pad.recognized;
+            }
+        }
+        return none;
+    }
+
+    bool comboRecognized(SDL_JoystickID id, int combo) const{
+        const std::vector<int> & finished = recognized(id);
+        return std::find(finished.begin(), finished.end(), combo) != finished.end();
+    }
+};
@@ -0,0 +1,276 @@
+#pragma once
+#include "imgui/imgui.h"
+
+#include <climits>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Saves the ImDrawData of live frames into a file, so that they can be replayed later through a renderer backend
+// without a display or any ImGui code running (see tools/renderer_benchmark.cpp).
+//
+// File layout (all values are little endian, as written by the machine):
+//   header: "IMDD", uint32 version, uint32 sizeof(ImDrawVert), uint32 sizeof(ImDrawIdx), int32 font atlas width and height
+//   frame:  uint32 command list count, float display pos x/y, display size x/y, framebuffer scale x/y
+//     list: uint32 vertex count, index count, command count, then the raw vertices and indices, then for every command:
+//           float clip rect x/y/z/w, uint32 texture tag, vertex offset, index offset, element count, uint32 has user callback
+// Texture ids can't be saved as pointers, so they are written as tags: 0 is always the font atlas, and every other texture
+// gets its own tag starting at 1, in the order in which they were first seen.
+namespace DrawDataCapture {
+    static constexpr char magic[4] = {'I', 'M', 'D', 'D'};
+    static constexpr uint32_t version = 1;
+    static constexpr uint32_t fontTextureTag = 0;
+}
+
+class DrawDataCaptureWriter {
+private:
+    FILE * file = nullptr;
+    std::map<ImTextureID, uint32_t> textureTags;
+    int frameCount = 0;
+
+    template <typename T> void write(const T & value){
+        fwrite(&value, sizeof(T), 1, file);
+    }
+
+    uint32_t tagFor(ImTextureID texture){
+        if (texture == ImGui::GetIO().Fonts->TexID){
+            return DrawDataCapture::fontTextureTag;
+        }
+        auto existing = textureTags.find(texture);
+        if (existing != textureTags.end()){
+            return existing->second;
+        }
+        uint32_t tag = uint32_t(textureTags.size()) + 1;
+        textureTags[texture] = tag;
+        return tag;
+    }
+
+public:
+    DrawDataCaptureWriter(const std::string & path){
+        file = fopen(path.c_str(), "wb");
+        if (!file){
+            return;
+        }
+        int atlasWidth = ImGui::GetIO().Fonts->TexWidth;
+        int atlasHeight = ImGui::GetIO().Fonts->TexHeight;
+        fwrite(DrawDataCapture::magic, 1, 4, file);
+        write(DrawDataCapture::version);
+        write(uint32_t(sizeof(ImDrawVert)));
+        write(uint32_t(sizeof(ImDrawIdx)));
+        write(int32_t(atlasWidth));
+        write(int32_t(atlasHeight));
+    }
+
+    ~DrawDataCaptureWriter(){
+        if (file){
+            fclose(file);
+        }
+    }
+
+    bool isOpen(){
+        return file != nullptr;
+    }
+
+    int getFrameCount(){
+        return frameCount;
+    }
+
+    void writeFrame(const ImDrawData * drawData){
+        if (!file || !drawData->Valid){
+            return;
+        }
+        write(uint32_t(drawData->CmdListsCount));
+        write(drawData->DisplayPos.x);
+        write(drawData->DisplayPos.y);
+        write(drawData->DisplaySize.x);
+        write(drawData->DisplaySize.y);
+        write(drawData->FramebufferScale.x);
+        write(drawData->FramebufferScale.y);
+
+        for (int n = 0; n < drawData->CmdListsCount; n++){
+            const ImDrawList * list = drawData->CmdLists[n];
+            write(uint32_t(list->VtxBuffer.Size));
+            write(uint32_t(list->IdxBuffer.Size));
+            write(uint32_t(list->CmdBuffer.Size));
+            fwrite(list->VtxBuffer.Data, sizeof(ImDrawVert), list->VtxBuffer.Size, file);
+            fwrite(list->IdxBuffer.Data, sizeof(ImDrawIdx), list->IdxBuffer.Size, file);
+            for (const ImDrawCmd & command: list->CmdBuffer){
+                write(command.ClipRect.x);
+                write(command.ClipRect.y);
+                write(command.ClipRect.z);
+                write(command.ClipRect.w);
+                write(tagFor(command.TextureId));
+                write(uint32_t(command.VtxOffset));
+                write(uint32_t(command.IdxOffset));
+                write(uint32_t(command.ElemCount));
+                write(uint32_t(command.UserCallback != nullptr));
+            }
+        }
+        frameCount++;
+    }
+};
+
+// A frame loaded back from a capture file. It owns its draw lists, and drawData points into them.
+struct DrawDataCaptureFrame {
+    std::vector<std::unique_ptr<ImDrawList>> lists;
+    std::vector<ImDrawList *> listPointers;
+    ImDrawData drawData;
+};
+
+class DrawDataCaptureReader {
+private:
+    FILE * file = nullptr;
+    int atlasWidth = 0;
+    int atlasHeight = 0;
+    std::string error = "";
+
+    template <typename T> bool read(T & value){
+        return fread(&value, sizeof(T), 1, file) == 1;
+    }
+
+    // The counts of a list must fit the int sizes of ImVector (in bytes too) and the frame's totals.
+    static bool countsFit(const ImDrawData & drawData, uint32_t vertexCount, uint32_t indexCount, uint32_t commandCount){
+        return vertexCount <= INT_MAX / sizeof(ImDrawVert) && indexCount <= INT_MAX / sizeof(ImDrawIdx) && commandCount <= INT_MAX / sizeof(ImDrawCmd)
+            && int(vertexCount) <= INT_MAX - drawData.TotalVtxCount && int(indexCount) <= INT_MAX - drawData.TotalIdxCount;
+    }
+
+    // A command must only draw indices of its list, and they must only point at vertices of its list, or a renderer would
+    // read past the end of the buffers.
+    static bool commandFits(const ImDrawList & list, const ImDrawCmd & command){
+        const uint64_t vertexCount = uint64_t(list.VtxBuffer.Size);
+        if (uint64_t(command.IdxOffset) + command.ElemCount > uint64_t(list.IdxBuffer.Size) || (command.ElemCount > 0 && command.VtxOffset >= vertexCount)){
+            return false;
+        }
+        const ImDrawIdx * indices = list.IdxBuffer.Data + command.IdxOffset;
+        for (unsigned int i = 0; i < command.ElemCount; i++){
+            if (command.VtxOffset + uint64_t(indices[i]) >= vertexCount){
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    DrawDataCaptureReader(const std::string & path){
+        file = fopen(path.c_str(), "rb");
+        if (!file){
+            error = "Could not open " + path;
+            return;
+        }
+        char fileMagic[4];
+        uint32_t fileVersion, vertexSize, indexSize;
+        int32_t width, height;
+        if (fread(fileMagic, 1, 4, file) != 4 || memcmp(fileMagic, DrawDataCapture::magic, 4) != 0
+            || !read(fileVersion) || fileVersion != DrawDataCapture::version){
+            error = path + " is not a draw data capture (or was written by a different version)";
+        }
+        else if (!read(vertexSize) || !read(indexSize) || vertexSize != sizeof(ImDrawVert) || indexSize != sizeof(ImDrawIdx)){
+            error = path + " was captured with a different ImDrawVert or ImDrawIdx layout";
+        }
+        else if (read(width) && read(height)){
+            atlasWidth = width;
+            atlasHeight = height;
+        }
+        if (!error.empty()){
+            fclose(file);
+            file = nullptr;
+        }
+    }
+
+    ~DrawDataCaptureReader(){
+        if (file){
+            fclose(file);
+        }
+    }
+
+    bool isOpen(){
+        return file != nullptr;
+    }
+
+    std::string getError(){
+        return error;
+    }
+
+    int getAtlasWidth(){
+        return atlasWidth;
+    }
+
+    int getAtlasHeight(){
+        return atlasHeight;
+    }
+
+    // Reads the next frame. Texture tags are turned back into texture ids through textureForTag.
+    // User callbacks can't be replayed, so commands that had one come back without it.
+    // Returns false at the end of the file, or with getError() set when the frame is truncated or doesn't fit its buffers.
+    bool readFrame(DrawDataCaptureFrame & frame, ImTextureID (*textureForTag)(uint32_t tag)){
+        uint32_t listCount;
+        if (!file || !read(listCount)){
+            return false;
+        }
+        frame.lists.clear();
+        frame.listPointers.clear();
+        frame.drawData.Clear();
+
+        ImDrawData & drawData = frame.drawData;
+        bool ok = read(drawData.DisplayPos.x) && read(drawData.DisplayPos.y)
+            && read(drawData.DisplaySize.x) && read(drawData.DisplaySize.y)
+            && read(drawData.FramebufferScale.x) && read(drawData.FramebufferScale.y);
+
+        if (listCount > uint32_t(INT_MAX)){
+            error = "The capture file has a frame with too many command lists";
+            return false;
+        }
+        for (uint32_t n = 0; ok && n < listCount; n++){
+            uint32_t vertexCount, indexCount, commandCount;
+            if (!read(vertexCount) || !read(indexCount) || !read(commandCount)){
+                ok = false;
+                break;
+            }
+            if (!countsFit(drawData, vertexCount, indexCount, commandCount)){
+                error = "The capture file has a command list with too many vertices, indices or commands";
+                return false;
+            }
+            auto list = std::make_unique<ImDrawList>(nullptr);
+            list->VtxBuffer.resize(int(vertexCount));
+            list->IdxBuffer.resize(int(indexCount));
+            list->CmdBuffer.resize(int(commandCount));
+            ok = fread(list->VtxBuffer.Data, sizeof(ImDrawVert), vertexCount, file) == vertexCount
+                && fread(list->IdxBuffer.Data, sizeof(ImDrawIdx), indexCount, file) == indexCount;
+
+            for (uint32_t i = 0; ok && i < commandCount; i++){
+                ImDrawCmd & command = list->CmdBuffer[int(i)];
+                uint32_t tag, vertexOffset, indexOffset, elementCount, hadCallback;
+                ok = read(command.ClipRect.x) && read(command.ClipRect.y) && read(command.ClipRect.z) && read(command.ClipRect.w)
+                    && read(tag) && read(vertexOffset) && read(indexOffset) && read(elementCount) && read(hadCallback);
+                command.TextureId = textureForTag(tag);
+                command.VtxOffset = vertexOffset;
+                command.IdxOffset = indexOffset;
+                command.ElemCount = elementCount;
+                command.UserCallback = nullptr;
+                command.UserCallbackData = nullptr;
+                if (ok && !commandFits(*list, command)){
+                    error = "The capture file has a draw command outside of its vertex or index buffer";
+                    return false;
+                }
+            }
+
+            drawData.TotalVtxCount += int(vertexCount);
+            drawData.TotalIdxCount += int(indexCount);
+            frame.listPointers.push_back(list.get());
+            frame.lists.push_back(std::move(list));
+        }
+
+        if (!ok){
+            error = "The capture file is truncated";
+            return false;
+        }
+        drawData.Valid = true;
+        drawData.CmdLists = frame.listPointers.data();
+        drawData.CmdListsCount = int(frame.listPointers.size());
+        return true;
+    }
+};
@@ -0,0 +1,774 @@
+#pragma once
+#include "sdl_gamepad.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <netinet/udp.h>
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// A DSU ("cemuhook") server, which is how emulators (Cemu, Dolphin, yuzu, Citra...) take motion input from another program.
+// Clients send requests to UDP port 26760, and subscribe to pad slots by sending a data request about once a second. Every
+// subscribed slot then gets a data packet with the buttons, sticks, touchpad and one motion sample.
+//
+// The gyroscope and accelerometer report much faster than the app polls (250 to 1000 Hz against the frame rate), so the server
+// takes the SDL_CONTROLLERSENSORUPDATE events themselves through addSensorEvent(), and sends one packet per sample instead of
+// one per frame. The samples that SDL delivers in one frame get timestamps spread over the time since the pad's previous
+// batch, so that clients which integrate the gyroscope see the sensor's own rate.
+//
+// Packets are queued in buffers that are allocated once, and all of a frame's go out together. On Linux, the data packets for
+// a client are batched into UDP GSO messages (up to 64 packets, which the kernel cuts into datagrams of one packet each), and the
+// messages go out in one sendmmsg() call. Elsewhere, and on kernels without UDP_SEGMENT (before 4.18), every packet is sent by
+// itself. A client that hasn't renewed a subscription for five seconds is dropped.
+namespace DSUProtocol {
+    static constexpr uint16_t defaultPort = 26760;
+    static constexpr uint16_t version = 1001;
+    static constexpr uint32_t versionMessage = 0x100000;
+    static constexpr uint32_t infoMessage = 0x100001;
+    static constexpr uint32_t dataMessage = 0x100002;
+    static constexpr int headerSize = 16;
+    static constexpr int infoPacketSize = 32;
+    static constexpr int dataPacketSize = 100;
+    static constexpr uint32_t subscriptionTimeoutMs = 5000;
+
+    // Slot states, models and connection types as the protocol has them
+    static constexpr uint8_t slotDisconnected = 0;
+    static constexpr uint8_t slotConnected = 2;
+    static constexpr uint8_t modelPartialGyro = 1;
+    static constexpr uint8_t modelFullGyro = 2;
+    static constexpr uint8_t connectionUnknown = 0;
+    static constexpr uint8_t connectionUSB = 1;
+    static constexpr uint8_t connectionBluetooth = 2;
+
+    // The touchpad is reported in DualShock 4 touchpad units.
+    static constexpr float touchpadWidth = 1920.0f;
+    static constexpr float touchpadHeight = 942.0f;
+
+    struct CRC32Table {
+        uint32_t values[256];
+    };
+
+    static constexpr CRC32Table makeCRC32Table(){
+        CRC32Table table{};
+        for (uint32_t i = 0; i < 256; i++){
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++){
+                crc = (crc >> 1) ^ (crc & 1 ? 0xEDB88320u : 0u);
+            }
+            table.values[i] = crc;
+        }
+        return table;
+    }
+
+    static constexpr CRC32Table crc32Table = makeCRC32Table();
+
+    inline uint32_t crc32(const uint8_t * bytes, size_t size){
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < size; i++){
+            crc = (crc >> 8) ^ crc32Table.values[(crc ^ bytes[i]) & 0xFF];
+        }
+        return ~crc;
+    }
+
+    // The protocol is little endian.
+    inline void write16(uint8_t * bytes, uint16_t value){
+        bytes[0] = uint8_t(value);
+        bytes[1] = uint8_t(value >> 8);
+    }
+
+    inline void write32(uint8_t * bytes, uint32_t value){
+        for (int i = 0; i < 4; i++){
+            bytes[i] = uint8_t(value >> (8 * i));
+        }
+    }
+
+    inline void write64(uint8_t * bytes, uint64_t value){
+        for (int i = 0; i < 8; i++){
+            bytes[i] = uint8_t(value >> (8 * i));
+        }
+    }
+
+    inline void writeFloat(uint8_t * bytes, float value){
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        write32(bytes, bits);
+    }
+
+    inline uint16_t read16(const uint8_t * bytes){
+        return uint16_t(bytes[0] | bytes[1] << 8);
+    }
+
+    inline uint32_t read32(const uint8_t * bytes){
+        return uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+    }
+
+    // Magic, version, length of what follows the header, CRC32 (with the field itself at 0), sender ID, then the message type.
+    inline void writeHeader(uint8_t * packet, int size, uint32_t senderId, uint32_t message){
+        memcpy(packet, "DSUS", 4);
+        write16(packet + 4, version);
+        write16(packet + 6, uint16_t(size - headerSize));
+        write32(packet + 8, 0);
+        write32(packet + 12, senderId);
+        write32(packet + 16, message);
+    }
+
+    inline void sealPacket(uint8_t * packet, int size){
+        write32(packet + 8, 0);
+        write32(packet + 8, crc32(packet, size_t(size)));
+    }
+
+    // Checks a client packet, and returns its message type (or 0 when it isn't a valid request).
+    inline uint32_t checkRequest(uint8_t * packet, int size){
+        if (size < headerSize + 4 || memcmp(packet, "DSUC", 4) != 0 || read16(packet + 4) > version){
+            return 0;
+        }
+        const int length = headerSize + read16(packet + 6);
+        if (length < headerSize + 4 || length > size){
+            return 0;
+        }
+        const uint32_t crc = read32(packet + 8);
+        write32(packet + 8, 0);
+        if (crc32(packet, size_t(length)) != crc){
+            return 0;
+        }
+        return read32(packet + 16);
+    }
+}
+
+class DSUServer {
+public:
+    static constexpr int maxSlots = 8;
+    static constexpr int maxClients = 16;
+    // Samples kept per slot between two calls of serve(): more than a frame's worth at 1000 Hz down to 15 fps.
+    static constexpr int maxSamples = 64;
+    // Packets queued before they are handed to the system
+    static constexpr int maxBatch = 256;
+
+    struct MotionSample {
+        uint64_t timestamp = 0;
+        float accelerometer[3] = {0.0f, 0.0f, 0.0f};
+        float gyroscope[3] = {0.0f, 0.0f, 0.0f};
+    };
+
+private:
+#ifdef _WIN32
+    typedef SOCKET Socket;
+    static constexpr Socket invalidSocket = INVALID_SOCKET;
+    bool winsockStarted = false;
+#else
+    typedef int Socket;
+    static constexpr Socket invalidSocket = -1;
+#endif
+
+    struct Slot {
+        SDL_JoystickID id = -1;
+        uint8_t mac[6] = {};
+        uint8_t model = 0;
+        uint8_t connection = DSUProtocol::connectionUnknown;
+        uint8_t battery = 0;
+        bool sensorsRequested = false;
+        // Everything of the data packet but the packet number, timestamp, motion and CRC, as of the last setInput().
+        std::array<uint8_t, DSUProtocol::dataPacketSize> packet{};
+        // The newest values of each sensor, and which of them came in since the last sample was taken.
+        float accelerometer[3] = {0.0f, 0.0f, 0.0f};
+        float gyroscope[3] = {0.0f, 0.0f, 0.0f};
+        uint32_t pendingSensors = 0;
+        uint32_t seenSensors = 0;
+        MotionSample samples[maxSamples];
+        int sampleCount = 0;
+        MotionSample last;
+        uint64_t lastBatchTime = 0;
+    };
+
+    struct Client {
+        bool active = false;
+        sockaddr_in address{};
+        // When the client last asked for all slots, and for each slot (SDL_GetTicks(), 0 for never).
+        uint32_t allRequested = 0;
+        uint32_t slotRequested[maxSlots] = {};
+        uint32_t packetNumber = 0;
+    };
+
+    std::string address;
+    uint16_t port;
+    Socket socketHandle = invalidSocket;
+    uint32_t serverId = 0;
+    Slot slots[maxSlots];
+    Client clients[maxClients];
+
+    // The send queue. Its packets, and the message headers pointing at them, are allocated once in open().
+    std::vector<std::array<uint8_t, DSUProtocol::dataPacketSize>> queue;
+    std::vector<int> queueSizes;
+    std::vector<sockaddr_in> queueTargets;
+#ifdef __linux__
+    // The most datagrams the kernel takes in one GSO message (UDP_MAX_SEGMENTS)
+    static constexpr int maxSegments = 64;
+    bool segmentation = true;
+    std::vector<mmsghdr> messages;
+    std::vector<iovec> vectors;
+    std::vector<std::array<char, CMSG_SPACE(sizeof(uint16_t))>> controls;
+    // The first queued packet of each message, and one past the last message
+    std::vector<int> messageStarts;
+#endif
+    int queued = 0;
+    uint64_t sentPackets = 0;
+
+    static uint64_t microseconds(){
+        return uint64_t(double(SDL_GetPerformanceCounter()) * 1000000.0 / double(SDL_GetPerformanceFrequency()));
+    }
+
+    static bool timedOut(uint32_t requested, uint32_t now){
+        return requested == 0 || now - requested > DSUProtocol::subscriptionTimeoutMs;
+    }
+
+    uint8_t * queuePacket(const sockaddr_in & target, int size){
+        if (queued == maxBatch){
+            flush();
+        }
+        queueSizes[size_t(queued)] = size;
+        queueTargets[size_t(queued)] = target;
+        return queue[size_t(queued++)].data();
+    }
+
+    void flush(){
+        if (queued == 0){
+            return;
+        }
+#ifdef __linux__
+        // The queue is contiguous, so a run of data packets to the same client already is the buffer of a GSO message.
+        static_assert(sizeof(std::array<uint8_t, DSUProtocol::dataPacketSize>) == DSUProtocol::dataPacketSize, "");
+        int packet = 0;
+        while (packet < queued){
+            int count = 0;
+            for (int start = packet; start < queued; count++){
+                int end = start + 1;
+                if (segmentation && queueSizes[size_t(start)] == DSUProtocol::dataPacketSize){
+                    const sockaddr_in & target = queueTargets[size_t(start)];
+                    while (end < queued && end - start < maxSegments && queueSizes[size_t(end)] == DSUProtocol::dataPacketSize
+                        && queueTargets[size_t(end)].sin_addr.s_addr == target.sin_addr.s_addr && queueTargets[size_t(end)].sin_port == target.sin_port){
+                        end++;
+                    }
+                }
+                msghdr & header = messages[size_t(count)].msg_hdr;
+                vectors[size_t(count)].iov_base = queue[size_t(start)].data();
+                vectors[size_t(count)].iov_len = size_t(end - start) * size_t(queueSizes[size_t(start)]);
+                header.msg_name = &queueTargets[size_t(start)];
+                header.msg_namelen = sizeof(sockaddr_in);
+                header.msg_control = nullptr;
+                header.msg_controllen = 0;
+                if (end - start > 1){
+                    header.msg_control = controls[size_t(count)].data();
+                    header.msg_controllen = controls[size_t(count)].size();
+                    cmsghdr * control = CMSG_FIRSTHDR(&header);
+                    control->cmsg_level = SOL_UDP;
+                    control->cmsg_type = UDP_SEGMENT;
+                    control->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                    const uint16_t segmentSize = DSUProtocol::dataPacketSize;
+                    memcpy(CMSG_DATA(control), &segmentSize, sizeof(segmentSize));
+                }
+                messageStarts[size_t(count)] = start;
+                start = end;
+            }
+            messageStarts[size_t(count)] = queued;
+            packet = queued;
+            // A full socket buffer drops the rest of the batch, the same way UDP would drop them further down, while a message
+            // that can't be sent for another reason (a client address that became unreachable) only drops itself.
+            for (int sent = 0; sent < count;){
+                const int done = sendmmsg(socketHandle, messages.data() + sent, unsigned(count - sent), MSG_DONTWAIT);
+                if (done > 0){
+                    sentPackets += uint64_t(messageStarts[size_t(sent + done)] - messageStarts[size_t(sent)]);
+                    sent += done;
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS){
+                    break;
+                }
+                // A kernel without UDP GSO rejects the message, so it and the rest go again one packet each.
+                if (segmentation && messageStarts[size_t(sent + 1)] - messageStarts[size_t(sent)] > 1
+                    && (errno == EINVAL || errno == EIO || errno == ENOPROTOOPT || errno == EOPNOTSUPP)){
+                    segmentation = false;
+                    packet = messageStarts[size_t(sent)];
+                    break;
+                }
+                sent++;
+            }
+        }
+#else
+        for (int i = 0; i < queued; i++){
+            if (sendto(socketHandle, (const char *)queue[size_t(i)].data(), queueSizes[size_t(i)], 0, (const sockaddr *)&queueTargets[size_t(i)],
+                sizeof(sockaddr_in)) > 0){
+                sentPackets++;
+            }
+        }
+#endif
+        queued = 0;
+    }
+
+    // The part that info and data packets share: slot, state, model, connection type, MAC address and battery.
+    void writeSlotInfo(uint8_t * packet, int slot){
+        const Slot & shared = slots[slot];
+        packet[20] = uint8_t(slot);
+        if (shared.id == -1){
+            memset(packet + 21, 0, 10);
+            return;
+        }
+        packet[21] = DSUProtocol::slotConnected;
+        packet[22] = shared.model;
+        packet[23] = shared.connection;
+        memcpy(packet + 24, shared.mac, 6);
+        packet[30] = shared.battery;
+    }
+
+    Client * findClient(const sockaddr_in & from){
+        Client * unused = nullptr;
+        for (Client & client: clients){
+            if (client.active && client.address.sin_addr.s_addr == from.sin_addr.s_addr && client.address.sin_port == from.sin_port){
+                return &client;
+            }
+            if (!client.active && !unused){
+                unused = &client;
+            }
+        }
+        if (unused){
+            *unused = Client();
+            unused->active = true;
+            unused->address = from;
+        }
+        return unused;
+    }
+
+    void handleRequest(uint8_t * packet, int size, const sockaddr_in & from, uint32_t now){
+        const uint32_t message = DSUProtocol::checkRequest(packet, size);
+        if (message == 0){
+            return;
+        }
+        const int length = DSUProtocol::headerSize + DSUProtocol::read16(packet + 6);
+        if (message == DSUProtocol::versionMessage){
+            uint8_t * response = queuePacket(from, DSUProtocol::headerSize + 6);
+            DSUProtocol::writeHeader(response, DSUProtocol::headerSize + 6, serverId, DSUProtocol::versionMessage);
+            DSUProtocol::write16(response + 20, DSUProtocol::version);
+            DSUProtocol::sealPacket(response, DSUProtocol::headerSize + 6);
+        }
+        else if (message == DSUProtocol::infoMessage && length >= 24){
+            const int count = std::min(int(DSUProtocol::read32(packet + 20)), length - 24);
+            for (int i = 0; i < count; i++){
+                const int slot = packet[24 + i];
+                uint8_t * response = queuePacket(from, DSUProtocol::infoPacketSize);
+                DSUProtocol::writeHeader(response, DSUProtocol::infoPacketSize, serverId, DSUProtocol::infoMessage);
+                if (slot < maxSlots){
+                    writeSlotInfo(response, slot);
+                }
+                else {
+                    response[20] = uint8_t(slot);
+                    memset(response + 21, 0, 10);
+                }
+                response[31] = 0;
+                DSUProtocol::sealPacket(response, DSUProtocol::infoPacketSize);
+            }
+        }
+        else if (message == DSUProtocol::dataMessage && length >= 28){
+            // Flags: 0 subscribes to all slots, bit 0 to the slot in the request, bit 1 to the pad with the MAC address in it.
+            Client * client = findClient(from);
+            if (!client){
+                return;
+            }
+            const uint8_t flags = packet[20];
+            if (flags == 0){
+                client->allRequested = now;
+            }
+            if ((flags & 1) && packet[21] < maxSlots){
+                client->slotRequested[packet[21]] = now;
+            }
+            if (flags & 2){
+                for (int slot = 0; slot < maxSlots; slot++){
+                    if (slots[slot].id != -1 && memcmp(slots[slot].mac, packet + 22, 6) == 0){
+                        client->slotRequested[slot] = now;
+                    }
+                }
+            }
+        }
+    }
+
+    void receive(uint32_t now){
+        uint8_t packet[512];
+        for (;;){
+            sockaddr_in from{};
+#ifdef _WIN32
+            int fromSize = sizeof(from);
+            const int size = recvfrom(socketHandle, (char *)packet, int(sizeof(packet)), 0, (sockaddr *)&from, &fromSize);
+#else
+            socklen_t fromSize = sizeof(from);
+            const int size = int(recvfrom(socketHandle, packet, sizeof(packet), MSG_DONTWAIT, (sockaddr *)&from, &fromSize));
+#endif
+            // Nothing left to read (or an ICMP error from a client that went away, which Windows reports here).
+            if (size < 0){
+#ifdef _WIN32
+                if (WSAGetLastError() == WSAECONNRESET){
+                    continue;
+                }
+#endif
+                return;
+            }
+            handleRequest(packet, size, from, now);
+        }
+    }
+
+    // Takes the sensor values that came in so far as one sample.
+    void takeSample(Slot & slot){
+        if (slot.sampleCount == maxSamples){
+            memmove(slot.samples, slot.samples + 1, sizeof(MotionSample) * (maxSamples - 1));
+            slot.sampleCount--;
+        }
+        MotionSample & sample = slot.samples[slot.sampleCount++];
+        memcpy(sample.accelerometer, slot.accelerometer, sizeof(sample.accelerometer));
+        memcpy(sample.gyroscope, slot.gyroscope, sizeof(sample.gyroscope));
+        slot.pendingSensors = 0;
+    }
+
+public:
+    DSUServer(const std::string & address = "127.0.0.1", uint16_t port = DSUProtocol::defaultPort): address(address), port(port){}
+
+    ~DSUServer(){
+        close();
+    }
+
+    bool open(){
+        close();
+#ifdef _WIN32
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0){
+            return false;
+        }
+        winsockStarted = true;
+#endif
+        sockaddr_in bound{};
+        bound.sin_family = AF_INET;
+        bound.sin_port = htons(port);
+        socketHandle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (socketHandle == invalidSocket || inet_pton(AF_INET, address.c_str(), &bound.sin_addr) != 1
+            || bind(socketHandle, (const sockaddr *)&bound, sizeof(bound)) != 0){
+            close();
+            return false;
+        }
+#ifdef _WIN32
+        u_long nonBlocking = 1;
+        ioctlsocket(socketHandle, FIONBIO, &nonBlocking);
+#else
+        fcntl(socketHandle, F_SETFL, fcntl(socketHandle, F_GETFL, 0) | O_NONBLOCK);
+#endif
+        serverId = uint32_t(microseconds()) ^ 0x44535553u;
+        queue.resize(maxBatch);
+        queueSizes.resize(maxBatch);
+        queueTargets.resize(maxBatch);
+#ifdef __linux__
+        messages.assign(maxBatch, mmsghdr{});
+        vectors.assign(maxBatch, iovec{});
+        controls.assign(maxBatch, {});
+        messageStarts.assign(maxBatch + 1, 0);
+        for (int i = 0; i < maxBatch; i++){
+            messages[size_t(i)].msg_hdr.msg_iov = &vectors[size_t(i)];
+            messages[size_t(i)].msg_hdr.msg_iovlen = 1;
+        }
+#endif
+        for (Client & client: clients){
+            client = Client();
+        }
+        return true;
+    }
+
+    void close(){
+        if (socketHandle != invalidSocket){
+#ifdef _WIN32
+            closesocket(socketHandle);
+#else
+            ::close(socketHandle);
+#endif
+        }
+        socketHandle = invalidSocket;
+#ifdef _WIN32
+        if (winsockStarted){
+            WSACleanup();
+        }
+        winsockStarted = false;
+#endif
+        queued = 0;
+    }
+
+    bool isOpen() const{
+        return socketHandle != invalidSocket;
+    }
+
+    uint16_t getPort() const{
+        return port;
+    }
+
+    int getClientCount() const{
+        int count = 0;
+        for (const Client & client: clients){
+            count += client.active;
+        }
+        return count;
+    }
+
+    uint64_t getSentPackets() const{
+        return sentPackets;
+    }
+
+    // Puts a pad on a slot, with a MAC address that clients can tell it apart by (made up, and unique among the connected pads).
+    void connectSlot(int slot, SDL_JoystickID id, const uint8_t mac[6], bool fullGyro){
+        Slot & shared = slots[slot];
+        shared = Slot();
+        shared.id = id;
+        memcpy(shared.mac, mac, 6);
+        shared.model = fullGyro ? DSUProtocol::modelFullGyro : DSUProtocol::modelPartialGyro;
+    }
+
+    void disconnectSlot(int slot){
+        slots[slot] = Slot();
+    }
+
+    int findSlot(SDL_JoystickID id) const{
+        for (int slot = 0; slot < maxSlots; slot++){
+            if (slots[slot].id == id){
+                return slot;
+            }
+        }
+        return -1;
+    }
+
+    // Feed every SDL_CONTROLLERSENSORUPDATE event here. A sample is taken once both sensors sent a value, or when a sensor sends
+    // a second value before that (a pad with only one of them, whose last value is taken by serve()).
+    void addSensorEvent(const SDL_ControllerSensorEvent & event){
+        const int index = findSlot(event.which);
+        if (index == -1 || (event.sensor != SDL_SENSOR_ACCEL && event.sensor != SDL_SENSOR_GYRO)){
+            return;
+        }
+        Slot & slot = slots[index];
+        const uint32_t bit = event.sensor == SDL_SENSOR_ACCEL ? 1 : 2;
+        if (slot.pendingSensors & bit){
+            takeSample(slot);
+        }
+        memcpy(event.sensor == SDL_SENSOR_ACCEL ? slot.accelerometer : slot.gyroscope, event.data, sizeof(slot.accelerometer));
+        slot.pendingSensors |= bit;
+        slot.seenSensors |= bit;
+        if (slot.pendingSensors == 3){
+            takeSample(slot);
+        }
+    }
+
+    // The buttons, sticks and touchpad of a slot, sent along with every sample until the next call.
+    // The battery is an SDL_JoystickPowerLevel, which also tells wired pads apart.
+    void setInput(int index, const SDLGamepadState & state, const std::vector<SDLGamepadTouchpad> & touchpads, SDL_JoystickPowerLevel power){
+        Slot & slot = slots[index];
+        switch (power){
+            case SDL_JOYSTICK_POWER_EMPTY: slot.battery = 0x01; break;
+            case SDL_JOYSTICK_POWER_LOW: slot.battery = 0x02; break;
+            case SDL_JOYSTICK_POWER_MEDIUM: slot.battery = 0x03; break;
+            case SDL_JOYSTICK_POWER_FULL: slot.battery = 0x05; break;
+            case SDL_JOYSTICK_POWER_WIRED: slot.battery = 0xEF; break;
+            default: slot.battery = 0x00; break;
+        }
+        slot.connection = power == SDL_JOYSTICK_POWER_WIRED ? DSUProtocol::connectionUSB
+            : power == SDL_JOYSTICK_POWER_UNKNOWN ? DSUProtocol::connectionUnknown : DSUProtocol::connectionBluetooth;
+
+        uint8_t * packet = slot.packet.data();
+        DSUProtocol::writeHeader(packet, DSUProtocol::dataPacketSize, serverId, DSUProtocol::dataMessage);
+        writeSlotInfo(packet, index);
+        packet[31] = 1;
+        // Bit masks from the top bit down: D-Pad left, down, right, up, Options, R3, L3, Share, and then the face buttons by
+        // position (left, bottom, right, top), R1, L1, R2, L2. R2 and L2 are pressed past the trigger dead zone, like everywhere
+        // else triggers become buttons.
+        packet[36] = uint8_t((state.DPadLeft ? 0x80 : 0) | (state.DPadDown ? 0x40 : 0) | (state.DPadRight ? 0x20 : 0) | (state.DPadUp ? 0x10 : 0)
+            | (state.Start ? 0x08 : 0) | (state.RightStickClick ? 0x04 : 0) | (state.LeftStickClick ? 0x02 : 0) | (state.Back ? 0x01 : 0));
+        packet[37] = uint8_t((state.X ? 0x80 : 0) | (state.A ? 0x40 : 0) | (state.B ? 0x20 : 0) | (state.Y ? 0x10 : 0)
+            | (state.RightShoulder ? 0x08 : 0) | (state.LeftShoulder ? 0x04 : 0) | (state.RightTrigger > SDLGamepad::deadzones.trigger ? 0x02 : 0)
+            | (state.LeftTrigger > SDLGamepad::deadzones.trigger ? 0x01 : 0));
+        packet[38] = state.Guide ? 1 : 0;
+        packet[39] = state.Touchpad ? 1 : 0;
+        // Sticks go from 0 to 255 with 128 in the middle, and up is 255.
+        auto stick = [](float value){
+            const float scaled = 128.0f + value * 127.0f;
+            return uint8_t(scaled < 0.0f ? 0.0f : scaled > 255.0f ? 255.0f : scaled + 0.5f);
+        };
+        packet[40] = stick(state.LeftStick.x);
+        packet[41] = stick(-state.LeftStick.y);
+        packet[42] = stick(state.RightStick.x);
+        packet[43] = stick(-state.RightStick.y);
+        // The analog versions of the buttons, which only the triggers really have.
+        const int analog[] = {state.DPadLeft, state.DPadDown, state.DPadRight, state.DPadUp, state.X, state.A, state.B, state.Y,
+            state.RightShoulder, state.LeftShoulder};
+        for (int i = 0; i < 10; i++){
+            packet[44 + i] = analog[i] ? 255 : 0;
+        }
+        packet[54] = uint8_t(std::min(std::max(state.RightTrigger, 0.0f), 1.0f) * 255.0f + 0.5f);
+        packet[55] = uint8_t(std::min(std::max(state.LeftTrigger, 0.0f), 1.0f) * 255.0f + 0.5f);
+        memset(packet + 56, 0, 12);
+        if (!touchpads.empty()){
+            const std::vector<SDLGamepadTouchpadFinger> & fingers = touchpads[0].fingers;
+            for (int finger = 0; finger < 2 && finger < int(fingers.size()); finger++){
+                uint8_t * touch = packet + 56 + finger * 6;
+                touch[0] = fingers[size_t(finger)].state ? 1 : 0;
+                touch[1] = uint8_t(finger);
+                DSUProtocol::write16(touch + 2, uint16_t(fingers[size_t(finger)].x * (DSUProtocol::touchpadWidth - 1.0f) + 0.5f));
+                DSUProtocol::write16(touch + 4, uint16_t(fingers[size_t(finger)].y * (DSUProtocol::touchpadHeight - 1.0f) + 0.5f));
+            }
+        }
+    }
+
+    // Answers the requests that came in, and sends every subscribed client the samples of its slots since the last call
+    // (or one packet with the last sample, for a slot that had none).
+    void serve(){
+        if (!isOpen()){
+            return;
+        }
+        const uint32_t now = std::max<uint32_t>(SDL_GetTicks(), 1);
+        receive(now);
+
+        const uint64_t time = microseconds();
+        for (Slot & slot: slots){
+            if (slot.pendingSensors != 0 && slot.pendingSensors == slot.seenSensors){
+                takeSample(slot);
+            }
+            if (slot.id == -1 || slot.sampleCount == 0){
+                continue;
+            }
+            const uint64_t start = slot.lastBatchTime ? slot.lastBatchTime : time - uint64_t(slot.sampleCount) * 1000;
+            for (int i = 0; i < slot.sampleCount; i++){
+                slot.samples[i].timestamp = start + (time - start) * uint64_t(i + 1) / uint64_t(slot.sampleCount);
+            }
+            slot.lastBatchTime = time;
+        }
+
+        for (Client & client: clients){
+            if (!client.active){
+                continue;
+            }
+            bool subscribed = !timedOut(client.allRequested, now);
+            for (int index = 0; index < maxSlots; index++){
+                const bool wanted = !timedOut(client.allRequested, now) || !timedOut(client.slotRequested[index], now);
+                subscribed = subscribed || wanted;
+                const Slot & slot = slots[index];
+                if (!wanted || slot.id == -1){
+                    continue;
+                }
+                const int count = std::max(slot.sampleCount, 1);
+                for (int i = 0; i < count; i++){
+                    const MotionSample & sample = slot.sampleCount ? slot.samples[i] : slot.last;
+                    uint8_t * packet = queuePacket(client.address, DSUProtocol::dataPacketSize);
+                    memcpy(packet, slot.packet.data(), DSUProtocol::dataPacketSize);
+                    DSUProtocol::write32(packet + 32, client.packetNumber++);
+                    DSUProtocol::write64(packet + 68, sample.timestamp);
+                    // DSU has the same axes as SDL (x right, y up, z toward the player), in g and degrees per second.
+                    for (int axis = 0; axis < 3; axis++){
+                        DSUProtocol::writeFloat(packet + 76 + axis * 4, sample.accelerometer[axis] / SDL_STANDARD_GRAVITY);
+                        DSUProtocol::writeFloat(packet + 88 + axis * 4, sample.gyroscope[axis] * 57.2957795f);
+                    }
+                    DSUProtocol::sealPacket(packet, DSUProtocol::dataPacketSize);
+                }
+            }
+            if (!subscribed){
+                client.active = false;
+            }
+        }
+        flush();
+
+        for (Slot & slot: slots){
+            if (slot.sampleCount){
+                slot.last = slot.samples[slot.sampleCount - 1];
+                slot.sampleCount = 0;
+            }
+        }
+    }
+
+    // Keeps a slot for every pad (up to maxSlots), and turns on their gyroscope and accelerometer once the capability probe has
+    // found them, the way the checkboxes of the pad's window would. Call once per frame, after pollState() of every pad.
+    void update(const std::vector<SDLGamepad *> & pads){
+        bool connected[maxSlots] = {};
+        for (SDLGamepad * pad: pads){
+            int slot = findSlot(pad->id);
+            if (slot == -1){
+                slot = findSlot(-1);
+                if (slot == -1){
+                    continue;
+                }
+                // The MAC address is made from the serial number, so that a pad keeps it when it reconnects. The joystick GUID
+                // only tells the model, so pads without a serial number get the slot mixed in, to keep two of a kind apart.
+                uint64_t hash = 14695981039346656037ull;
+                const char * serial = SDL_GameControllerGetSerial(pad->getController());
+                if (serial && serial[0]){
+                    for (const char * c = serial; *c; c++){
+                        hash = (hash ^ uint8_t(*c)) * 1099511628211ull;
+                    }
+                }
+                else {
+                    SDL_JoystickGUID guid = SDL_JoystickGetGUID(SDL_GameControllerGetJoystick(pad->getController()));
+                    for (uint8_t byte: guid.data){
+                        hash = (hash ^ byte) * 1099511628211ull;
+                    }
+                    hash = (hash ^ uint8_t(slot)) * 1099511628211ull;
+                }
+                uint8_t mac[6];
+                for (int i = 0; i < 6; i++){
+                    mac[i] = uint8_t(hash >> (8 * i));
+                }
+                // A locally administered, unicast address
+                mac[0] = uint8_t((mac[0] | 0x02) & ~0x01);
+                // Two pads reporting the same serial number (or hashing alike) still get addresses of their own.
+                for (int other = 0; other < maxSlots; other++){
+                    if (other != slot && slots[other].id != -1 && memcmp(slots[other].mac, mac, 6) == 0){
+                        mac[5] = uint8_t(mac[5] + 1);
+                        other = -1;
+                    }
+                }
+                connectSlot(slot, pad->id, mac, false);
+            }
+            connected[slot] = true;
+            Slot & shared = slots[slot];
+            if (!shared.sensorsRequested && pad->capabilitiesReady()){
+                shared.sensorsRequested = true;
+                shared.model = pad->hasGyroscope() ? DSUProtocol::modelFullGyro : DSUProtocol::modelPartialGyro;
+                if (pad->hasGyroscope()){
+                    pad->setSensor(SDL_SENSOR_GYRO, SDL_TRUE);
+                }
+                if (pad->hasAccelerometer()){
+                    pad->setSensor(SDL_SENSOR_ACCEL, SDL_TRUE);
+                }
+            }
+            static const std::vector<SDLGamepadTouchpad> noTouchpads;
+            setInput(slot, pad->state, pad->queryTouchpads && pad->capabilitiesReady() ? pad->touchpads : noTouchpads,
+                SDL_JoystickCurrentPowerLevel(SDL_GameControllerGetJoystick(pad->getController())));
+        }
+        for (int slot = 0; slot < maxSlots; slot++){
+            if (slots[slot].id != -1 && !connected[slot]){
+                disconnectSlot(slot);
+            }
+        }
+        serve();
+    }
+};
@@ -0,0 +1,204 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_gamecontroller.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// What SDLGamepad finds out about a pad by probing it.
+struct SDLGamepadCapabilities{
+    bool haptics = false;
+    bool triggerHaptics = false;
+    bool accelerometer = false;
+    bool gyroscope = false;
+    bool led = false;
+    // The number of fingers of each touchpad.
+    std::vector<int> touchpadFingers;
+};
+
+// Remembers the capabilities of every pad model that was probed, so that a model that connects again (in this session or
+// a later one) gets them without any probing. Models are told apart by joystick GUID and USB vendor/product IDs, so the same
+// model over USB and over Bluetooth gets two profiles. SDLGamepad's probe threads add profiles, so all of it is thread safe.
+//
+// The file is plain text, one line per model: "<GUID> <vendor> <product> <flags> <touchpads> <fingers>..." in hex, after a header
+// line with the file version and the SDL version that did the probing. Drivers change between SDL versions, so a file written by
+// another one is ignored, and every pad gets probed once more.
+class GamepadCapabilityCache{
+private:
+    enum Flags{
+        Haptics = 1 << 0,
+        TriggerHaptics = 1 << 1,
+        Accelerometer = 1 << 2,
+        Gyroscope = 1 << 3,
+        LED = 1 << 4,
+    };
+    static constexpr int version = 1;
+
+    std::string path;
+    std::mutex mutex;
+    std::map<std::string, SDLGamepadCapabilities> profiles;
+    bool dirty = false;
+
+    static std::string header(){
+        SDL_version sdl;
+        SDL_GetVersion(&sdl);
+        char text[64];
+        snprintf(text, sizeof(text), "SDLGamepadCapabilities %d %d.%d.%d", version, sdl.major, sdl.minor, sdl.patch);
+        return text;
+    }
+
+    static std::string formatProfile(const std::string & key, const SDLGamepadCapabilities & capabilities){
+        int flags = (capabilities.haptics ? Haptics : 0) | (capabilities.triggerHaptics ? TriggerHaptics : 0)
+            | (capabilities.accelerometer ? Accelerometer : 0) | (capabilities.gyroscope ? Gyroscope : 0) | (capabilities.led ? LED : 0);
+        char text[32];
+        snprintf(text, sizeof(text), " %x %x", flags, unsigned(capabilities.touchpadFingers.size()));
+        std::string line = key + text;
+        for (int fingers: capabilities.touchpadFingers){
+            snprintf(text, sizeof(text), " %x", fingers);
+            line += text;
+        }
+        return line + "\n";
+    }
+
+    // Returns false for lines that don't hold a complete profile.
+    static bool parseProfile(const std::string & line, std::string & key, SDLGamepadCapabilities & capabilities){
+        char guid[33];
+        unsigned int vendor, product, flags, touchpads;
+        int used = 0;
+        if (sscanf(line.c_str(), "%32s %x %x %x %x%n", guid, &vendor, &product, &flags, &touchpads, &used) != 5 || touchpads > 16){
+            return false;
+        }
+        key = makeKey(guid, Uint16(vendor), Uint16(product));
+        capabilities = SDLGamepadCapabilities();
+        capabilities.haptics = flags & Haptics;
+        capabilities.triggerHaptics = flags & TriggerHaptics;
+        capabilities.accelerometer = flags & Accelerometer;
+        capabilities.gyroscope = flags & Gyroscope;
+        capabilities.led = flags & LED;
+        const char * cursor = line.c_str() + used;
+        for (unsigned int i = 0; i < touchpads; i++){
+            char * end;
+            long fingers = strtol(cursor, &end, 16);
+            if (end == cursor || fingers < 0 || fingers > 16){
+                return false;
+            }
+            capabilities.touchpadFingers.push_back(int(fingers));
+            cursor = end;
+        }
+        return true;
+    }
+
+    static std::string makeKey(const char * guid, Uint16 vendor, Uint16 product){
+        char text[64];
+        snprintf(text, sizeof(text), "%s %04x %04x", guid, vendor, product);
+        return text;
+    }
+
+public:
+    GamepadCapabilityCache(const std::string & filePath): path(filePath){}
+
+    GamepadCapabilityCache(const GamepadCapabilityCache &) = delete;
+    GamepadCapabilityCache & operator=(const GamepadCapabilityCache &) = delete;
+
+    // The key of the model of an open controller. It only reads what SDL already knows about the device, without talking to it.
+    static std::string key(SDL_GameController * controller){
+        char guid[33];
+        SDL_JoystickGetGUIDString(SDL_JoystickGetGUID(SDL_GameControllerGetJoystick(controller)), guid, sizeof(guid));
+        return makeKey(guid, SDL_GameControllerGetVendor(controller), SDL_GameControllerGetProduct(controller));
+    }
+
+    bool find(const std::string & key, SDLGamepadCapabilities & capabilities){
+        std::lock_guard<std::mutex> lock(mutex);
+        auto profile = profiles.find(key);
+        if (profile == profiles.end()){
+            return false;
+        }
+        capabilities = profile->second;
+        return true;
+    }
+
+    void store(const std::string & key, const SDLGamepadCapabilities & capabilities){
+        std::lock_guard<std::mutex> lock(mutex);
+        profiles[key] = capabilities;
+        dirty = true;
+    }
+
+    size_t size(){
+        std::lock_guard<std::mutex> lock(mutex);
+        return profiles.size();
+    }
+
+    // Adds the profiles from the file. Returns false if there is no file, or it was written by another version.
+    bool load(){
+        FILE * file = fopen(path.c_str(), "rb");
+        if (!file){
+            return false;
+        }
+        std::string text;
+        char buffer[4096];
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0){
+            text.append(buffer, read);
+        }
+        fclose(file);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t lineStart = 0;
+        bool first = true;
+        while (lineStart < text.size()){
+            size_t lineEnd = text.find('\n', lineStart);
+            lineEnd = lineEnd == std::string::npos ? text.size() : lineEnd;
+            std::string line = text.substr(lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 1;
+            if (first){
+                if (line != header()){
+                    return false;
+                }
+                first = false;
+                continue;
+            }
+            std::string key;
+            SDLGamepadCapabilities capabilities;
+            if (parseProfile(line, key, capabilities)){
+                profiles.emplace(key, capabilities);
+            }
+        }
+        return !first;
+    }
+
+    // Writes the profiles if any were added since the last load() or save(), through a temporary file that replaces the old one.
+    bool save(){
+        std::string text = header() + "\n";
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!dirty){
+                return true;
+            }
+            for (const auto & profile: profiles){
+                text += formatProfile(profile.first, profile.second);
+            }
+            dirty = false;
+        }
+        std::string temporaryPath = path + ".tmp";
+        bool ok = false;
+        if (FILE * file = fopen(temporaryPath.c_str(), "wb")){
+            ok = fwrite(text.data(), 1, text.size(), file) == text.size();
+            ok = (fclose(file) == 0) && ok;
+        }
+#ifdef _WIN32
+        if (ok){
+            remove(path.c_str()); // rename() doesn't replace existing files on Windows
+        }
+#endif
+        ok = ok && rename(temporaryPath.c_str(), path.c_str()) == 0;
+        if (!ok){
+            std::lock_guard<std::mutex> lock(mutex);
+            dirty = true;
+        }
+        return ok;
+    }
+};
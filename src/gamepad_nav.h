@@ -0,0 +1,68 @@
+#pragma once
+#include "imgui/imgui.h"
+#include "sdl_gamepad.h"
+
+#include <cstring>
+#include <vector>
+
+// Fills io.NavInputs from the SDLGamepadState that the gamepads already polled this frame, instead of the ImGui SDL backend
+// opening and querying a game controller of its own. Use it with ImGui_ImplSDL2_SetGamepadNavExternal(true), and call apply()
+// every frame after ImGui_ImplSDL2_NewFrame() and before ImGui::NewFrame(). It doesn't make any SDL call.
+class GamepadNavBridge{
+public:
+    // The pad that drives the UI, or -1 for every connected pad, in which case each input takes the strongest value among them.
+    SDL_JoystickID pad = -1;
+
+    void apply(const std::vector<SDLGamepad *> & gamepads, ImGuiIO & io) const{
+        memset(io.NavInputs, 0, sizeof(io.NavInputs));
+        bool hasGamepad = false;
+        if (io.ConfigFlags & ImGuiConfigFlags_NavEnableGamepad){
+            for (const SDLGamepad * gamepad: gamepads){
+                if (pad == -1 || gamepad->id == pad){
+                    merge(gamepad->state, io.NavInputs);
+                    hasGamepad = true;
+                }
+            }
+        }
+        if (hasGamepad){
+            io.BackendFlags |= ImGuiBackendFlags_HasGamepad;
+        }
+        else {
+            io.BackendFlags &= ~ImGuiBackendFlags_HasGamepad;
+        }
+    }
+
+private:
+    static void button(float * navInputs, ImGuiNavInput input, int pressed){
+        if (pressed){
+            navInputs[input] = 1.0f;
+        }
+    }
+
+    static void axis(float * navInputs, ImGuiNavInput input, float value){
+        value = SDLGamepadDeadzones::apply(value, SDLGamepad::deadzones.stick);
+        if (value > navInputs[input]){
+            navInputs[input] = value;
+        }
+    }
+
+    // Same mapping as ImGui_ImplSDL2_UpdateGamepads().
+    static void merge(const SDLGamepadState & state, float * navInputs){
+        button(navInputs, ImGuiNavInput_Activate, state.A);                 // Cross / A
+        button(navInputs, ImGuiNavInput_Cancel, state.B);                   // Circle / B
+        button(navInputs, ImGuiNavInput_Menu, state.X);                     // Square / X
+        button(navInputs, ImGuiNavInput_Input, state.Y);                    // Triangle / Y
+        button(navInputs, ImGuiNavInput_DpadLeft, state.DPadLeft);
+        button(navInputs, ImGuiNavInput_DpadRight, state.DPadRight);
+        button(navInputs, ImGuiNavInput_DpadUp, state.DPadUp);
+        button(navInputs, ImGuiNavInput_DpadDown, state.DPadDown);
+        button(navInputs, ImGuiNavInput_FocusPrev, state.LeftShoulder);     // L1 / LB
+        button(navInputs, ImGuiNavInput_FocusNext, state.RightShoulder);    // R1 / RB
+        button(navInputs, ImGuiNavInput_TweakSlow, state.LeftShoulder);
+        button(navInputs, ImGuiNavInput_TweakFast, state.RightShoulder);
+        axis(navInputs, ImGuiNavInput_LStickLeft, -state.LeftStick.x);
+        axis(navInputs, ImGuiNavInput_LStickRight, state.LeftStick.x);
+        axis(navInputs, ImGuiNavInput_LStickUp, -state.LeftStick.y);
+        axis(navInputs, ImGuiNavInput_LStickDown, state.LeftStick.y);
+    }
+};
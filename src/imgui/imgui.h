@@ -127,6 +127,7 @@ struct ImDrawListSplitter;          // Helper to split a draw list into differen
 struct ImDrawVert;                  // A single vertex (pos + uv + col = 20 bytes by default. Override layout with IMGUI_OVERRIDE_DRAWVERT_STRUCT_LAYOUT)
 struct ImFont;                      // Runtime data for a single font within a parent ImFontAtlas
 struct ImFontAtlas;                 // Runtime data for multiple fonts, bake multiple fonts into a single texture, TTF/OTF font loader
+struct ImFontAtlasDynamicData;      // Opaque rasterizer/packer state kept by an atlas built with ImFontAtlasFlags_DynamicGlyphs
 struct ImFontBuilderIO;             // Opaque interface to a font builder (stb_truetype or FreeType).
 struct ImFontConfig;                // Configuration data when adding a font or merging fonts
 struct ImFontGlyph;                 // A single font glyph (code point + coordinates within in ImFontAtlas + offset)
@@ -194,6 +195,7 @@ typedef void* ImTextureID;          // User data for rendering backend to identi
 typedef unsigned int ImGuiID;       // A unique ID used by widgets, typically hashed from a stack of string.
 typedef int (*ImGuiInputTextCallback)(ImGuiInputTextCallbackData* data);    // Callback function for ImGui::InputText()
 typedef void (*ImGuiSizeCallback)(ImGuiSizeCallbackData* data);             // Callback function for ImGui::SetNextWindowSizeConstraints()
+typedef void (*ImGuiParallelJobFn)(void* job_data, int job_index);          // Job function passed to ImGuiIO::ParallelForFn
 typedef void* (*ImGuiMemAllocFunc)(size_t sz, void* user_data);             // Function signature for ImGui::SetAllocatorFunctions()
 typedef void (*ImGuiMemFreeFunc)(void* ptr, void* user_data);               // Function signature for ImGui::SetAllocatorFunctions()
 
@@ -261,7 +263,9 @@ namespace ImGui
     // - Each context create its own ImFontAtlas by default. You may instance one yourself and pass it to CreateContext() to share a font atlas between contexts.
     // - DLL users: heaps and globals are not shared across DLL boundaries! You will need to call SetCurrentContext() + SetAllocatorFunctions()
     //   for each static/DLL boundary you are calling from. Read "Context and Memory Allocators" section of imgui.cpp for details.
-    IMGUI_API ImGuiContext* CreateContext(ImFontAtlas* shared_font_atlas = NULL);
+    // - With pool_allocator, small allocations made while the context is current come out of size class pools owned by the context instead of the allocator functions,
+    //   which avoids malloc() contention and heap fragmentation when running many contexts. Statistics are in ShowMetricsWindow().
+    IMGUI_API ImGuiContext* CreateContext(ImFontAtlas* shared_font_atlas = NULL, bool pool_allocator = false);
     IMGUI_API void          DestroyContext(ImGuiContext* ctx = NULL);   // NULL = destroy current context
     IMGUI_API ImGuiContext* GetCurrentContext();
     IMGUI_API void          SetCurrentContext(ImGuiContext* ctx);
@@ -455,6 +459,10 @@ namespace ImGui
     IMGUI_API void          TextDisabledV(const char* fmt, va_list args)                    IM_FMTLIST(1);
     IMGUI_API void          TextWrapped(const char* fmt, ...)                               IM_FMTARGS(1); // shortcut for PushTextWrapPos(0.0f); Text(fmt, ...); PopTextWrapPos();. Note that this won't work on an auto-resizing window if there's no other widgets to extend the window width, yoy may need to set a size using SetNextWindowSize().
     IMGUI_API void          TextWrappedV(const char* fmt, va_list args)                     IM_FMTLIST(1);
+    IMGUI_API void          TextFloat(const char* label, float v, int precision = 3);           // "label: v", with v formatted like "%.3f" but without going through vsnprintf(). Faster for values updated every frame, and locale independent.
+    IMGUI_API void          TextFloat2(const char* label, float x, float y, int precision = 3); // "label (x: x, y: y)"
+    IMGUI_API void          TextFloat3(const char* label, float x, float y, float z, int precision = 3); // "label (x: x, y: y, z: z)"
+    IMGUI_API void          TextInt(const char* label, int v);                                  // "label: v"
     IMGUI_API void          LabelText(const char* label, const char* fmt, ...)              IM_FMTARGS(2); // display text+label aligned the same way as value+label widgets
     IMGUI_API void          LabelTextV(const char* label, const char* fmt, va_list args)    IM_FMTLIST(2);
     IMGUI_API void          BulletText(const char* fmt, ...)                                IM_FMTARGS(1); // shortcut for Bullet()+Text()
@@ -1787,6 +1795,8 @@ struct ImGuiIO
     bool        ConfigWindowsResizeFromEdges;   // = true           // Enable resizing of windows from their edges and from the lower-left corner. This requires (io.BackendFlags & ImGuiBackendFlags_HasMouseCursors) because it needs mouse cursor feedback. (This used to be a per-window ImGuiWindowFlags_ResizeFromAnySide flag)
     bool        ConfigWindowsMoveFromTitleBarOnly; // = false       // Enable allowing to move windows only when clicking on their title bar. Does not apply to windows without a title bar.
     float       ConfigMemoryCompactTimer;       // = 60.0f          // Timer (in seconds) to free transient windows/tables memory buffers when unused. Set to -1.0f to disable.
+    bool        ConfigDeferTessellation;        // = false          // Record lines and convex fills during the frame and write their vertices in Render(), spread over io.ParallelForFn when set. Vertices and indices end up identical.
+    bool        ConfigDrawListHighWaterMark;    // = false          // Keep the vertex/index buffers of each window's draw list sized after the largest content they ever held (plus headroom), reserved while empty at the start of the window and never freed by memory compaction, so they stop reallocating once warmed up.
 
     //------------------------------------------------------------------
     // Platform Functions
@@ -1811,6 +1821,11 @@ struct ImGuiIO
     void        (*ImeSetInputScreenPosFn)(int x, int y);
     void*       ImeWindowHandle;                // = NULL           // (Windows) Set this to your HWND to get automatic IME cursor positioning.
 
+    // Optional: Run job(job_data, 0) .. job(job_data, job_count - 1) on worker threads, in any order, and only return once all of them are done.
+    // Used by Render() to tessellate draw lists in parallel when io.ConfigDeferTessellation is enabled. NULL runs the jobs one after the other.
+    void        (*ParallelForFn)(void* user_data, int job_count, ImGuiParallelJobFn job, void* job_data);
+    void*       ParallelForUserData;            // = NULL
+
     //------------------------------------------------------------------
     // Input - Fill before calling NewFrame()
     //------------------------------------------------------------------
@@ -2051,6 +2066,7 @@ struct ImGuiTextBuffer
 // Typically you don't have to worry about this since a storage is held within each Window.
 // We use it to e.g. store collapse state for a tree (Int 0/1)
 // This is optimized for efficient lookup (dichotomy into a contiguous buffer) and rare insertion (typically tied to user interactions aka max once a frame)
+// With IMGUI_USE_HASHED_STORAGE, Data is kept in insertion order instead, with an open addressing hash table on the side for O(1) lookup and insertion.
 // You can use it as custom user storage for temporary values. Declare your own storage if, for example:
 // - You want to manipulate the open/close state of a particular sub-tree in your interface (tree node uses Int 0/1 to store their state).
 // - You want to store custom debug data easily without adding or editing structures in your code (probably not efficient, but convenient)
@@ -2068,11 +2084,21 @@ struct ImGuiStorage
     };
 
     ImVector<ImGuiStoragePair>      Data;
+#ifdef IMGUI_USE_HASHED_STORAGE
+    ImVector<int>                   Index;          // Hash table with linear probing: index into Data + 1 for each used slot, 0 for empty ones. Power of 2 sized, at most half full.
+    int                             IndexedCount;   // Number of pairs of Data that are in Index. Pairs pushed directly into Data get indexed on the next query.
+
+    ImGuiStorage()      { IndexedCount = 0; }
+#endif
 
-    // - Get***() functions find pair, never add/allocate. Pairs are sorted so a query is O(log N)
+    // - Get***() functions find pair, never add/allocate. Pairs are sorted so a query is O(log N) (O(1) with IMGUI_USE_HASHED_STORAGE)
     // - Set***() functions find pair, insertion on demand if missing.
     // - Sorted insertion is costly, paid once. A typical frame shouldn't need to insert any new pair.
+#ifdef IMGUI_USE_HASHED_STORAGE
+    void                Clear() { Data.clear(); Index.clear(); IndexedCount = 0; }
+#else
     void                Clear() { Data.clear(); }
+#endif
     IMGUI_API int       GetInt(ImGuiID key, int default_val = 0) const;
     IMGUI_API void      SetInt(ImGuiID key, int val);
     IMGUI_API bool      GetBool(ImGuiID key, bool default_val = false) const;
@@ -2094,6 +2120,9 @@ struct ImGuiStorage
     // Use on your own storage if you know only integer are being stored (open/close all tree nodes)
     IMGUI_API void      SetAllInt(int val);
 
+    // Removes the pair of a key, if any. References to other pairs are invalidated too.
+    IMGUI_API void      RemoveKey(ImGuiID key);
+
     // For quicker full rebuild of a storage (instead of an incremental one), you may add all your contents and then sort once.
     IMGUI_API void      BuildSortByKey();
 };
@@ -2257,6 +2286,20 @@ struct ImDrawCmdHeader
     unsigned int    VtxOffset;
 };
 
+// [Internal] For use by ImDrawList: an AddPolyline()/AddConvexPolyFilled() call whose vertices are still to be written (ImDrawListFlags_DeferTessellation)
+struct ImDrawDeferredPrim
+{
+    int             VtxOffset;          // Index in VtxBuffer of the first vertex reserved for the primitive
+    int             PointsOffset;       // Index in _DeferredPoints of the first point
+    int             PointsCount;
+    ImU32           Col;
+    float           Thickness;
+    ImDrawFlags     Flags;
+    ImDrawListFlags ListFlags;          // ImDrawList::Flags at the time of the call (anti-aliasing)
+    float           FringeScale;
+    bool            Filled;             // AddConvexPolyFilled() rather than AddPolyline()
+};
+
 // [Internal] For use by ImDrawListSplitter
 struct ImDrawChannel
 {
@@ -2310,7 +2353,8 @@ enum ImDrawListFlags_
     ImDrawListFlags_AntiAliasedLines        = 1 << 0,  // Enable anti-aliased lines/borders (*2 the number of triangles for 1.0f wide line or lines thin enough to be drawn using textures, otherwise *3 the number of triangles)
     ImDrawListFlags_AntiAliasedLinesUseTex  = 1 << 1,  // Enable anti-aliased lines/borders using textures when possible. Require backend to render with bilinear filtering.
     ImDrawListFlags_AntiAliasedFill         = 1 << 2,  // Enable anti-aliased edge around filled shapes (rounded rectangles, circles).
-    ImDrawListFlags_AllowVtxOffset          = 1 << 3   // Can emit 'VtxOffset > 0' to allow large meshes. Set when 'ImGuiBackendFlags_RendererHasVtxOffset' is enabled.
+    ImDrawListFlags_AllowVtxOffset          = 1 << 3,  // Can emit 'VtxOffset > 0' to allow large meshes. Set when 'ImGuiBackendFlags_RendererHasVtxOffset' is enabled.
+    ImDrawListFlags_DeferTessellation       = 1 << 4   // AddPolyline()/AddConvexPolyFilled() only write their indices, their vertices are written by _TessellateDeferred() (called by Render()). Set when 'io.ConfigDeferTessellation' is enabled.
 };
 
 // Draw command list
@@ -2342,6 +2386,8 @@ struct ImDrawList
     ImDrawCmdHeader         _CmdHeader;         // [Internal] template of active commands. Fields should match those of CmdBuffer.back().
     ImDrawListSplitter      _Splitter;          // [Internal] for channels api (note: prefer using your own persistent instance of ImDrawListSplitter!)
     float                   _FringeScale;       // [Internal] anti-alias fringe is scaled by this value, this helps to keep things sharp while zooming at vertex buffer content
+    ImVector<ImDrawDeferredPrim> _DeferredPrims; // [Internal] primitives whose vertices are written by _TessellateDeferred()
+    ImVector<ImVec2>        _DeferredPoints;    // [Internal] copies of their points
 
     // If you want to create ImDrawList instances, pass them ImGui::GetDrawListSharedData() or create and use your own ImDrawListSharedData (so you can use ImDrawList without ImGui)
     ImDrawList(const ImDrawListSharedData* shared_data) { memset(this, 0, sizeof(*this)); _Data = shared_data; }
@@ -2442,6 +2488,7 @@ struct ImDrawList
     IMGUI_API int   _CalcCircleAutoSegmentCount(float radius) const;
     IMGUI_API void  _PathArcToFastEx(const ImVec2& center, float radius, int a_min_sample, int a_max_sample, int a_step);
     IMGUI_API void  _PathArcToN(const ImVec2& center, float radius, float a_min, float a_max, int num_segments);
+    IMGUI_API void  _TessellateDeferred();      // Write the vertices of the primitives recorded with ImDrawListFlags_DeferTessellation. Lists are independent and can be tessellated from different threads.
 };
 
 // All draw data to render a Dear ImGui frame
@@ -2502,7 +2549,8 @@ struct ImFontGlyph
 {
     unsigned int    Colored : 1;        // Flag to indicate glyph is colored and should generally ignore tinting (make it usable with no shift on little-endian as this is used in loops)
     unsigned int    Visible : 1;        // Flag to indicate glyph has no visible pixels (e.g. space). Allow early out when rendering.
-    unsigned int    Codepoint : 30;     // 0x0000..0x10FFFF
+    unsigned int    Pending : 1;        // Flag to indicate glyph is registered but not rasterized yet (ImFontAtlasFlags_DynamicGlyphs). FindGlyph() rasterizes it, until then it is not Visible.
+    unsigned int    Codepoint : 29;     // 0x0000..0x10FFFF
     float           AdvanceX;           // Distance to next character (= data from font + ImFontConfig::GlyphExtraSpacing.x baked in)
     float           X0, Y0, X1, Y1;     // Glyph corners
     float           U0, V0, U1, V1;     // Texture coordinates
@@ -2543,7 +2591,8 @@ enum ImFontAtlasFlags_
     ImFontAtlasFlags_None               = 0,
     ImFontAtlasFlags_NoPowerOfTwoHeight = 1 << 0,   // Don't round the height to next power of two
     ImFontAtlasFlags_NoMouseCursors     = 1 << 1,   // Don't build software mouse cursors into the atlas (save a little texture memory)
-    ImFontAtlasFlags_NoBakedLines       = 1 << 2    // Don't build thick line textures into the atlas (save a little texture memory). The AntiAliasedLinesUseTex features uses them, otherwise they will be rendered using polygons (more expensive for CPU/GPU).
+    ImFontAtlasFlags_NoBakedLines       = 1 << 2,   // Don't build thick line textures into the atlas (save a little texture memory). The AntiAliasedLinesUseTex features uses them, otherwise they will be rendered using polygons (more expensive for CPU/GPU).
+    ImFontAtlasFlags_DynamicGlyphs      = 1 << 3    // Only rasterize glyphs up to U+00FF in Build(), others are rasterized into free space of the texture the first time FindGlyph() returns them (stb_truetype builder only). See IsTexDirty().
 };
 
 // Load and rasterize multiple TTF/OTF fonts into a same texture. The font atlas will build a single texture holding:
@@ -2589,6 +2638,12 @@ struct ImFontAtlas
     bool                        IsBuilt() const             { return Fonts.Size > 0 && (TexPixelsAlpha8 != NULL || TexPixelsRGBA32 != NULL); }
     void                        SetTexID(ImTextureID id)    { TexID = id; }
 
+    // With ImFontAtlasFlags_DynamicGlyphs, glyphs keep being rasterized into the texture data during the frame, so don't call ClearTexData()/ClearInputData() after uploading it.
+    // Before rendering, backends should re-upload the whole texture if TexWidth/TexHeight changed (it grows between frames when it runs out of space),
+    // otherwise upload the TexDirtyX0/Y0/X1/Y1 rectangle if IsTexDirty(), then call ClearTexDirty().
+    bool                        IsTexDirty() const          { return TexDirtyX1 > TexDirtyX0 && TexDirtyY1 > TexDirtyY0; }
+    void                        ClearTexDirty()             { TexDirtyX0 = TexDirtyY0 = TexDirtyX1 = TexDirtyY1 = 0; }
+
     //-------------------------------------------
     // Glyph Ranges
     //-------------------------------------------
@@ -2647,6 +2702,8 @@ struct ImFontAtlas
     ImVector<ImFontAtlasCustomRect> CustomRects;    // Rectangles for packing custom texture data into the atlas.
     ImVector<ImFontConfig>      ConfigData;         // Configuration data
     ImVec4                      TexUvLines[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1];  // UVs for baked anti-aliased lines
+    int                         TexDirtyX0, TexDirtyY0, TexDirtyX1, TexDirtyY1;   // Texels written since the last ClearTexDirty() (ImFontAtlasFlags_DynamicGlyphs), X1/Y1 are exclusive.
+    ImFontAtlasDynamicData*     DynamicData;        // State needed to rasterize the pending glyphs, owned by the atlas. NULL unless built with ImFontAtlasFlags_DynamicGlyphs.
 
     // [Internal] Font builder
     const ImFontBuilderIO*      FontBuilderIO;      // Opaque interface to a font builder (default to stb_truetype, can be changed to use FreeType by defining IMGUI_ENABLE_FREETYPE).
@@ -2686,6 +2743,7 @@ struct ImFont
     float                       Scale;              // 4     // in  // = 1.f      // Base font scale, multiplied by the per-window font scale which you can adjust with SetWindowFontScale()
     float                       Ascent, Descent;    // 4+4   // out //            // Ascent: distance from top to bottom of e.g. 'A' [0..FontSize]
     int                         MetricsTotalSurface;// 4     // out //            // Total surface in pixels to get an idea of the font rasterization/texture cost (not exact, we approximate the cost of padding between glyphs)
+    int                         GlyphsVersion;      // 4     // out //            // Changed to a new value (never used by any font before) every time the glyphs or lookup tables change, so that cached text layouts can tell they are stale.
     ImU8                        Used4kPagesMap[(IM_UNICODE_CODEPOINT_MAX+1)/4096/8]; // 2 bytes if ImWchar=ImWchar16, 34 bytes if ImWchar==ImWchar32. Store 1-bit for each block of 4K codepoints that has one active glyph. This is mainly used to facilitate iterations across all used codepoints.
 
     // Methods
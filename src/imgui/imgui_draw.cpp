@@ -413,6 +413,8 @@ void ImDrawList::_ResetForNewFrame()
     _TextureIdStack.resize(0);
     _Path.resize(0);
     _Splitter.Clear();
+    _DeferredPrims.resize(0);
+    _DeferredPoints.resize(0);
     CmdBuffer.push_back(ImDrawCmd());
     _FringeScale = 1.0f;
 }
@@ -430,10 +432,13 @@ void ImDrawList::_ClearFreeMemory()
     _TextureIdStack.clear();
     _Path.clear();
     _Splitter.ClearFreeMemory();
+    _DeferredPrims.clear();
+    _DeferredPoints.clear();
 }
 
 ImDrawList* ImDrawList::CloneOutput() const
 {
+    IM_ASSERT(_DeferredPrims.Size == 0 && "Call _TessellateDeferred() first, or clone the draw list after Render().");
     ImDrawList* dst = IM_NEW(ImDrawList(_Data));
     dst->CmdBuffer = CmdBuffer;
     dst->IdxBuffer = IdxBuffer;
@@ -691,59 +696,275 @@ void ImDrawList::PrimQuadUV(const ImVec2& a, const ImVec2& b, const ImVec2& c, c
 #define IM_NORMALIZE2F_OVER_ZERO(VX,VY)     do { float d2 = VX*VX + VY*VY; if (d2 > 0.0f) { float inv_len = 1.0f / ImSqrt(d2); VX *= inv_len; VY *= inv_len; } } while (0)
 #define IM_FIXNORMAL2F(VX,VY)               do { float d2 = VX*VX + VY*VY; if (d2 < 0.5f) d2 = 0.5f; float inv_lensq = 1.0f / d2; VX *= inv_lensq; VY *= inv_lensq; } while (0)
 
+// Tessellation kernels, 4 lanes at a time with SSE2 or NEON (see IMGUI_ENABLE_SSE in imgui_internal.h), then scalar for the remaining points.
+// The normals, miters and bezier points do the same IEEE operations in the same order as the scalar code, so they give the same results unless
+// the compiler contracts the scalar code into FMAs. Arcs use a polynomial sin/cos (Cephes sinf/cosf) which is within a couple of ulps of ImSin()/ImCos().
+#if defined(IMGUI_ENABLE_SSE) || defined(IMGUI_ENABLE_NEON)
+#if defined(IMGUI_ENABLE_SSE)
+typedef __m128 ImFloat4;
+typedef __m128 ImMask4;
+static inline ImFloat4 ImFloat4_Splat(float v)                          { return _mm_set1_ps(v); }
+static inline ImFloat4 ImFloat4_Ramp(float v)                           { return _mm_add_ps(_mm_set1_ps(v), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f)); }
+static inline ImFloat4 ImFloat4_Add(ImFloat4 a, ImFloat4 b)             { return _mm_add_ps(a, b); }
+static inline ImFloat4 ImFloat4_Sub(ImFloat4 a, ImFloat4 b)             { return _mm_sub_ps(a, b); }
+static inline ImFloat4 ImFloat4_Mul(ImFloat4 a, ImFloat4 b)             { return _mm_mul_ps(a, b); }
+static inline ImFloat4 ImFloat4_Div(ImFloat4 a, ImFloat4 b)             { return _mm_div_ps(a, b); }
+static inline ImFloat4 ImFloat4_Sqrt(ImFloat4 a)                        { return _mm_sqrt_ps(a); }
+static inline ImFloat4 ImFloat4_Neg(ImFloat4 a)                         { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+static inline ImMask4  ImFloat4_Greater(ImFloat4 a, ImFloat4 b)         { return _mm_cmpgt_ps(a, b); }
+static inline ImMask4  ImFloat4_Less(ImFloat4 a, ImFloat4 b)            { return _mm_cmplt_ps(a, b); }
+static inline ImFloat4 ImFloat4_Select(ImMask4 m, ImFloat4 a, ImFloat4 b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+
+// Loads 4 consecutive ImVec2 as xxxx/yyyy, and the other way around
+static inline void ImFloat4_LoadVec2(const ImVec2* p, ImFloat4* xs, ImFloat4* ys)
+{
+    const __m128 a = _mm_loadu_ps(&p[0].x);
+    const __m128 b = _mm_loadu_ps(&p[2].x);
+    *xs = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    *ys = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+}
+static inline void ImFloat4_StoreVec2(ImVec2* p, ImFloat4 xs, ImFloat4 ys)
+{
+    _mm_storeu_ps(&p[0].x, _mm_unpacklo_ps(xs, ys));
+    _mm_storeu_ps(&p[2].x, _mm_unpackhi_ps(xs, ys));
+}
+#else
+typedef float32x4_t ImFloat4;
+typedef uint32x4_t ImMask4;
+static inline ImFloat4 ImFloat4_Splat(float v)                          { return vdupq_n_f32(v); }
+static inline ImFloat4 ImFloat4_Ramp(float v)                           { static const float ramp[4] = { 0.0f, 1.0f, 2.0f, 3.0f }; return vaddq_f32(vdupq_n_f32(v), vld1q_f32(ramp)); }
+static inline ImFloat4 ImFloat4_Add(ImFloat4 a, ImFloat4 b)             { return vaddq_f32(a, b); }
+static inline ImFloat4 ImFloat4_Sub(ImFloat4 a, ImFloat4 b)             { return vsubq_f32(a, b); }
+static inline ImFloat4 ImFloat4_Mul(ImFloat4 a, ImFloat4 b)             { return vmulq_f32(a, b); }
+static inline ImFloat4 ImFloat4_Div(ImFloat4 a, ImFloat4 b)             { return vdivq_f32(a, b); }
+static inline ImFloat4 ImFloat4_Sqrt(ImFloat4 a)                        { return vsqrtq_f32(a); }
+static inline ImFloat4 ImFloat4_Neg(ImFloat4 a)                         { return vnegq_f32(a); }
+static inline ImMask4  ImFloat4_Greater(ImFloat4 a, ImFloat4 b)         { return vcgtq_f32(a, b); }
+static inline ImMask4  ImFloat4_Less(ImFloat4 a, ImFloat4 b)            { return vcltq_f32(a, b); }
+static inline ImFloat4 ImFloat4_Select(ImMask4 m, ImFloat4 a, ImFloat4 b) { return vbslq_f32(m, a, b); }
+
+static inline void ImFloat4_LoadVec2(const ImVec2* p, ImFloat4* xs, ImFloat4* ys)
+{
+    const float32x4x2_t v = vld2q_f32(&p[0].x);
+    *xs = v.val[0];
+    *ys = v.val[1];
+}
+static inline void ImFloat4_StoreVec2(ImVec2* p, ImFloat4 xs, ImFloat4 ys)
+{
+    float32x4x2_t v;
+    v.val[0] = xs;
+    v.val[1] = ys;
+    vst2q_f32(&p[0].x, v);
+}
+#endif
+
+// sin(r) and cos(r) for r in [-pi/4, pi/4]
+static inline ImFloat4 ImFloat4_SinCosPoly(ImFloat4 r, ImFloat4* out_cos_r)
+{
+    const ImFloat4 z = ImFloat4_Mul(r, r);
+    ImFloat4 s = ImFloat4_Add(ImFloat4_Mul(ImFloat4_Splat(-1.9515295891e-4f), z), ImFloat4_Splat(8.3321608736e-3f));
+    s = ImFloat4_Add(ImFloat4_Mul(s, z), ImFloat4_Splat(-1.6666654611e-1f));
+    s = ImFloat4_Add(ImFloat4_Mul(ImFloat4_Mul(s, z), r), r);
+    ImFloat4 c = ImFloat4_Add(ImFloat4_Mul(ImFloat4_Splat(2.443315711809948e-5f), z), ImFloat4_Splat(-1.388731625493765e-3f));
+    c = ImFloat4_Add(ImFloat4_Mul(c, z), ImFloat4_Splat(4.166664568298827e-2f));
+    c = ImFloat4_Add(ImFloat4_Sub(ImFloat4_Mul(ImFloat4_Mul(c, z), z), ImFloat4_Mul(ImFloat4_Splat(0.5f), z)), ImFloat4_Splat(1.0f));
+    *out_cos_r = c;
+    return s;
+}
+
+#if defined(IMGUI_ENABLE_SSE)
+// Reduces a into r in [-pi/4, pi/4] with a = r + q * pi/2 (the constants split pi/2 so that q * constant is exact), then picks and flips sin(r)/cos(r) by quadrant
+static inline void ImFloat4_SinCos(ImFloat4 a, ImFloat4* out_sin, ImFloat4* out_cos)
+{
+    const __m128i q = _mm_cvtps_epi32(_mm_mul_ps(a, _mm_set1_ps(0.636619772f)));
+    const __m128 qf = _mm_cvtepi32_ps(q);
+    __m128 r = _mm_sub_ps(a, _mm_mul_ps(qf, _mm_set1_ps(1.5703125f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(4.837512969970703125e-4f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(7.54978995489188216e-8f)));
+    __m128 cos_r;
+    const __m128 sin_r = ImFloat4_SinCosPoly(r, &cos_r);
+    const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+    const __m128 sin_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, _mm_set1_epi32(2)), 30));
+    const __m128 cos_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+    *out_sin = _mm_xor_ps(ImFloat4_Select(swap, cos_r, sin_r), sin_sign);
+    *out_cos = _mm_xor_ps(ImFloat4_Select(swap, sin_r, cos_r), cos_sign);
+}
+#else
+static inline void ImFloat4_SinCos(ImFloat4 a, ImFloat4* out_sin, ImFloat4* out_cos)
+{
+    const int32x4_t q = vcvtnq_s32_f32(vmulq_f32(a, vdupq_n_f32(0.636619772f)));
+    const float32x4_t qf = vcvtq_f32_s32(q);
+    float32x4_t r = vsubq_f32(a, vmulq_f32(qf, vdupq_n_f32(1.5703125f)));
+    r = vsubq_f32(r, vmulq_f32(qf, vdupq_n_f32(4.837512969970703125e-4f)));
+    r = vsubq_f32(r, vmulq_f32(qf, vdupq_n_f32(7.54978995489188216e-8f)));
+    float32x4_t cos_r;
+    const float32x4_t sin_r = ImFloat4_SinCosPoly(r, &cos_r);
+    const uint32x4_t swap = vceqq_s32(vandq_s32(q, vdupq_n_s32(1)), vdupq_n_s32(1));
+    const uint32x4_t sin_sign = vreinterpretq_u32_s32(vshlq_n_s32(vandq_s32(q, vdupq_n_s32(2)), 30));
+    const uint32x4_t cos_sign = vreinterpretq_u32_s32(vshlq_n_s32(vandq_s32(vaddq_s32(q, vdupq_n_s32(1)), vdupq_n_s32(2)), 30));
+    *out_sin = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, cos_r, sin_r)), sin_sign));
+    *out_cos = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, sin_r, cos_r)), cos_sign));
+}
+#endif
+#endif // #if defined(IMGUI_ENABLE_SSE) || defined(IMGUI_ENABLE_NEON)
+
+void ImTessellateSegmentNormals(const ImVec2* points, int points_count, int count, ImVec2* out_normals)
+{
+    int i1 = 0;
+#if defined(IMGUI_ENABLE_SSE) || defined(IMGUI_ENABLE_NEON)
+    // The segment closing the line reads points[0] again, so it is left to the scalar loop
+    const ImFloat4 zero = ImFloat4_Splat(0.0f);
+    const ImFloat4 one = ImFloat4_Splat(1.0f);
+    for (; i1 + 4 <= count && i1 + 4 < points_count; i1 += 4)
+    {
+        ImFloat4 x1, y1, x2, y2;
+        ImFloat4_LoadVec2(points + i1, &x1, &y1);
+        ImFloat4_LoadVec2(points + i1 + 1, &x2, &y2);
+        const ImFloat4 dx = ImFloat4_Sub(x2, x1);
+        const ImFloat4 dy = ImFloat4_Sub(y2, y1);
+        const ImFloat4 d2 = ImFloat4_Add(ImFloat4_Mul(dx, dx), ImFloat4_Mul(dy, dy));
+        const ImFloat4 inv_len = ImFloat4_Select(ImFloat4_Greater(d2, zero), ImFloat4_Div(one, ImFloat4_Sqrt(d2)), one); // IM_NORMALIZE2F_OVER_ZERO()
+        ImFloat4_StoreVec2(out_normals + i1, ImFloat4_Mul(dy, inv_len), ImFloat4_Neg(ImFloat4_Mul(dx, inv_len)));
+    }
+#endif
+    for (; i1 < count; i1++)
+    {
+        const int i2 = (i1 + 1) == points_count ? 0 : i1 + 1;
+        float dx = points[i2].x - points[i1].x;
+        float dy = points[i2].y - points[i1].y;
+        IM_NORMALIZE2F_OVER_ZERO(dx, dy);
+        out_normals[i1].x = dy;
+        out_normals[i1].y = -dx;
+    }
+}
+
+void ImTessellateMiterNormals(const ImVec2* normals, int points_count, int count, ImVec2* out_miters)
+{
+    int i1 = 0;
+#if defined(IMGUI_ENABLE_SSE) || defined(IMGUI_ENABLE_NEON)
+    const ImFloat4 half = ImFloat4_Splat(0.5f);
+    const ImFloat4 one = ImFloat4_Splat(1.0f);
+    for (; i1 + 4 <= count && i1 + 4 < points_count; i1 += 4)
+    {
+        ImFloat4 x1, y1, x2, y2;
+        ImFloat4_LoadVec2(normals + i1, &x1, &y1);
+        ImFloat4_LoadVec2(normals + i1 + 1, &x2, &y2);
+        const ImFloat4 dm_x = ImFloat4_Mul(ImFloat4_Add(x1, x2), half);
+        const ImFloat4 dm_y = ImFloat4_Mul(ImFloat4_Add(y1, y2), half);
+        ImFloat4 d2 = ImFloat4_Add(ImFloat4_Mul(dm_x, dm_x), ImFloat4_Mul(dm_y, dm_y));
+        d2 = ImFloat4_Select(ImFloat4_Less(d2, half), half, d2); // IM_FIXNORMAL2F()
+        const ImFloat4 inv_lensq = ImFloat4_Div(one, d2);
+        ImFloat4_StoreVec2(out_miters + i1 + 1, ImFloat4_Mul(dm_x, inv_lensq), ImFloat4_Mul(dm_y, inv_lensq));
+    }
+#endif
+    for (; i1 < count; i1++)
+    {
+        const int i2 = (i1 + 1) == points_count ? 0 : i1 + 1;
+        float dm_x = (normals[i1].x + normals[i2].x) * 0.5f;
+        float dm_y = (normals[i1].y + normals[i2].y) * 0.5f;
+        IM_FIXNORMAL2F(dm_x, dm_y);
+        out_miters[i2].x = dm_x;
+        out_miters[i2].y = dm_y;
+    }
+}
+
+void ImTessellateArcPoints(ImVec2* out_points, const ImVec2& center, float radius, float a_min, float a_max, int num_segments)
+{
+    int i = 0;
+#if defined(IMGUI_ENABLE_SSE) || defined(IMGUI_ENABLE_NEON)
+    const ImFloat4 segments = ImFloat4_Splat((float)num_segments);
+    for (; i + 4 <= num_segments + 1; i += 4)
+    {
+        const ImFloat4 a = ImFloat4_Add(ImFloat4_Splat(a_min), ImFloat4_Mul(ImFloat4_Div(ImFloat4_Ramp((float)i), segments), ImFloat4_Splat(a_max - a_min)));
+        ImFloat4 sin_a, cos_a;
+        ImFloat4_SinCos(a, &sin_a, &cos_a);
+        ImFloat4_StoreVec2(out_points + i, ImFloat4_Add(ImFloat4_Splat(center.x), ImFloat4_Mul(cos_a, ImFloat4_Splat(radius))), ImFloat4_Add(ImFloat4_Splat(center.y), ImFloat4_Mul(sin_a, ImFloat4_Splat(radius))));
+    }
+#endif
+    for (; i <= num_segments; i++)
+    {
+        const float a = a_min + ((float)i / (float)num_segments) * (a_max - a_min);
+        out_points[i] = ImVec2(center.x + ImCos(a) * radius, center.y + ImSin(a) * radius);
+    }
+}
+
+void ImTessellateBezierCubicPoints(ImVec2* out_points, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const ImVec2& p4, int num_segments)
+{
+    const float t_step = 1.0f / (float)num_segments;
+    int i_step = 1;
+#if defined(IMGUI_ENABLE_SSE) || defined(IMGUI_ENABLE_NEON)
+    // Same operations as ImBezierCubicCalc()
+    const ImFloat4 one = ImFloat4_Splat(1.0f);
+    const ImFloat4 three = ImFloat4_Splat(3.0f);
+    for (; i_step + 3 <= num_segments; i_step += 4)
+    {
+        const ImFloat4 t = ImFloat4_Mul(ImFloat4_Splat(t_step), ImFloat4_Ramp((float)i_step));
+        const ImFloat4 u = ImFloat4_Sub(one, t);
+        const ImFloat4 w1 = ImFloat4_Mul(ImFloat4_Mul(u, u), u);
+        const ImFloat4 w2 = ImFloat4_Mul(ImFloat4_Mul(ImFloat4_Mul(three, u), u), t);
+        const ImFloat4 w3 = ImFloat4_Mul(ImFloat4_Mul(ImFloat4_Mul(three, u), t), t);
+        const ImFloat4 w4 = ImFloat4_Mul(ImFloat4_Mul(t, t), t);
+        const ImFloat4 x = ImFloat4_Add(ImFloat4_Add(ImFloat4_Add(ImFloat4_Mul(w1, ImFloat4_Splat(p1.x)), ImFloat4_Mul(w2, ImFloat4_Splat(p2.x))), ImFloat4_Mul(w3, ImFloat4_Splat(p3.x))), ImFloat4_Mul(w4, ImFloat4_Splat(p4.x)));
+        const ImFloat4 y = ImFloat4_Add(ImFloat4_Add(ImFloat4_Add(ImFloat4_Mul(w1, ImFloat4_Splat(p1.y)), ImFloat4_Mul(w2, ImFloat4_Splat(p2.y))), ImFloat4_Mul(w3, ImFloat4_Splat(p3.y))), ImFloat4_Mul(w4, ImFloat4_Splat(p4.y)));
+        ImFloat4_StoreVec2(out_points + i_step - 1, x, y);
+    }
+#endif
+    for (; i_step <= num_segments; i_step++)
+        out_points[i_step - 1] = ImBezierCubicCalc(p1, p2, p3, p4, t_step * i_step);
+}
+
+// AddPolyline() and AddConvexPolyFilled() are split in two halves: the indices only depend on the number of points and on the drawing mode,
+// so they are always written right away, while the vertices are written by the functions below. With ImDrawListFlags_DeferTessellation,
+// those run later from _TessellateDeferred(), into the vertices that were reserved by the call.
+static bool ImDrawList_PolylineUsesTexture(const ImDrawListSharedData* data, ImDrawListFlags list_flags, float thickness, float fringe_scale)
+{
+    // Do we want to draw this line using a texture?
+    // - For now, only draw integer-width lines using textures to avoid issues with the way scaling occurs, could be improved.
+    // - If AA_SIZE is not 1.0f we cannot use the texture path.
+    const int integer_thickness = (int)thickness;
+    const float fractional_thickness = thickness - integer_thickness;
+    const bool use_texture = (list_flags & ImDrawListFlags_AntiAliasedLinesUseTex) && (integer_thickness < IM_DRAWLIST_TEX_LINES_WIDTH_MAX) && (fractional_thickness <= 0.00001f) && (fringe_scale == 1.0f);
+
+    // We should never hit this, because NewFrame() doesn't set ImDrawListFlags_AntiAliasedLinesUseTex unless ImFontAtlasFlags_NoBakedLines is off
+    IM_ASSERT_PARANOID(!use_texture || !(data->Font->ContainerAtlas->Flags & ImFontAtlasFlags_NoBakedLines));
+    IM_UNUSED(data);
+    return use_texture;
+}
+
 // TODO: Thickness anti-aliased lines cap are missing their AA fringe.
 // We avoid using the ImVec2 math operators here to reduce cost to a minimum for debug/non-inlined builds.
-void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32 col, ImDrawFlags flags, float thickness)
+static void ImDrawList_PolylineVertices(const ImDrawListSharedData* data, ImDrawVert* vtx_write, const ImVec2* points, const int points_count, ImU32 col, ImDrawFlags flags, float thickness, ImDrawListFlags list_flags, float fringe_scale)
 {
-    if (points_count < 2)
-        return;
-
     const bool closed = (flags & ImDrawFlags_Closed) != 0;
-    const ImVec2 opaque_uv = _Data->TexUvWhitePixel;
+    const ImVec2 opaque_uv = data->TexUvWhitePixel;
     const int count = closed ? points_count : points_count - 1; // The number of line segments we need to draw
-    const bool thick_line = (thickness > _FringeScale);
+    const bool thick_line = (thickness > fringe_scale);
 
-    if (Flags & ImDrawListFlags_AntiAliasedLines)
+    if (list_flags & ImDrawListFlags_AntiAliasedLines)
     {
         // Anti-aliased stroke
-        const float AA_SIZE = _FringeScale;
+        const float AA_SIZE = fringe_scale;
         const ImU32 col_trans = col & ~IM_COL32_A_MASK;
 
         // Thicknesses <1.0 should behave like thickness 1.0
         thickness = ImMax(thickness, 1.0f);
         const int integer_thickness = (int)thickness;
-        const float fractional_thickness = thickness - integer_thickness;
-
-        // Do we want to draw this line using a texture?
-        // - For now, only draw integer-width lines using textures to avoid issues with the way scaling occurs, could be improved.
-        // - If AA_SIZE is not 1.0f we cannot use the texture path.
-        const bool use_texture = (Flags & ImDrawListFlags_AntiAliasedLinesUseTex) && (integer_thickness < IM_DRAWLIST_TEX_LINES_WIDTH_MAX) && (fractional_thickness <= 0.00001f) && (AA_SIZE == 1.0f);
-
-        // We should never hit this, because NewFrame() doesn't set ImDrawListFlags_AntiAliasedLinesUseTex unless ImFontAtlasFlags_NoBakedLines is off
-        IM_ASSERT_PARANOID(!use_texture || !(_Data->Font->ContainerAtlas->Flags & ImFontAtlasFlags_NoBakedLines));
-
-        const int idx_count = use_texture ? (count * 6) : (thick_line ? count * 18 : count * 12);
-        const int vtx_count = use_texture ? (points_count * 2) : (thick_line ? points_count * 4 : points_count * 3);
-        PrimReserve(idx_count, vtx_count);
+        const bool use_texture = ImDrawList_PolylineUsesTexture(data, list_flags, thickness, fringe_scale);
 
         // Temporary buffer
-        // The first <points_count> items are normals at each line point, then after that there are either 2 or 4 temp points for each line point
-        ImVec2* temp_normals = (ImVec2*)alloca(points_count * ((use_texture || !thick_line) ? 3 : 5) * sizeof(ImVec2)); //-V630
-        ImVec2* temp_points = temp_normals + points_count;
+        // The first <points_count> items are normals at each line point, then the averaged normals at each line point, then after that there are either 2 or 4 temp points for each line point
+        ImVec2* temp_normals = (ImVec2*)alloca(points_count * ((use_texture || !thick_line) ? 4 : 6) * sizeof(ImVec2)); //-V630
+        ImVec2* temp_miters = temp_normals + points_count;
+        ImVec2* temp_points = temp_miters + points_count;
 
         // Calculate normals (tangents) for each line segment
-        for (int i1 = 0; i1 < count; i1++)
-        {
-            const int i2 = (i1 + 1) == points_count ? 0 : i1 + 1;
-            float dx = points[i2].x - points[i1].x;
-            float dy = points[i2].y - points[i1].y;
-            IM_NORMALIZE2F_OVER_ZERO(dx, dy);
-            temp_normals[i1].x = dy;
-            temp_normals[i1].y = -dx;
-        }
+        ImTessellateSegmentNormals(points, points_count, count, temp_normals);
         if (!closed)
             temp_normals[points_count - 1] = temp_normals[points_count - 2];
 
+        // Average normals at each point (written at the second point of each segment)
+        ImTessellateMiterNormals(temp_normals, points_count, count, temp_miters);
+
         // If we are drawing a one-pixel-wide line without a texture, or a textured line of any width, we only need 2 or 3 vertices per point
         if (use_texture || !thick_line)
         {
@@ -766,21 +987,14 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
                 temp_points[(points_count-1)*2+1] = points[points_count-1] - temp_normals[points_count-1] * half_draw_size;
             }
 
-            // Generate the indices to form a number of triangles for each line segment, and the vertices for the line edges
+            // Generate the vertices for the line edges
             // This takes points n and n+1 and writes into n+1, with the first point in a closed line being generated from the final one (as n+1 wraps)
             // FIXME-OPT: Merge the different loops, possibly remove the temporary buffer.
-            unsigned int idx1 = _VtxCurrentIdx; // Vertex index for start of line segment
             for (int i1 = 0; i1 < count; i1++) // i1 is the first point of the line segment
             {
                 const int i2 = (i1 + 1) == points_count ? 0 : i1 + 1; // i2 is the second point of the line segment
-                const unsigned int idx2 = ((i1 + 1) == points_count) ? _VtxCurrentIdx : (idx1 + (use_texture ? 2 : 3)); // Vertex index for end of segment
-
-                // Average normals
-                float dm_x = (temp_normals[i1].x + temp_normals[i2].x) * 0.5f;
-                float dm_y = (temp_normals[i1].y + temp_normals[i2].y) * 0.5f;
-                IM_FIXNORMAL2F(dm_x, dm_y);
-                dm_x *= half_draw_size; // dm_x, dm_y are offset to the outer edge of the AA area
-                dm_y *= half_draw_size;
+                const float dm_x = temp_miters[i2].x * half_draw_size; // dm_x, dm_y are offset to the outer edge of the AA area
+                const float dm_y = temp_miters[i2].y * half_draw_size;
 
                 // Add temporary vertexes for the outer edges
                 ImVec2* out_vtx = &temp_points[i2 * 2];
@@ -788,35 +1002,16 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
                 out_vtx[0].y = points[i2].y + dm_y;
                 out_vtx[1].x = points[i2].x - dm_x;
                 out_vtx[1].y = points[i2].y - dm_y;
-
-                if (use_texture)
-                {
-                    // Add indices for two triangles
-                    _IdxWritePtr[0] = (ImDrawIdx)(idx2 + 0); _IdxWritePtr[1] = (ImDrawIdx)(idx1 + 0); _IdxWritePtr[2] = (ImDrawIdx)(idx1 + 1); // Right tri
-                    _IdxWritePtr[3] = (ImDrawIdx)(idx2 + 1); _IdxWritePtr[4] = (ImDrawIdx)(idx1 + 1); _IdxWritePtr[5] = (ImDrawIdx)(idx2 + 0); // Left tri
-                    _IdxWritePtr += 6;
-                }
-                else
-                {
-                    // Add indexes for four triangles
-                    _IdxWritePtr[0] = (ImDrawIdx)(idx2 + 0); _IdxWritePtr[1] = (ImDrawIdx)(idx1 + 0); _IdxWritePtr[2] = (ImDrawIdx)(idx1 + 2); // Right tri 1
-                    _IdxWritePtr[3] = (ImDrawIdx)(idx1 + 2); _IdxWritePtr[4] = (ImDrawIdx)(idx2 + 2); _IdxWritePtr[5] = (ImDrawIdx)(idx2 + 0); // Right tri 2
-                    _IdxWritePtr[6] = (ImDrawIdx)(idx2 + 1); _IdxWritePtr[7] = (ImDrawIdx)(idx1 + 1); _IdxWritePtr[8] = (ImDrawIdx)(idx1 + 0); // Left tri 1
-                    _IdxWritePtr[9] = (ImDrawIdx)(idx1 + 0); _IdxWritePtr[10] = (ImDrawIdx)(idx2 + 0); _IdxWritePtr[11] = (ImDrawIdx)(idx2 + 1); // Left tri 2
-                    _IdxWritePtr += 12;
-                }
-
-                idx1 = idx2;
             }
 
             // Add vertexes for each point on the line
             if (use_texture)
             {
                 // If we're using textures we only need to emit the left/right edge vertices
-                ImVec4 tex_uvs = _Data->TexUvLines[integer_thickness];
+                ImVec4 tex_uvs = data->TexUvLines[integer_thickness];
                 /*if (fractional_thickness != 0.0f) // Currently always zero when use_texture==false!
                 {
-                    const ImVec4 tex_uvs_1 = _Data->TexUvLines[integer_thickness + 1];
+                    const ImVec4 tex_uvs_1 = data->TexUvLines[integer_thickness + 1];
                     tex_uvs.x = tex_uvs.x + (tex_uvs_1.x - tex_uvs.x) * fractional_thickness; // inlined ImLerp()
                     tex_uvs.y = tex_uvs.y + (tex_uvs_1.y - tex_uvs.y) * fractional_thickness;
                     tex_uvs.z = tex_uvs.z + (tex_uvs_1.z - tex_uvs.z) * fractional_thickness;
@@ -826,9 +1021,9 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
                 ImVec2 tex_uv1(tex_uvs.z, tex_uvs.w);
                 for (int i = 0; i < points_count; i++)
                 {
-                    _VtxWritePtr[0].pos = temp_points[i * 2 + 0]; _VtxWritePtr[0].uv = tex_uv0; _VtxWritePtr[0].col = col; // Left-side outer edge
-                    _VtxWritePtr[1].pos = temp_points[i * 2 + 1]; _VtxWritePtr[1].uv = tex_uv1; _VtxWritePtr[1].col = col; // Right-side outer edge
-                    _VtxWritePtr += 2;
+                    vtx_write[0].pos = temp_points[i * 2 + 0]; vtx_write[0].uv = tex_uv0; vtx_write[0].col = col; // Left-side outer edge
+                    vtx_write[1].pos = temp_points[i * 2 + 1]; vtx_write[1].uv = tex_uv1; vtx_write[1].col = col; // Right-side outer edge
+                    vtx_write += 2;
                 }
             }
             else
@@ -836,10 +1031,10 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
                 // If we're not using a texture, we need the center vertex as well
                 for (int i = 0; i < points_count; i++)
                 {
-                    _VtxWritePtr[0].pos = points[i];              _VtxWritePtr[0].uv = opaque_uv; _VtxWritePtr[0].col = col;       // Center of line
-                    _VtxWritePtr[1].pos = temp_points[i * 2 + 0]; _VtxWritePtr[1].uv = opaque_uv; _VtxWritePtr[1].col = col_trans; // Left-side outer edge
-                    _VtxWritePtr[2].pos = temp_points[i * 2 + 1]; _VtxWritePtr[2].uv = opaque_uv; _VtxWritePtr[2].col = col_trans; // Right-side outer edge
-                    _VtxWritePtr += 3;
+                    vtx_write[0].pos = points[i];              vtx_write[0].uv = opaque_uv; vtx_write[0].col = col;       // Center of line
+                    vtx_write[1].pos = temp_points[i * 2 + 0]; vtx_write[1].uv = opaque_uv; vtx_write[1].col = col_trans; // Left-side outer edge
+                    vtx_write[2].pos = temp_points[i * 2 + 1]; vtx_write[2].uv = opaque_uv; vtx_write[2].col = col_trans; // Right-side outer edge
+                    vtx_write += 3;
                 }
             }
         }
@@ -862,19 +1057,14 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
                 temp_points[points_last * 4 + 3] = points[points_last] - temp_normals[points_last] * (half_inner_thickness + AA_SIZE);
             }
 
-            // Generate the indices to form a number of triangles for each line segment, and the vertices for the line edges
+            // Generate the vertices for the line edges
             // This takes points n and n+1 and writes into n+1, with the first point in a closed line being generated from the final one (as n+1 wraps)
             // FIXME-OPT: Merge the different loops, possibly remove the temporary buffer.
-            unsigned int idx1 = _VtxCurrentIdx; // Vertex index for start of line segment
             for (int i1 = 0; i1 < count; i1++) // i1 is the first point of the line segment
             {
                 const int i2 = (i1 + 1) == points_count ? 0 : (i1 + 1); // i2 is the second point of the line segment
-                const unsigned int idx2 = (i1 + 1) == points_count ? _VtxCurrentIdx : (idx1 + 4); // Vertex index for end of segment
-
-                // Average normals
-                float dm_x = (temp_normals[i1].x + temp_normals[i2].x) * 0.5f;
-                float dm_y = (temp_normals[i1].y + temp_normals[i2].y) * 0.5f;
-                IM_FIXNORMAL2F(dm_x, dm_y);
+                const float dm_x = temp_miters[i2].x;
+                const float dm_y = temp_miters[i2].y;
                 float dm_out_x = dm_x * (half_inner_thickness + AA_SIZE);
                 float dm_out_y = dm_y * (half_inner_thickness + AA_SIZE);
                 float dm_in_x = dm_x * half_inner_thickness;
@@ -890,8 +1080,149 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
                 out_vtx[2].y = points[i2].y - dm_in_y;
                 out_vtx[3].x = points[i2].x - dm_out_x;
                 out_vtx[3].y = points[i2].y - dm_out_y;
+            }
 
-                // Add indexes
+            // Add vertices
+            for (int i = 0; i < points_count; i++)
+            {
+                vtx_write[0].pos = temp_points[i * 4 + 0]; vtx_write[0].uv = opaque_uv; vtx_write[0].col = col_trans;
+                vtx_write[1].pos = temp_points[i * 4 + 1]; vtx_write[1].uv = opaque_uv; vtx_write[1].col = col;
+                vtx_write[2].pos = temp_points[i * 4 + 2]; vtx_write[2].uv = opaque_uv; vtx_write[2].col = col;
+                vtx_write[3].pos = temp_points[i * 4 + 3]; vtx_write[3].uv = opaque_uv; vtx_write[3].col = col_trans;
+                vtx_write += 4;
+            }
+        }
+    }
+    else
+    {
+        // [PATH 4] Non texture-based, Non anti-aliased lines
+        ImVec2* temp_normals = (ImVec2*)alloca(points_count * sizeof(ImVec2)); //-V630
+        ImTessellateSegmentNormals(points, points_count, count, temp_normals);
+        for (int i1 = 0; i1 < count; i1++)
+        {
+            const int i2 = (i1 + 1) == points_count ? 0 : i1 + 1;
+            const ImVec2& p1 = points[i1];
+            const ImVec2& p2 = points[i2];
+
+            // The normal is (dy, -dx) of the normalized segment direction
+            const float nx = temp_normals[i1].x * (thickness * 0.5f);
+            const float ny = temp_normals[i1].y * (thickness * 0.5f);
+
+            vtx_write[0].pos.x = p1.x + nx; vtx_write[0].pos.y = p1.y + ny; vtx_write[0].uv = opaque_uv; vtx_write[0].col = col;
+            vtx_write[1].pos.x = p2.x + nx; vtx_write[1].pos.y = p2.y + ny; vtx_write[1].uv = opaque_uv; vtx_write[1].col = col;
+            vtx_write[2].pos.x = p2.x - nx; vtx_write[2].pos.y = p2.y - ny; vtx_write[2].uv = opaque_uv; vtx_write[2].col = col;
+            vtx_write[3].pos.x = p1.x - nx; vtx_write[3].pos.y = p1.y - ny; vtx_write[3].uv = opaque_uv; vtx_write[3].col = col;
+            vtx_write += 4;
+        }
+    }
+}
+
+// We intentionally avoid using ImVec2 and its math operators here to reduce cost to a minimum for debug/non-inlined builds.
+static void ImDrawList_ConvexPolyFilledVertices(const ImDrawListSharedData* data, ImDrawVert* vtx_write, const ImVec2* points, const int points_count, ImU32 col, ImDrawListFlags list_flags, float fringe_scale)
+{
+    const ImVec2 uv = data->TexUvWhitePixel;
+
+    if (list_flags & ImDrawListFlags_AntiAliasedFill)
+    {
+        // Anti-aliased Fill
+        const float AA_SIZE = fringe_scale;
+        const ImU32 col_trans = col & ~IM_COL32_A_MASK;
+
+        // Compute normals, then average them at each point
+        ImVec2* temp_normals = (ImVec2*)alloca(points_count * 2 * sizeof(ImVec2)); //-V630
+        ImVec2* temp_miters = temp_normals + points_count;
+        ImTessellateSegmentNormals(points, points_count, points_count, temp_normals);
+        ImTessellateMiterNormals(temp_normals, points_count, points_count, temp_miters);
+
+        for (int i1 = 0; i1 < points_count; i1++)
+        {
+            const float dm_x = temp_miters[i1].x * (AA_SIZE * 0.5f);
+            const float dm_y = temp_miters[i1].y * (AA_SIZE * 0.5f);
+
+            // Add vertices
+            vtx_write[0].pos.x = (points[i1].x - dm_x); vtx_write[0].pos.y = (points[i1].y - dm_y); vtx_write[0].uv = uv; vtx_write[0].col = col;        // Inner
+            vtx_write[1].pos.x = (points[i1].x + dm_x); vtx_write[1].pos.y = (points[i1].y + dm_y); vtx_write[1].uv = uv; vtx_write[1].col = col_trans;  // Outer
+            vtx_write += 2;
+        }
+    }
+    else
+    {
+        // Non Anti-aliased Fill
+        for (int i = 0; i < points_count; i++)
+        {
+            vtx_write[0].pos = points[i]; vtx_write[0].uv = uv; vtx_write[0].col = col;
+            vtx_write++;
+        }
+    }
+}
+
+// Keep the call for _TessellateDeferred(): the vertices are only reserved, and the points are copied since they usually live in _Path.
+static void ImDrawList_DeferPrim(ImDrawList* draw_list, const ImVec2* points, int points_count, ImU32 col, ImDrawFlags flags, float thickness, bool filled)
+{
+    ImDrawDeferredPrim prim;
+    prim.VtxOffset = (int)(draw_list->_VtxWritePtr - draw_list->VtxBuffer.Data);
+    prim.PointsOffset = draw_list->_DeferredPoints.Size;
+    prim.PointsCount = points_count;
+    prim.Col = col;
+    prim.Thickness = thickness;
+    prim.Flags = flags;
+    prim.ListFlags = draw_list->Flags;
+    prim.FringeScale = draw_list->_FringeScale;
+    prim.Filled = filled;
+    draw_list->_DeferredPrims.push_back(prim);
+    draw_list->_DeferredPoints.resize(draw_list->_DeferredPoints.Size + points_count);
+    memcpy(draw_list->_DeferredPoints.Data + prim.PointsOffset, points, (size_t)points_count * sizeof(ImVec2));
+}
+
+void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32 col, ImDrawFlags flags, float thickness)
+{
+    if (points_count < 2)
+        return;
+
+    const bool closed = (flags & ImDrawFlags_Closed) != 0;
+    const int count = closed ? points_count : points_count - 1; // The number of line segments we need to draw
+    const bool thick_line = (thickness > _FringeScale);
+    int vtx_count;
+
+    if (Flags & ImDrawListFlags_AntiAliasedLines)
+    {
+        // Anti-aliased stroke, thicknesses <1.0 should behave like thickness 1.0
+        const bool use_texture = ImDrawList_PolylineUsesTexture(_Data, Flags, ImMax(thickness, 1.0f), _FringeScale);
+        const int idx_count = use_texture ? (count * 6) : (thick_line ? count * 18 : count * 12);
+        vtx_count = use_texture ? (points_count * 2) : (thick_line ? points_count * 4 : points_count * 3);
+        PrimReserve(idx_count, vtx_count);
+
+        // Generate the indices to form a number of triangles for each line segment
+        unsigned int idx1 = _VtxCurrentIdx; // Vertex index for start of line segment
+        for (int i1 = 0; i1 < count; i1++) // i1 is the first point of the line segment
+        {
+            if (use_texture || !thick_line)
+            {
+                // [PATH 1] Texture-based lines (thick or non-thick)
+                // [PATH 2] Non texture-based lines (non-thick)
+                const unsigned int idx2 = ((i1 + 1) == points_count) ? _VtxCurrentIdx : (idx1 + (use_texture ? 2 : 3)); // Vertex index for end of segment
+                if (use_texture)
+                {
+                    // Add indices for two triangles
+                    _IdxWritePtr[0] = (ImDrawIdx)(idx2 + 0); _IdxWritePtr[1] = (ImDrawIdx)(idx1 + 0); _IdxWritePtr[2] = (ImDrawIdx)(idx1 + 1); // Right tri
+                    _IdxWritePtr[3] = (ImDrawIdx)(idx2 + 1); _IdxWritePtr[4] = (ImDrawIdx)(idx1 + 1); _IdxWritePtr[5] = (ImDrawIdx)(idx2 + 0); // Left tri
+                    _IdxWritePtr += 6;
+                }
+                else
+                {
+                    // Add indexes for four triangles
+                    _IdxWritePtr[0] = (ImDrawIdx)(idx2 + 0); _IdxWritePtr[1] = (ImDrawIdx)(idx1 + 0); _IdxWritePtr[2] = (ImDrawIdx)(idx1 + 2); // Right tri 1
+                    _IdxWritePtr[3] = (ImDrawIdx)(idx1 + 2); _IdxWritePtr[4] = (ImDrawIdx)(idx2 + 2); _IdxWritePtr[5] = (ImDrawIdx)(idx2 + 0); // Right tri 2
+                    _IdxWritePtr[6] = (ImDrawIdx)(idx2 + 1); _IdxWritePtr[7] = (ImDrawIdx)(idx1 + 1); _IdxWritePtr[8] = (ImDrawIdx)(idx1 + 0); // Left tri 1
+                    _IdxWritePtr[9] = (ImDrawIdx)(idx1 + 0); _IdxWritePtr[10] = (ImDrawIdx)(idx2 + 0); _IdxWritePtr[11] = (ImDrawIdx)(idx2 + 1); // Left tri 2
+                    _IdxWritePtr += 12;
+                }
+                idx1 = idx2;
+            }
+            else
+            {
+                // [PATH 2] Non texture-based lines (thick)
+                const unsigned int idx2 = (i1 + 1) == points_count ? _VtxCurrentIdx : (idx1 + 4); // Vertex index for end of segment
                 _IdxWritePtr[0]  = (ImDrawIdx)(idx2 + 1); _IdxWritePtr[1]  = (ImDrawIdx)(idx1 + 1); _IdxWritePtr[2]  = (ImDrawIdx)(idx1 + 2);
                 _IdxWritePtr[3]  = (ImDrawIdx)(idx1 + 2); _IdxWritePtr[4]  = (ImDrawIdx)(idx2 + 2); _IdxWritePtr[5]  = (ImDrawIdx)(idx2 + 1);
                 _IdxWritePtr[6]  = (ImDrawIdx)(idx2 + 1); _IdxWritePtr[7]  = (ImDrawIdx)(idx1 + 1); _IdxWritePtr[8]  = (ImDrawIdx)(idx1 + 0);
@@ -899,70 +1230,45 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
                 _IdxWritePtr[12] = (ImDrawIdx)(idx2 + 2); _IdxWritePtr[13] = (ImDrawIdx)(idx1 + 2); _IdxWritePtr[14] = (ImDrawIdx)(idx1 + 3);
                 _IdxWritePtr[15] = (ImDrawIdx)(idx1 + 3); _IdxWritePtr[16] = (ImDrawIdx)(idx2 + 3); _IdxWritePtr[17] = (ImDrawIdx)(idx2 + 2);
                 _IdxWritePtr += 18;
-
                 idx1 = idx2;
             }
-
-            // Add vertices
-            for (int i = 0; i < points_count; i++)
-            {
-                _VtxWritePtr[0].pos = temp_points[i * 4 + 0]; _VtxWritePtr[0].uv = opaque_uv; _VtxWritePtr[0].col = col_trans;
-                _VtxWritePtr[1].pos = temp_points[i * 4 + 1]; _VtxWritePtr[1].uv = opaque_uv; _VtxWritePtr[1].col = col;
-                _VtxWritePtr[2].pos = temp_points[i * 4 + 2]; _VtxWritePtr[2].uv = opaque_uv; _VtxWritePtr[2].col = col;
-                _VtxWritePtr[3].pos = temp_points[i * 4 + 3]; _VtxWritePtr[3].uv = opaque_uv; _VtxWritePtr[3].col = col_trans;
-                _VtxWritePtr += 4;
-            }
         }
-        _VtxCurrentIdx += (ImDrawIdx)vtx_count;
     }
     else
     {
         // [PATH 4] Non texture-based, Non anti-aliased lines
         const int idx_count = count * 6;
-        const int vtx_count = count * 4;    // FIXME-OPT: Not sharing edges
+        vtx_count = count * 4;    // FIXME-OPT: Not sharing edges
         PrimReserve(idx_count, vtx_count);
 
         for (int i1 = 0; i1 < count; i1++)
         {
-            const int i2 = (i1 + 1) == points_count ? 0 : i1 + 1;
-            const ImVec2& p1 = points[i1];
-            const ImVec2& p2 = points[i2];
-
-            float dx = p2.x - p1.x;
-            float dy = p2.y - p1.y;
-            IM_NORMALIZE2F_OVER_ZERO(dx, dy);
-            dx *= (thickness * 0.5f);
-            dy *= (thickness * 0.5f);
-
-            _VtxWritePtr[0].pos.x = p1.x + dy; _VtxWritePtr[0].pos.y = p1.y - dx; _VtxWritePtr[0].uv = opaque_uv; _VtxWritePtr[0].col = col;
-            _VtxWritePtr[1].pos.x = p2.x + dy; _VtxWritePtr[1].pos.y = p2.y - dx; _VtxWritePtr[1].uv = opaque_uv; _VtxWritePtr[1].col = col;
-            _VtxWritePtr[2].pos.x = p2.x - dy; _VtxWritePtr[2].pos.y = p2.y + dx; _VtxWritePtr[2].uv = opaque_uv; _VtxWritePtr[2].col = col;
-            _VtxWritePtr[3].pos.x = p1.x - dy; _VtxWritePtr[3].pos.y = p1.y + dx; _VtxWritePtr[3].uv = opaque_uv; _VtxWritePtr[3].col = col;
-            _VtxWritePtr += 4;
-
-            _IdxWritePtr[0] = (ImDrawIdx)(_VtxCurrentIdx); _IdxWritePtr[1] = (ImDrawIdx)(_VtxCurrentIdx + 1); _IdxWritePtr[2] = (ImDrawIdx)(_VtxCurrentIdx + 2);
-            _IdxWritePtr[3] = (ImDrawIdx)(_VtxCurrentIdx); _IdxWritePtr[4] = (ImDrawIdx)(_VtxCurrentIdx + 2); _IdxWritePtr[5] = (ImDrawIdx)(_VtxCurrentIdx + 3);
+            const unsigned int idx = _VtxCurrentIdx + i1 * 4;
+            _IdxWritePtr[0] = (ImDrawIdx)(idx); _IdxWritePtr[1] = (ImDrawIdx)(idx + 1); _IdxWritePtr[2] = (ImDrawIdx)(idx + 2);
+            _IdxWritePtr[3] = (ImDrawIdx)(idx); _IdxWritePtr[4] = (ImDrawIdx)(idx + 2); _IdxWritePtr[5] = (ImDrawIdx)(idx + 3);
             _IdxWritePtr += 6;
-            _VtxCurrentIdx += 4;
         }
     }
+
+    if (Flags & ImDrawListFlags_DeferTessellation)
+        ImDrawList_DeferPrim(this, points, points_count, col, flags, thickness, false);
+    else
+        ImDrawList_PolylineVertices(_Data, _VtxWritePtr, points, points_count, col, flags, thickness, Flags, _FringeScale);
+    _VtxWritePtr += vtx_count;
+    _VtxCurrentIdx += (ImDrawIdx)vtx_count;
 }
 
-// We intentionally avoid using ImVec2 and its math operators here to reduce cost to a minimum for debug/non-inlined builds.
 void ImDrawList::AddConvexPolyFilled(const ImVec2* points, const int points_count, ImU32 col)
 {
     if (points_count < 3)
         return;
 
-    const ImVec2 uv = _Data->TexUvWhitePixel;
-
+    int vtx_count;
     if (Flags & ImDrawListFlags_AntiAliasedFill)
     {
         // Anti-aliased Fill
-        const float AA_SIZE = _FringeScale;
-        const ImU32 col_trans = col & ~IM_COL32_A_MASK;
         const int idx_count = (points_count - 2)*3 + points_count * 6;
-        const int vtx_count = (points_count * 2);
+        vtx_count = (points_count * 2);
         PrimReserve(idx_count, vtx_count);
 
         // Add indexes for fill
@@ -974,60 +1280,49 @@ void ImDrawList::AddConvexPolyFilled(const ImVec2* points, const int points_coun
             _IdxWritePtr += 3;
         }
 
-        // Compute normals
-        ImVec2* temp_normals = (ImVec2*)alloca(points_count * sizeof(ImVec2)); //-V630
+        // Add indexes for fringes
         for (int i0 = points_count - 1, i1 = 0; i1 < points_count; i0 = i1++)
         {
-            const ImVec2& p0 = points[i0];
-            const ImVec2& p1 = points[i1];
-            float dx = p1.x - p0.x;
-            float dy = p1.y - p0.y;
-            IM_NORMALIZE2F_OVER_ZERO(dx, dy);
-            temp_normals[i0].x = dy;
-            temp_normals[i0].y = -dx;
-        }
-
-        for (int i0 = points_count - 1, i1 = 0; i1 < points_count; i0 = i1++)
-        {
-            // Average normals
-            const ImVec2& n0 = temp_normals[i0];
-            const ImVec2& n1 = temp_normals[i1];
-            float dm_x = (n0.x + n1.x) * 0.5f;
-            float dm_y = (n0.y + n1.y) * 0.5f;
-            IM_FIXNORMAL2F(dm_x, dm_y);
-            dm_x *= AA_SIZE * 0.5f;
-            dm_y *= AA_SIZE * 0.5f;
-
-            // Add vertices
-            _VtxWritePtr[0].pos.x = (points[i1].x - dm_x); _VtxWritePtr[0].pos.y = (points[i1].y - dm_y); _VtxWritePtr[0].uv = uv; _VtxWritePtr[0].col = col;        // Inner
-            _VtxWritePtr[1].pos.x = (points[i1].x + dm_x); _VtxWritePtr[1].pos.y = (points[i1].y + dm_y); _VtxWritePtr[1].uv = uv; _VtxWritePtr[1].col = col_trans;  // Outer
-            _VtxWritePtr += 2;
-
-            // Add indexes for fringes
             _IdxWritePtr[0] = (ImDrawIdx)(vtx_inner_idx + (i1 << 1)); _IdxWritePtr[1] = (ImDrawIdx)(vtx_inner_idx + (i0 << 1)); _IdxWritePtr[2] = (ImDrawIdx)(vtx_outer_idx + (i0 << 1));
             _IdxWritePtr[3] = (ImDrawIdx)(vtx_outer_idx + (i0 << 1)); _IdxWritePtr[4] = (ImDrawIdx)(vtx_outer_idx + (i1 << 1)); _IdxWritePtr[5] = (ImDrawIdx)(vtx_inner_idx + (i1 << 1));
             _IdxWritePtr += 6;
         }
-        _VtxCurrentIdx += (ImDrawIdx)vtx_count;
     }
     else
     {
         // Non Anti-aliased Fill
         const int idx_count = (points_count - 2)*3;
-        const int vtx_count = points_count;
+        vtx_count = points_count;
         PrimReserve(idx_count, vtx_count);
-        for (int i = 0; i < vtx_count; i++)
-        {
-            _VtxWritePtr[0].pos = points[i]; _VtxWritePtr[0].uv = uv; _VtxWritePtr[0].col = col;
-            _VtxWritePtr++;
-        }
         for (int i = 2; i < points_count; i++)
         {
             _IdxWritePtr[0] = (ImDrawIdx)(_VtxCurrentIdx); _IdxWritePtr[1] = (ImDrawIdx)(_VtxCurrentIdx + i - 1); _IdxWritePtr[2] = (ImDrawIdx)(_VtxCurrentIdx + i);
             _IdxWritePtr += 3;
         }
-        _VtxCurrentIdx += (ImDrawIdx)vtx_count;
     }
+
+    if (Flags & ImDrawListFlags_DeferTessellation)
+        ImDrawList_DeferPrim(this, points, points_count, col, ImDrawFlags_None, 0.0f, true);
+    else
+        ImDrawList_ConvexPolyFilledVertices(_Data, _VtxWritePtr, points, points_count, col, Flags, _FringeScale);
+    _VtxWritePtr += vtx_count;
+    _VtxCurrentIdx += (ImDrawIdx)vtx_count;
+}
+
+void ImDrawList::_TessellateDeferred()
+{
+    for (int n = 0; n < _DeferredPrims.Size; n++)
+    {
+        const ImDrawDeferredPrim& prim = _DeferredPrims[n];
+        ImDrawVert* vtx_write = VtxBuffer.Data + prim.VtxOffset;
+        const ImVec2* points = _DeferredPoints.Data + prim.PointsOffset;
+        if (prim.Filled)
+            ImDrawList_ConvexPolyFilledVertices(_Data, vtx_write, points, prim.PointsCount, prim.Col, prim.ListFlags, prim.FringeScale);
+        else
+            ImDrawList_PolylineVertices(_Data, vtx_write, points, prim.PointsCount, prim.Col, prim.Flags, prim.Thickness, prim.ListFlags, prim.FringeScale);
+    }
+    _DeferredPrims.resize(0);
+    _DeferredPoints.resize(0);
 }
 
 void ImDrawList::_PathArcToFastEx(const ImVec2& center, float radius, int a_min_sample, int a_max_sample, int a_step)
@@ -1120,12 +1415,9 @@ void ImDrawList::_PathArcToN(const ImVec2& center, float radius, float a_min, fl
 
     // Note that we are adding a point at both a_min and a_max.
     // If you are trying to draw a full closed circle you don't want the overlapping points!
-    _Path.reserve(_Path.Size + (num_segments + 1));
-    for (int i = 0; i <= num_segments; i++)
-    {
-        const float a = a_min + ((float)i / (float)num_segments) * (a_max - a_min);
-        _Path.push_back(ImVec2(center.x + ImCos(a) * radius, center.y + ImSin(a) * radius));
-    }
+    const int path_size = _Path.Size;
+    _Path.resize(path_size + (num_segments + 1));
+    ImTessellateArcPoints(_Path.Data + path_size, center, radius, a_min, a_max, num_segments);
 }
 
 // 0: East, 3: South, 6: West, 9: North, 12: East
@@ -1256,11 +1548,11 @@ void ImDrawList::PathBezierCubicCurveTo(const ImVec2& p2, const ImVec2& p3, cons
     {
         PathBezierCubicCurveToCasteljau(&_Path, p1.x, p1.y, p2.x, p2.y, p3.x, p3.y, p4.x, p4.y, _Data->CurveTessellationTol, 0); // Auto-tessellated
     }
-    else
+    else if (num_segments > 0)
     {
-        float t_step = 1.0f / (float)num_segments;
-        for (int i_step = 1; i_step <= num_segments; i_step++)
-            _Path.push_back(ImBezierCubicCalc(p1, p2, p3, p4, t_step * i_step));
+        const int path_size = _Path.Size;
+        _Path.resize(path_size + num_segments);
+        ImTessellateBezierCubicPoints(_Path.Data + path_size, p1, p2, p3, p4, num_segments);
     }
 }
 
@@ -1821,6 +2113,8 @@ void ImDrawData::ScaleClipRects(const ImVec2& fb_scale)
 // Generic linear color gradient, write to RGB fields, leave A untouched.
 void ImGui::ShadeVertsLinearColorGradientKeepAlpha(ImDrawList* draw_list, int vert_start_idx, int vert_end_idx, ImVec2 gradient_p0, ImVec2 gradient_p1, ImU32 col0, ImU32 col1)
 {
+    if (draw_list->_DeferredPrims.Size > 0)
+        draw_list->_TessellateDeferred(); // The vertices must exist before they can be shaded
     ImVec2 gradient_extent = gradient_p1 - gradient_p0;
     float gradient_inv_length2 = 1.0f / ImLengthSqr(gradient_extent);
     ImDrawVert* vert_start = draw_list->VtxBuffer.Data + vert_start_idx;
@@ -1845,6 +2139,8 @@ void ImGui::ShadeVertsLinearColorGradientKeepAlpha(ImDrawList* draw_list, int ve
 // Distribute UV over (a, b) rectangle
 void ImGui::ShadeVertsLinearUV(ImDrawList* draw_list, int vert_start_idx, int vert_end_idx, const ImVec2& a, const ImVec2& b, const ImVec2& uv_a, const ImVec2& uv_b, bool clamp)
 {
+    if (draw_list->_DeferredPrims.Size > 0)
+        draw_list->_TessellateDeferred(); // The vertices must exist before they can be shaded
     const ImVec2 size = b - a;
     const ImVec2 uv_size = uv_b - uv_a;
     const ImVec2 scale = ImVec2(
@@ -1934,6 +2230,15 @@ static const ImVec2 FONT_ATLAS_DEFAULT_TEX_CURSOR_DATA[ImGuiMouseCursor_COUNT][3
     { ImVec2(91,0), ImVec2(17,22), ImVec2( 5, 0) }, // ImGuiMouseCursor_Hand
 };
 
+// Font glyph versions come from one counter that never goes back, so that a font which is destroyed and recreated at the same
+// address (e.g. after ImFontAtlas::ClearFonts() and adding fonts again) can't be mistaken for the old one by cached text layouts.
+static int GImFontGlyphsVersion = 0;
+
+static int ImFontNextGlyphsVersion()
+{
+    return ++GImFontGlyphsVersion;
+}
+
 ImFontAtlas::ImFontAtlas()
 {
     memset(this, 0, sizeof(*this));
@@ -1950,6 +2255,7 @@ ImFontAtlas::~ImFontAtlas()
 void    ImFontAtlas::ClearInputData()
 {
     IM_ASSERT(!Locked && "Cannot modify a locked ImFontAtlas between NewFrame() and EndFrame/Render()!");
+    ImFontAtlasBuildDestroyDynamicData(this); // Pending glyphs can't be rasterized without the font data, they will stay invisible
     for (int i = 0; i < ConfigData.Size; i++)
         if (ConfigData[i].FontData && ConfigData[i].FontDataOwnedByAtlas)
         {
@@ -1972,6 +2278,7 @@ void    ImFontAtlas::ClearInputData()
 void    ImFontAtlas::ClearTexData()
 {
     IM_ASSERT(!Locked && "Cannot modify a locked ImFontAtlas between NewFrame() and EndFrame/Render()!");
+    ImFontAtlasBuildDestroyDynamicData(this);
     if (TexPixelsAlpha8)
         IM_FREE(TexPixelsAlpha8);
     if (TexPixelsRGBA32)
@@ -1979,11 +2286,13 @@ void    ImFontAtlas::ClearTexData()
     TexPixelsAlpha8 = NULL;
     TexPixelsRGBA32 = NULL;
     TexPixelsUseColors = false;
+    ClearTexDirty();
 }
 
 void    ImFontAtlas::ClearFonts()
 {
     IM_ASSERT(!Locked && "Cannot modify a locked ImFontAtlas between NewFrame() and EndFrame/Render()!");
+    ImFontAtlasBuildDestroyDynamicData(this);
     for (int i = 0; i < Fonts.Size; i++)
         IM_DELETE(Fonts[i]);
     Fonts.clear();
@@ -2276,6 +2585,7 @@ struct ImFontBuildSrcData
     int                 DstIndex;           // Index into atlas->Fonts[] and dst_tmp_array[]
     int                 GlyphsHighest;      // Highest requested codepoint
     int                 GlyphsCount;        // Glyph count (excluding missing glyphs and glyphs already set by an earlier source font)
+    int                 GlyphsPendingCount; // Glyphs at the end of GlyphsList which are registered but not packed nor rasterized (ImFontAtlasFlags_DynamicGlyphs)
     ImBitVector         GlyphsSet;          // Glyph bit map (random access, 1-bit per codepoint. This will be a maximum of 8KB)
     ImVector<int>       GlyphsList;         // Glyph codepoints list (flattened version of GlyphsMap)
 };
@@ -2289,6 +2599,23 @@ struct ImFontBuildDstData
     ImBitVector         GlyphsSet;          // This is used to resolve collision when multiple sources are merged into a same destination font.
 };
 
+// Data kept for one source font after building with ImFontAtlasFlags_DynamicGlyphs
+struct ImFontAtlasDynamicSrcData
+{
+    stbtt_fontinfo      FontInfo;           // Points into ImFontConfig::FontData, which is why ClearInputData() gives up on the pending glyphs
+    ImBitVector         PendingSet;         // Codepoints registered into the destination font but not rasterized yet
+};
+
+// Data kept by the atlas after building with ImFontAtlasFlags_DynamicGlyphs, to rasterize the pending glyphs when they are first used
+struct ImFontAtlasDynamicData
+{
+    stbtt_pack_context  PackContext;        // Packer of the build (its skyline knows the free space left), pixels point to atlas->TexPixelsAlpha8
+    ImVector<ImFontAtlasDynamicSrcData> Sources; // Same indices as atlas->ConfigData[]
+    bool                GrowRequested;      // A glyph didn't fit: grow the texture on the next NewFrame()
+
+    ImFontAtlasDynamicData() { memset(&PackContext, 0, sizeof(PackContext)); GrowRequested = false; }
+};
+
 static void UnpackBitVectorToFlatIndexList(const ImBitVector* in, ImVector<int>* out)
 {
     IM_ASSERT(sizeof(in->Storage.Data[0]) == sizeof(int));
@@ -2301,6 +2628,27 @@ static void UnpackBitVectorToFlatIndexList(const ImBitVector* in, ImVector<int>*
                     out->push_back((int)(((it - it_begin) << 5) + bit_n));
 }
 
+// Compute the metrics of a glyph the same way stbtt_PackFontRangesRenderIntoRects() does, without rasterizing it.
+// 'w' and 'h' are the size of its packing rectangle without padding. The texture coordinates are left empty.
+static void ImFontAtlasBuildCalcPackedCharMetrics(const stbtt_fontinfo* info, const ImFontConfig* cfg, int codepoint, int w, int h, stbtt_packedchar* out)
+{
+    const float scale = (cfg->SizePixels > 0) ? stbtt_ScaleForPixelHeight(info, cfg->SizePixels) : stbtt_ScaleForMappingEmToPixels(info, -cfg->SizePixels);
+    const float recip_h = 1.0f / cfg->OversampleH;
+    const float recip_v = 1.0f / cfg->OversampleV;
+    const float sub_x = (float)-(cfg->OversampleH - 1) / (2.0f * (float)cfg->OversampleH);
+    const float sub_y = (float)-(cfg->OversampleV - 1) / (2.0f * (float)cfg->OversampleV);
+    const int glyph_index_in_font = stbtt_FindGlyphIndex(info, codepoint);
+    int advance, lsb, x0, y0, x1, y1;
+    stbtt_GetGlyphHMetrics(info, glyph_index_in_font, &advance, &lsb);
+    stbtt_GetGlyphBitmapBox(info, glyph_index_in_font, scale * cfg->OversampleH, scale * cfg->OversampleV, &x0, &y0, &x1, &y1);
+    out->x0 = out->y0 = out->x1 = out->y1 = 0;
+    out->xadvance = scale * advance;
+    out->xoff = (float)x0 * recip_h + sub_x;
+    out->yoff = (float)y0 * recip_v + sub_y;
+    out->xoff2 = (x0 + w) * recip_h + sub_x;
+    out->yoff2 = (y0 + h) * recip_v + sub_y;
+}
+
 static bool ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
 {
     IM_ASSERT(atlas->ConfigData.Size > 0);
@@ -2382,13 +2730,26 @@ static bool ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
     }
 
     // 3. Unpack our bit map into a flat list (we now have all the Unicode points that we know are requested _and_ available _and_ not overlapping another)
+    // With ImFontAtlasFlags_DynamicGlyphs, only Basic Latin + Latin Supplement are packed and rasterized now. The list is sorted so the pending glyphs are at the end,
+    // and we keep the bit map of their codepoints to find back their source font when they get used.
+    const bool dynamic_glyphs = (atlas->Flags & ImFontAtlasFlags_DynamicGlyphs) != 0;
+    int total_pending_count = 0;
     for (int src_i = 0; src_i < src_tmp_array.Size; src_i++)
     {
         ImFontBuildSrcData& src_tmp = src_tmp_array[src_i];
         src_tmp.GlyphsList.reserve(src_tmp.GlyphsCount);
         UnpackBitVectorToFlatIndexList(&src_tmp.GlyphsSet, &src_tmp.GlyphsList);
-        src_tmp.GlyphsSet.Clear();
         IM_ASSERT(src_tmp.GlyphsList.Size == src_tmp.GlyphsCount);
+        if (dynamic_glyphs)
+        {
+            while (src_tmp.GlyphsPendingCount < src_tmp.GlyphsCount && src_tmp.GlyphsList[src_tmp.GlyphsCount - src_tmp.GlyphsPendingCount - 1] > 0xFF)
+                src_tmp.GlyphsPendingCount++;
+            for (int codepoint = 0; codepoint <= 0xFF && codepoint <= src_tmp.GlyphsHighest; codepoint++)
+                src_tmp.GlyphsSet.ClearBit(codepoint);
+            total_pending_count += src_tmp.GlyphsPendingCount;
+        }
+        if (src_tmp.GlyphsPendingCount == 0)
+            src_tmp.GlyphsSet.Clear();
     }
     for (int dst_i = 0; dst_i < dst_tmp_array.Size; dst_i++)
         dst_tmp_array[dst_i].GlyphsSet.Clear();
@@ -2439,8 +2800,10 @@ static bool ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
             stbtt_GetGlyphBitmapBoxSubpixel(&src_tmp.FontInfo, glyph_index_in_font, scale * cfg.OversampleH, scale * cfg.OversampleV, 0, 0, &x0, &y0, &x1, &y1);
             src_tmp.Rects[glyph_i].w = (stbrp_coord)(x1 - x0 + padding + cfg.OversampleH - 1);
             src_tmp.Rects[glyph_i].h = (stbrp_coord)(y1 - y0 + padding + cfg.OversampleV - 1);
-            total_surface += src_tmp.Rects[glyph_i].w * src_tmp.Rects[glyph_i].h;
+            if (glyph_i < src_tmp.GlyphsCount - src_tmp.GlyphsPendingCount)
+                total_surface += src_tmp.Rects[glyph_i].w * src_tmp.Rects[glyph_i].h;
         }
+        src_tmp.PackRange.num_chars -= src_tmp.GlyphsPendingCount;
     }
 
     // We need a width for the skyline algorithm, any width!
@@ -2467,17 +2830,20 @@ static bool ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
         if (src_tmp.GlyphsCount == 0)
             continue;
 
-        stbrp_pack_rects((stbrp_context*)spc.pack_info, src_tmp.Rects, src_tmp.GlyphsCount);
+        stbrp_pack_rects((stbrp_context*)spc.pack_info, src_tmp.Rects, src_tmp.PackRange.num_chars);
 
         // Extend texture height and mark missing glyphs as non-packed so we won't render them.
         // FIXME: We are not handling packing failure here (would happen if we got off TEX_HEIGHT_MAX or if a single if larger than TexWidth?)
-        for (int glyph_i = 0; glyph_i < src_tmp.GlyphsCount; glyph_i++)
+        for (int glyph_i = 0; glyph_i < src_tmp.PackRange.num_chars; glyph_i++)
             if (src_tmp.Rects[glyph_i].was_packed)
                 atlas->TexHeight = ImMax(atlas->TexHeight, src_tmp.Rects[glyph_i].y + src_tmp.Rects[glyph_i].h);
     }
 
     // 7. Allocate texture
+    // With pending glyphs, double the height to leave them some free space. The texture grows between frames if they need more.
     atlas->TexHeight = (atlas->Flags & ImFontAtlasFlags_NoPowerOfTwoHeight) ? (atlas->TexHeight + 1) : ImUpperPowerOfTwo(atlas->TexHeight);
+    if (total_pending_count > 0)
+        atlas->TexHeight = ImMin(atlas->TexHeight * 2, TEX_HEIGHT_MAX);
     atlas->TexUvScale = ImVec2(1.0f / atlas->TexWidth, 1.0f / atlas->TexHeight);
     atlas->TexPixelsAlpha8 = (unsigned char*)IM_ALLOC(atlas->TexWidth * atlas->TexHeight);
     memset(atlas->TexPixelsAlpha8, 0, atlas->TexWidth * atlas->TexHeight);
@@ -2500,16 +2866,31 @@ static bool ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
             unsigned char multiply_table[256];
             ImFontAtlasBuildMultiplyCalcLookupTable(multiply_table, cfg.RasterizerMultiply);
             stbrp_rect* r = &src_tmp.Rects[0];
-            for (int glyph_i = 0; glyph_i < src_tmp.GlyphsCount; glyph_i++, r++)
+            for (int glyph_i = 0; glyph_i < src_tmp.PackRange.num_chars; glyph_i++, r++)
                 if (r->was_packed)
                     ImFontAtlasBuildMultiplyRectAlpha8(multiply_table, atlas->TexPixelsAlpha8, r->x, r->y, r->w, r->h, atlas->TexWidth * 1);
         }
-        src_tmp.Rects = NULL;
     }
 
-    // End packing
-    stbtt_PackEnd(&spc);
-    buf_rects.clear();
+    // End packing, or keep the packer to fit the pending glyphs in the remaining space
+    if (total_pending_count > 0)
+    {
+        ImFontAtlasDynamicData* dynamic_data = atlas->DynamicData = IM_NEW(ImFontAtlasDynamicData)();
+        dynamic_data->PackContext = spc;
+        ((stbrp_context*)spc.pack_info)->height = atlas->TexHeight - atlas->TexGlyphPadding;
+        dynamic_data->Sources.resize(src_tmp_array.Size);
+        for (int src_i = 0; src_i < src_tmp_array.Size; src_i++)
+        {
+            ImFontAtlasDynamicSrcData& src_dynamic = dynamic_data->Sources[src_i];
+            IM_PLACEMENT_NEW(&src_dynamic) ImFontAtlasDynamicSrcData();
+            src_dynamic.FontInfo = src_tmp_array[src_i].FontInfo;
+            src_dynamic.PendingSet.Storage.swap(src_tmp_array[src_i].GlyphsSet.Storage);
+        }
+    }
+    else
+    {
+        stbtt_PackEnd(&spc);
+    }
 
     // 9. Setup ImFont and glyphs for runtime
     for (int src_i = 0; src_i < src_tmp_array.Size; src_i++)
@@ -2538,13 +2919,26 @@ static bool ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
         {
             // Register glyph
             const int codepoint = src_tmp.GlyphsList[glyph_i];
+            const bool pending = (glyph_i >= src_tmp.PackRange.num_chars);
+            if (pending)
+                ImFontAtlasBuildCalcPackedCharMetrics(&src_tmp.FontInfo, &cfg, codepoint, src_tmp.Rects[glyph_i].w - atlas->TexGlyphPadding, src_tmp.Rects[glyph_i].h - atlas->TexGlyphPadding, &src_tmp.PackedChars[glyph_i]);
             const stbtt_packedchar& pc = src_tmp.PackedChars[glyph_i];
             stbtt_aligned_quad q;
             float unused_x = 0.0f, unused_y = 0.0f;
             stbtt_GetPackedQuad(src_tmp.PackedChars, atlas->TexWidth, atlas->TexHeight, glyph_i, &unused_x, &unused_y, &q, 0);
             dst_font->AddGlyph(&cfg, (ImWchar)codepoint, q.x0 + font_off_x, q.y0 + font_off_y, q.x1 + font_off_x, q.y1 + font_off_y, q.s0, q.t0, q.s1, q.t1, pc.xadvance);
+
+            // Glyphs without pixels (e.g. spaces) have nothing to rasterize
+            ImFontGlyph& glyph = dst_font->Glyphs.back();
+            if (pending && glyph.Visible)
+            {
+                glyph.Visible = false;
+                glyph.Pending = true;
+            }
         }
+        src_tmp.Rects = NULL;
     }
+    buf_rects.clear();
 
     // Cleanup temporary (ImVector doesn't honor destructor)
     for (int src_i = 0; src_i < src_tmp_array.Size; src_i++)
@@ -2561,6 +2955,171 @@ const ImFontBuilderIO* ImFontAtlasGetBuilderForStbTruetype()
     return &io;
 }
 
+static void ImFontAtlasBuildMarkTexDirty(ImFontAtlas* atlas, int x, int y, int w, int h)
+{
+    if (!atlas->IsTexDirty())
+    {
+        atlas->TexDirtyX0 = x;
+        atlas->TexDirtyY0 = y;
+        atlas->TexDirtyX1 = x + w;
+        atlas->TexDirtyY1 = y + h;
+        return;
+    }
+    atlas->TexDirtyX0 = ImMin(atlas->TexDirtyX0, x);
+    atlas->TexDirtyY0 = ImMin(atlas->TexDirtyY0, y);
+    atlas->TexDirtyX1 = ImMax(atlas->TexDirtyX1, x + w);
+    atlas->TexDirtyY1 = ImMax(atlas->TexDirtyY1, y + h);
+}
+
+bool ImFontAtlasBuildRasterizePendingGlyph(ImFontAtlas* atlas, ImFont* font, ImFontGlyph* glyph)
+{
+    IM_ASSERT(glyph->Pending);
+    ImFontAtlasDynamicData* dynamic_data = atlas->DynamicData;
+    if (dynamic_data == NULL)
+        return false;
+
+    // Find the source font which registered the glyph
+    const int codepoint = (int)glyph->Codepoint;
+    int src_i = 0;
+    for (; src_i < dynamic_data->Sources.Size; src_i++)
+    {
+        const ImBitVector& pending_set = dynamic_data->Sources[src_i].PendingSet;
+        if (atlas->ConfigData[src_i].DstFont == font && codepoint < pending_set.Storage.Size * 32 && pending_set.TestBit(codepoint))
+            break;
+    }
+    if (src_i == dynamic_data->Sources.Size)
+        return false;
+    ImFontAtlasDynamicSrcData& src_dynamic = dynamic_data->Sources[src_i];
+    const ImFontConfig& cfg = atlas->ConfigData[src_i];
+
+    // Pack into the free space (same rectangle size as gathered by ImFontAtlasBuildWithStbTruetype)
+    const float scale = (cfg.SizePixels > 0) ? stbtt_ScaleForPixelHeight(&src_dynamic.FontInfo, cfg.SizePixels) : stbtt_ScaleForMappingEmToPixels(&src_dynamic.FontInfo, -cfg.SizePixels);
+    int x0, y0, x1, y1;
+    stbtt_GetGlyphBitmapBoxSubpixel(&src_dynamic.FontInfo, stbtt_FindGlyphIndex(&src_dynamic.FontInfo, codepoint), scale * cfg.OversampleH, scale * cfg.OversampleV, 0, 0, &x0, &y0, &x1, &y1);
+    stbrp_rect rect;
+    memset(&rect, 0, sizeof(rect));
+    rect.w = (stbrp_coord)(x1 - x0 + atlas->TexGlyphPadding + cfg.OversampleH - 1);
+    rect.h = (stbrp_coord)(y1 - y0 + atlas->TexGlyphPadding + cfg.OversampleV - 1);
+    stbrp_pack_rects((stbrp_context*)dynamic_data->PackContext.pack_info, &rect, 1);
+    if (!rect.was_packed)
+    {
+        dynamic_data->GrowRequested = true;
+        return false;
+    }
+
+    // Rasterize
+    int codepoints[1] = { codepoint };
+    stbtt_packedchar pc;
+    stbtt_pack_range range;
+    memset(&range, 0, sizeof(range));
+    range.font_size = cfg.SizePixels;
+    range.array_of_unicode_codepoints = codepoints;
+    range.num_chars = 1;
+    range.chardata_for_range = &pc;
+    range.h_oversample = (unsigned char)cfg.OversampleH;
+    range.v_oversample = (unsigned char)cfg.OversampleV;
+    stbtt_PackFontRangesRenderIntoRects(&dynamic_data->PackContext, &src_dynamic.FontInfo, &range, 1, &rect);
+    if (cfg.RasterizerMultiply != 1.0f)
+    {
+        unsigned char multiply_table[256];
+        ImFontAtlasBuildMultiplyCalcLookupTable(multiply_table, cfg.RasterizerMultiply);
+        ImFontAtlasBuildMultiplyRectAlpha8(multiply_table, atlas->TexPixelsAlpha8, rect.x, rect.y, rect.w, rect.h, atlas->TexWidth * 1);
+    }
+
+    // Keep the RGBA32 copy up to date if GetTexDataAsRGBA32() made one
+    if (atlas->TexPixelsRGBA32)
+        for (int y = rect.y; y < rect.y + rect.h; y++)
+        {
+            const unsigned char* src = atlas->TexPixelsAlpha8 + rect.x + y * atlas->TexWidth;
+            unsigned int* dst = atlas->TexPixelsRGBA32 + rect.x + y * atlas->TexWidth;
+            for (int n = rect.w; n > 0; n--)
+                *dst++ = IM_COL32(255, 255, 255, (unsigned int)(*src++));
+        }
+    ImFontAtlasBuildMarkTexDirty(atlas, rect.x, rect.y, rect.w, rect.h);
+
+    // The glyph metrics were already computed when building, only the texture coordinates are new
+    glyph->U0 = pc.x0 * atlas->TexUvScale.x;
+    glyph->V0 = pc.y0 * atlas->TexUvScale.y;
+    glyph->U1 = pc.x1 * atlas->TexUvScale.x;
+    glyph->V1 = pc.y1 * atlas->TexUvScale.y;
+    glyph->Visible = true;
+    glyph->Pending = false;
+    src_dynamic.PendingSet.ClearBit(codepoint);
+    font->MetricsTotalSurface += (rect.w + atlas->TexGlyphPadding) * (rect.h + atlas->TexGlyphPadding);
+    return true;
+}
+
+void ImFontAtlasBuildGrowTexture(ImFontAtlas* atlas)
+{
+    ImFontAtlasDynamicData* dynamic_data = atlas->DynamicData;
+    if (dynamic_data == NULL || !dynamic_data->GrowRequested)
+        return;
+    dynamic_data->GrowRequested = false;
+    const int TEX_HEIGHT_MAX = 1024 * 32;
+    if (atlas->TexHeight * 2 > TEX_HEIGHT_MAX)
+        return;
+
+    // Double the height, the existing texels stay where they are
+    const int old_size = atlas->TexWidth * atlas->TexHeight;
+    atlas->TexHeight *= 2;
+    atlas->TexUvScale = ImVec2(1.0f / atlas->TexWidth, 1.0f / atlas->TexHeight);
+    unsigned char* pixels_alpha8 = (unsigned char*)IM_ALLOC(old_size * 2);
+    memcpy(pixels_alpha8, atlas->TexPixelsAlpha8, old_size);
+    memset(pixels_alpha8 + old_size, 0, old_size);
+    IM_FREE(atlas->TexPixelsAlpha8);
+    atlas->TexPixelsAlpha8 = pixels_alpha8;
+    if (atlas->TexPixelsRGBA32)
+    {
+        unsigned int* pixels_rgba32 = (unsigned int*)IM_ALLOC((size_t)old_size * 2 * 4);
+        memcpy(pixels_rgba32, atlas->TexPixelsRGBA32, (size_t)old_size * 4);
+        for (int n = old_size; n < old_size * 2; n++)
+            pixels_rgba32[n] = IM_COL32(255, 255, 255, 0);
+        IM_FREE(atlas->TexPixelsRGBA32);
+        atlas->TexPixelsRGBA32 = pixels_rgba32;
+    }
+    dynamic_data->PackContext.pixels = atlas->TexPixelsAlpha8;
+    dynamic_data->PackContext.height = atlas->TexHeight;
+    ((stbrp_context*)dynamic_data->PackContext.pack_info)->height = atlas->TexHeight - atlas->TexGlyphPadding;
+    ImFontAtlasBuildMarkTexDirty(atlas, 0, 0, atlas->TexWidth, atlas->TexHeight);
+
+    // Halve every V coordinate (this is exact, so they stay identical to what a build at this height would give)
+    atlas->TexUvWhitePixel.y *= 0.5f;
+    for (int n = 0; n < IM_ARRAYSIZE(atlas->TexUvLines); n++)
+    {
+        atlas->TexUvLines[n].y *= 0.5f;
+        atlas->TexUvLines[n].w *= 0.5f;
+    }
+    for (int font_n = 0; font_n < atlas->Fonts.Size; font_n++)
+    {
+        ImFont* font = atlas->Fonts[font_n];
+        for (int glyph_n = 0; glyph_n < font->Glyphs.Size; glyph_n++)
+        {
+            font->Glyphs[glyph_n].V0 *= 0.5f;
+            font->Glyphs[glyph_n].V1 *= 0.5f;
+        }
+        font->GlyphsVersion = ImFontNextGlyphsVersion();
+    }
+}
+
+void ImFontAtlasBuildDestroyDynamicData(ImFontAtlas* atlas)
+{
+    ImFontAtlasDynamicData* dynamic_data = atlas->DynamicData;
+    if (dynamic_data == NULL)
+        return;
+    stbtt_PackEnd(&dynamic_data->PackContext);
+    for (int src_i = 0; src_i < dynamic_data->Sources.Size; src_i++)
+        dynamic_data->Sources[src_i].~ImFontAtlasDynamicSrcData(); // ImVector doesn't honor destructor
+    IM_DELETE(dynamic_data);
+    atlas->DynamicData = NULL;
+}
+
+#else
+
+// ImFontAtlasFlags_DynamicGlyphs is only implemented by the stb_truetype builder, other builders never leave pending glyphs.
+bool ImFontAtlasBuildRasterizePendingGlyph(ImFontAtlas*, ImFont*, ImFontGlyph*) { return false; }
+void ImFontAtlasBuildGrowTexture(ImFontAtlas*) {}
+void ImFontAtlasBuildDestroyDynamicData(ImFontAtlas*) {}
+
 #endif // IMGUI_ENABLE_STB_TRUETYPE
 
 void ImFontAtlasBuildSetupFont(ImFontAtlas* atlas, ImFont* font, ImFontConfig* font_config, float ascent, float descent)
@@ -3088,6 +3647,7 @@ ImFont::ImFont()
     Scale = 1.0f;
     Ascent = Descent = 0.0f;
     MetricsTotalSurface = 0;
+    GlyphsVersion = ImFontNextGlyphsVersion();
     memset(Used4kPagesMap, 0, sizeof(Used4kPagesMap));
 }
 
@@ -3098,6 +3658,7 @@ ImFont::~ImFont()
 
 void    ImFont::ClearOutputData()
 {
+    GlyphsVersion = ImFontNextGlyphsVersion();
     FontSize = 0.0f;
     FallbackAdvanceX = 0.0f;
     Glyphs.clear();
@@ -3121,6 +3682,7 @@ void ImFont::BuildLookupTable()
     IndexAdvanceX.clear();
     IndexLookup.clear();
     DirtyLookupTables = false;
+    GlyphsVersion = ImFontNextGlyphsVersion();
     memset(Used4kPagesMap, 0, sizeof(Used4kPagesMap));
     GrowIndex(max_codepoint + 1);
     for (int i = 0; i < Glyphs.Size; i++)
@@ -3175,6 +3737,7 @@ bool ImFont::IsGlyphRangeUnused(unsigned int c_begin, unsigned int c_last)
 
 void ImFont::SetGlyphVisible(ImWchar c, bool visible)
 {
+    GlyphsVersion = ImFontNextGlyphsVersion();
     if (ImFontGlyph* glyph = (ImFontGlyph*)(void*)FindGlyph((ImWchar)c))
         glyph->Visible = visible ? 1 : 0;
 }
@@ -3224,6 +3787,7 @@ void ImFont::AddGlyph(const ImFontConfig* cfg, ImWchar codepoint, float x0, floa
     glyph.Codepoint = (unsigned int)codepoint;
     glyph.Visible = (x0 != x1) && (y0 != y1);
     glyph.Colored = false;
+    glyph.Pending = false;
     glyph.X0 = x0;
     glyph.Y0 = y0;
     glyph.X1 = x1;
@@ -3243,6 +3807,7 @@ void ImFont::AddGlyph(const ImFontConfig* cfg, ImWchar codepoint, float x0, floa
 
 void ImFont::AddRemapChar(ImWchar dst, ImWchar src, bool overwrite_dst)
 {
+    GlyphsVersion = ImFontNextGlyphsVersion();
     IM_ASSERT(IndexLookup.Size > 0);    // Currently this can only be called AFTER the font has been built, aka after calling ImFontAtlas::GetTexDataAs*() function.
     unsigned int index_size = (unsigned int)IndexLookup.Size;
 
@@ -3256,6 +3821,8 @@ void ImFont::AddRemapChar(ImWchar dst, ImWchar src, bool overwrite_dst)
     IndexAdvanceX[dst] = (src < index_size) ? IndexAdvanceX.Data[src] : 1.0f;
 }
 
+// With ImFontAtlasFlags_DynamicGlyphs, the first lookup of a glyph rasterizes it into the atlas.
+// If it doesn't fit yet, it is returned as an invisible glyph (with the right advance) until the atlas grows on the next NewFrame().
 const ImFontGlyph* ImFont::FindGlyph(ImWchar c) const
 {
     if (c >= (size_t)IndexLookup.Size)
@@ -3263,7 +3830,10 @@ const ImFontGlyph* ImFont::FindGlyph(ImWchar c) const
     const ImWchar i = IndexLookup.Data[c];
     if (i == (ImWchar)-1)
         return FallbackGlyph;
-    return &Glyphs.Data[i];
+    const ImFontGlyph* glyph = &Glyphs.Data[i];
+    if (glyph->Pending)
+        ImFontAtlasBuildRasterizePendingGlyph(ContainerAtlas, (ImFont*)(void*)this, (ImFontGlyph*)(void*)glyph);
+    return glyph;
 }
 
 const ImFontGlyph* ImFont::FindGlyphNoFallback(ImWchar c) const
@@ -3273,7 +3843,10 @@ const ImFontGlyph* ImFont::FindGlyphNoFallback(ImWchar c) const
     const ImWchar i = IndexLookup.Data[c];
     if (i == (ImWchar)-1)
         return NULL;
-    return &Glyphs.Data[i];
+    const ImFontGlyph* glyph = &Glyphs.Data[i];
+    if (glyph->Pending)
+        ImFontAtlasBuildRasterizePendingGlyph(ContainerAtlas, (ImFont*)(void*)this, (ImFontGlyph*)(void*)glyph);
+    return glyph;
 }
 
 const char* ImFont::CalcWordWrapPositionA(float scale, const char* text, const char* text_end, float wrap_width) const
@@ -3483,11 +4056,8 @@ void ImFont::RenderChar(ImDrawList* draw_list, float size, ImVec2 pos, ImU32 col
     draw_list->PrimRectUV(ImVec2(pos.x + glyph->X0 * scale, pos.y + glyph->Y0 * scale), ImVec2(pos.x + glyph->X1 * scale, pos.y + glyph->Y1 * scale), ImVec2(glyph->U0, glyph->V0), ImVec2(glyph->U1, glyph->V1), col);
 }
 
-void ImFont::RenderText(ImDrawList* draw_list, float size, ImVec2 pos, ImU32 col, const ImVec4& clip_rect, const char* text_begin, const char* text_end, float wrap_width, bool cpu_fine_clip) const
+static void RenderTextUncached(const ImFont* font, ImDrawList* draw_list, float size, ImVec2 pos, ImU32 col, const ImVec4& clip_rect, const char* text_begin, const char* text_end, float wrap_width, bool cpu_fine_clip)
 {
-    if (!text_end)
-        text_end = text_begin + strlen(text_begin); // ImGui:: functions generally already provides a valid text_end, so this is merely to handle direct calls.
-
     // Align to be pixel perfect
     pos.x = IM_FLOOR(pos.x);
     pos.y = IM_FLOOR(pos.y);
@@ -3496,8 +4066,8 @@ void ImFont::RenderText(ImDrawList* draw_list, float size, ImVec2 pos, ImU32 col
     if (y > clip_rect.w)
         return;
 
-    const float scale = size / FontSize;
-    const float line_height = FontSize * scale;
+    const float scale = size / font->FontSize;
+    const float line_height = font->FontSize * scale;
     const bool word_wrap_enabled = (wrap_width > 0.0f);
     const char* word_wrap_eol = NULL;
 
@@ -3547,7 +4117,7 @@ void ImFont::RenderText(ImDrawList* draw_list, float size, ImVec2 pos, ImU32 col
             // Calculate how far we can render. Requires two passes on the string data but keeps the code simple and not intrusive for what's essentially an uncommon feature.
             if (!word_wrap_eol)
             {
-                word_wrap_eol = CalcWordWrapPositionA(scale, s, text_end, wrap_width - (x - pos.x));
+                word_wrap_eol = font->CalcWordWrapPositionA(scale, s, text_end, wrap_width - (x - pos.x));
                 if (word_wrap_eol == s) // Wrap_width is too small to fit anything. Force displaying 1 character to minimize the height discontinuity.
                     word_wrap_eol++;    // +1 may not be a character start point in UTF-8 but it's ok because we use s >= word_wrap_eol below
             }
@@ -3595,7 +4165,7 @@ void ImFont::RenderText(ImDrawList* draw_list, float size, ImVec2 pos, ImU32 col
                 continue;
         }
 
-        const ImFontGlyph* glyph = FindGlyph((ImWchar)c);
+        const ImFontGlyph* glyph = font->FindGlyph((ImWchar)c);
         if (glyph == NULL)
             continue;
 
@@ -3674,6 +4244,180 @@ void ImFont::RenderText(ImDrawList* draw_list, float size, ImVec2 pos, ImU32 col
     draw_list->_VtxCurrentIdx = vtx_current_idx;
 }
 
+#ifndef IMGUI_DISABLE_TEXT_LAYOUT_CACHE
+
+void ImTextLayoutCache::Clear()
+{
+    for (int n = 0; n < Entries.Size; n++)
+        IM_DELETE(Entries[n]);
+    Entries.clear();
+    Map.Clear();
+}
+
+void ImTextLayoutCache::NewFrame()
+{
+    FrameCount++;
+
+    // Entries which were only used on a single frame are most likely text that changes every frame, so they go right away.
+    for (int n = 0; n < Entries.Size; n++)
+    {
+        ImTextLayoutCacheEntry* entry = Entries[n];
+        const bool used_on_single_frame = entry->FirstUsedFrame == entry->LastUsedFrame;
+        if (FrameCount - entry->LastUsedFrame > (used_on_single_frame ? 1 : IM_TEXT_LAYOUT_CACHE_MAX_AGE))
+        {
+            // Only the removed key and the key of the entry moved into its place change in the map.
+            Map.RemoveKey(entry->Hash);
+            IM_DELETE(entry);
+            Entries[n] = Entries.back();
+            Entries.pop_back();
+            if (n < Entries.Size)
+                Map.SetInt(Entries[n]->Hash, n + 1);
+            n--;
+        }
+    }
+}
+
+ImTextLayoutCacheEntry* ImTextLayoutCache::Find(const ImFont* font, float size, float wrap_width, const char* text_begin, const char* text_end)
+{
+    const size_t text_length = (size_t)(text_end - text_begin);
+    if (text_length > IM_TEXT_LAYOUT_CACHE_MAX_TEXT_LENGTH)
+        return NULL;
+
+    struct { const ImFont* Font; float Size; float WrapWidth; } key;
+    memset(&key, 0, sizeof(key));
+    key.Font = font;
+    key.Size = size;
+    key.WrapWidth = wrap_width;
+    const ImGuiID hash = ImHashData(text_begin, text_length, ImHashData(&key, sizeof(key)));
+
+    ImTextLayoutCacheEntry* entry = NULL;
+    if (int index = Map.GetInt(hash))
+    {
+        entry = Entries[index - 1];
+        if (entry->Font != font || entry->FontSize != size || entry->WrapWidth != wrap_width || entry->Text.Size != (int)text_length || memcmp(entry->Text.Data, text_begin, text_length) != 0)
+            return NULL; // Hash collision: the first text keeps the entry
+    }
+    else
+    {
+        if (Entries.Size >= IM_TEXT_LAYOUT_CACHE_MAX_ENTRIES)
+            return NULL;
+        entry = IM_NEW(ImTextLayoutCacheEntry)();
+        entry->Hash = hash;
+        entry->Font = font;
+        entry->FontSize = size;
+        entry->WrapWidth = wrap_width;
+        entry->FontGlyphsVersion = font->GlyphsVersion;
+        entry->FirstUsedFrame = FrameCount;
+        entry->Text.resize((int)text_length);
+        memcpy(entry->Text.Data, text_begin, text_length);
+        entry->HasSize = entry->HasVertices = false;
+        Entries.push_back(entry);
+        Map.SetInt(hash, Entries.Size);
+    }
+
+    entry->LastUsedFrame = FrameCount;
+    if (entry->FontGlyphsVersion != font->GlyphsVersion)
+    {
+        entry->FontGlyphsVersion = font->GlyphsVersion;
+        entry->HasSize = entry->HasVertices = false;
+    }
+    return (FrameCount > entry->FirstUsedFrame) ? entry : NULL;
+}
+
+// Lays out the text at (0,0) without any clipping by rendering it into the draw list, then copies the quads into the cache entry and gives the space back.
+static bool FillTextLayoutCacheEntry(const ImFont* font, ImDrawList* draw_list, float size, const char* text_begin, const char* text_end, float wrap_width, ImTextLayoutCacheEntry* entry)
+{
+    // With 16-bit indices, PrimReserve() may have to start a new draw command, which we wouldn't be able to undo.
+    if (sizeof(ImDrawIdx) == 2 && draw_list->_VtxCurrentIdx + (text_end - text_begin) * 4 >= (1 << 16))
+        return false;
+
+    const int vtx_begin = draw_list->VtxBuffer.Size;
+    const int idx_begin = draw_list->IdxBuffer.Size;
+    const unsigned int vtx_current_idx = draw_list->_VtxCurrentIdx;
+    ImDrawCmd& draw_cmd = draw_list->CmdBuffer[draw_list->CmdBuffer.Size - 1];
+    const unsigned int elem_count = draw_cmd.ElemCount;
+
+    RenderTextUncached(font, draw_list, size, ImVec2(0.0f, 0.0f), 0, ImVec4(-FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX), text_begin, text_end, wrap_width, false);
+
+    const int vtx_count = draw_list->VtxBuffer.Size - vtx_begin;
+    entry->Vertices.resize(vtx_count);
+    if (vtx_count > 0)
+        memcpy(entry->Vertices.Data, draw_list->VtxBuffer.Data + vtx_begin, (size_t)vtx_count * sizeof(ImDrawVert));
+    entry->VerticesBounds = ImVec4(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (int n = 0; n < vtx_count; n++)
+    {
+        const ImVec2& p = entry->Vertices[n].pos;
+        entry->VerticesBounds = ImVec4(ImMin(entry->VerticesBounds.x, p.x), ImMin(entry->VerticesBounds.y, p.y), ImMax(entry->VerticesBounds.z, p.x), ImMax(entry->VerticesBounds.w, p.y));
+    }
+    if (!entry->HasSize)
+    {
+        entry->Size = font->CalcTextSizeA(size, FLT_MAX, wrap_width, text_begin, text_end, NULL);
+        entry->HasSize = true;
+    }
+    entry->HasVertices = true;
+
+    draw_list->VtxBuffer.Size = vtx_begin;
+    draw_list->IdxBuffer.Size = idx_begin;
+    draw_cmd.ElemCount = elem_count;
+    draw_list->_VtxWritePtr = draw_list->VtxBuffer.Data + vtx_begin;
+    draw_list->_IdxWritePtr = draw_list->IdxBuffer.Data + idx_begin;
+    draw_list->_VtxCurrentIdx = vtx_current_idx;
+    return true;
+}
+
+#endif // #ifndef IMGUI_DISABLE_TEXT_LAYOUT_CACHE
+
+void ImFont::RenderText(ImDrawList* draw_list, float size, ImVec2 pos, ImU32 col, const ImVec4& clip_rect, const char* text_begin, const char* text_end, float wrap_width, bool cpu_fine_clip) const
+{
+    if (!text_end)
+        text_end = text_begin + strlen(text_begin); // ImGui:: functions generally already provides a valid text_end, so this is merely to handle direct calls.
+
+#ifndef IMGUI_DISABLE_TEXT_LAYOUT_CACHE
+    // Cached layouts can only be used when nothing would have been clipped: the uncached path drops glyphs which are outside of the clip rect.
+    ImTextLayoutCacheEntry* entry = (!cpu_fine_clip && draw_list->_Data && draw_list->_Data->TextLayoutCache) ? draw_list->_Data->TextLayoutCache->Find(this, size, wrap_width, text_begin, text_end) : NULL;
+    if (entry && (entry->HasVertices || FillTextLayoutCacheEntry(this, draw_list, size, text_begin, text_end, wrap_width, entry)))
+    {
+        if (entry->Vertices.Size == 0)
+            return;
+        const float x = IM_FLOOR(pos.x);
+        const float y = IM_FLOOR(pos.y);
+        const ImVec4& bounds = entry->VerticesBounds;
+        const float last_line_y = y + ImMax(entry->Size.y - size, 0.0f);
+        if (x + bounds.x >= clip_rect.x && x + bounds.z <= clip_rect.z && y >= clip_rect.y && last_line_y <= clip_rect.w)
+        {
+            const int vtx_count = entry->Vertices.Size;
+            draw_list->PrimReserve(vtx_count / 4 * 6, vtx_count);
+            ImDrawVert* vtx_write = draw_list->_VtxWritePtr;
+            ImDrawIdx* idx_write = draw_list->_IdxWritePtr;
+            unsigned int vtx_current_idx = draw_list->_VtxCurrentIdx;
+            const ImDrawVert* vtx_read = entry->Vertices.Data;
+            for (int n = 0; n < vtx_count; n += 4)
+            {
+                idx_write[0] = (ImDrawIdx)(vtx_current_idx); idx_write[1] = (ImDrawIdx)(vtx_current_idx+1); idx_write[2] = (ImDrawIdx)(vtx_current_idx+2);
+                idx_write[3] = (ImDrawIdx)(vtx_current_idx); idx_write[4] = (ImDrawIdx)(vtx_current_idx+2); idx_write[5] = (ImDrawIdx)(vtx_current_idx+3);
+                for (int v = 0; v < 4; v++)
+                {
+                    vtx_write[v].pos.x = x + vtx_read[v].pos.x;
+                    vtx_write[v].pos.y = y + vtx_read[v].pos.y;
+                    vtx_write[v].uv = vtx_read[v].uv;
+                    vtx_write[v].col = col | vtx_read[v].col;
+                }
+                vtx_read += 4;
+                vtx_write += 4;
+                vtx_current_idx += 4;
+                idx_write += 6;
+            }
+            draw_list->_VtxWritePtr = vtx_write;
+            draw_list->_IdxWritePtr = idx_write;
+            draw_list->_VtxCurrentIdx = vtx_current_idx;
+            return;
+        }
+    }
+#endif
+
+    RenderTextUncached(this, draw_list, size, pos, col, clip_rect, text_begin, text_end, wrap_width, cpu_fine_clip);
+}
+
 //-----------------------------------------------------------------------------
 // [SECTION] ImGui Internal Render Helpers
 //-----------------------------------------------------------------------------
@@ -7,7 +7,7 @@
 //  [X] Platform: Mouse cursor shape and visibility. Disable with 'io.ConfigFlags |= ImGuiConfigFlags_NoMouseCursorChange'.
 //  [X] Platform: Clipboard support.
 //  [X] Platform: Keyboard arrays indexed using SDL_SCANCODE_* codes, e.g. ImGui::IsKeyPressed(SDL_SCANCODE_SPACE).
-//  [X] Platform: Gamepad support. Enabled with 'io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad'.
+//  [X] Platform: Gamepad support. Enabled with 'io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad'. Can be left to the application with ImGui_ImplSDL2_SetGamepadNavExternal().
 // Missing features:
 //  [ ] Platform: SDL2 handling of IME under Windows appears to be broken and it explicitly disable the regular Windows IME. You can restore Windows IME by compiling SDL with SDL_DISABLE_WINDOWS_IME.
 
@@ -17,6 +17,7 @@
 
 // CHANGELOG
 // (minor and older changes stripped away, please see git history for details)
+//  2026-10-19: Inputs: Keep the SDL_GameController handle open instead of calling SDL_GameControllerOpen() every frame (and never closing it). Added ImGui_ImplSDL2_SetGamepadNavExternal().
 //  2020-05-25: Misc: Report a zero display-size when window is minimized, to be consistent with other backends.
 //  2020-02-20: Inputs: Fixed mapping for ImGuiKey_KeyPadEnter (using SDL_SCANCODE_KP_ENTER instead of SDL_SCANCODE_RETURN2).
 //  2019-12-17: Inputs: On Wayland, use SDL_GetMouseState (because there is no global mouse state).
@@ -64,6 +65,9 @@ static bool         g_MousePressed[3] = { false, false, false };
 static SDL_Cursor*  g_MouseCursors[ImGuiMouseCursor_COUNT] = {};
 static char*        g_ClipboardTextData = NULL;
 static bool         g_MouseCanUseGlobalState = true;
+static SDL_GameController* g_GameController = NULL;
+static bool         g_GameControllerOpenPending = true;     // Try to open one on the next frame (after init and when a device was added)
+static bool         g_GamepadNavExternal = false;
 
 static const char* ImGui_ImplSDL2_GetClipboardText(void*)
 {
@@ -124,6 +128,21 @@ bool ImGui_ImplSDL2_ProcessEvent(const SDL_Event* event)
 #endif
             return true;
         }
+    case SDL_CONTROLLERDEVICEADDED:
+        {
+            g_GameControllerOpenPending = true;
+            return false;
+        }
+    case SDL_CONTROLLERDEVICEREMOVED:
+        {
+            if (g_GameController && SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(g_GameController)) == event->cdevice.which)
+            {
+                SDL_GameControllerClose(g_GameController);
+                g_GameController = NULL;
+                g_GameControllerOpenPending = true;     // Fall back to another connected one
+            }
+            return false;
+        }
     }
     return false;
 }
@@ -232,6 +251,22 @@ void ImGui_ImplSDL2_Shutdown()
     for (ImGuiMouseCursor cursor_n = 0; cursor_n < ImGuiMouseCursor_COUNT; cursor_n++)
         SDL_FreeCursor(g_MouseCursors[cursor_n]);
     memset(g_MouseCursors, 0, sizeof(g_MouseCursors));
+
+    if (g_GameController)
+        SDL_GameControllerClose(g_GameController);
+    g_GameController = NULL;
+    g_GameControllerOpenPending = true;
+}
+
+void ImGui_ImplSDL2_SetGamepadNavExternal(bool external)
+{
+    g_GamepadNavExternal = external;
+    if (external && g_GameController)
+    {
+        SDL_GameControllerClose(g_GameController);
+        g_GameController = NULL;
+    }
+    g_GameControllerOpenPending = true;
 }
 
 static void ImGui_ImplSDL2_UpdateMousePosAndButtons()
@@ -301,13 +336,24 @@ static void ImGui_ImplSDL2_UpdateMouseCursor()
 
 static void ImGui_ImplSDL2_UpdateGamepads()
 {
+    // The application fills io.NavInputs itself
+    if (g_GamepadNavExternal)
+        return;
+
     ImGuiIO& io = ImGui::GetIO();
     memset(io.NavInputs, 0, sizeof(io.NavInputs));
     if ((io.ConfigFlags & ImGuiConfigFlags_NavEnableGamepad) == 0)
         return;
 
-    // Get gamepad
-    SDL_GameController* game_controller = SDL_GameControllerOpen(0);
+    // Get gamepad (the handle is kept until the device is removed, so we only try to open one when devices were added)
+    if (!g_GameController && g_GameControllerOpenPending)
+    {
+        g_GameControllerOpenPending = false;
+        for (int joystick_n = 0; joystick_n < SDL_NumJoysticks() && !g_GameController; joystick_n++)
+            if (SDL_IsGameController(joystick_n))
+                g_GameController = SDL_GameControllerOpen(joystick_n);
+    }
+    SDL_GameController* game_controller = g_GameController;
     if (!game_controller)
     {
         io.BackendFlags &= ~ImGuiBackendFlags_HasGamepad;
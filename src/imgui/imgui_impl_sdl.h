@@ -27,3 +27,7 @@ IMGUI_IMPL_API bool     ImGui_ImplSDL2_InitForMetal(SDL_Window* window);
 IMGUI_IMPL_API void     ImGui_ImplSDL2_Shutdown();
 IMGUI_IMPL_API void     ImGui_ImplSDL2_NewFrame(SDL_Window* window);
 IMGUI_IMPL_API bool     ImGui_ImplSDL2_ProcessEvent(const SDL_Event* event);
+
+// With 'external' set, the backend doesn't open a game controller nor touch io.NavInputs/ImGuiBackendFlags_HasGamepad:
+// the application fills them itself every frame between ImGui_ImplSDL2_NewFrame() and ImGui::NewFrame(), e.g. from gamepads it already polls.
+IMGUI_IMPL_API void     ImGui_ImplSDL2_SetGamepadNavExternal(bool external);
@@ -13,6 +13,13 @@
 #include <functional>
 #include <unordered_map>
 
+#include "../worker_pool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IMGUI_IMPL_SDL_RENDERER_SSE2
+#endif
+
 namespace
 {
 	struct Device* CurrentDevice = nullptr;
@@ -91,6 +98,12 @@ namespace
 
 			Clean();
 		}
+
+		void Clear()
+		{
+			Container.clear();
+			Order.clear();
+		}
 	private:
 		void Clean()
 		{
@@ -107,12 +120,57 @@ namespace
 		std::unordered_map<Key, decltype(Order.begin()), TupleHash::Hash<Key>> Container;
 	};
 
+	// 8 bit color channels turned into floats from 0 to 1, so that we don't have to divide for every channel.
+	const std::array<float, 256> ChannelToFloat = [] {
+		std::array<float, 256> table{};
+		for (int i = 0; i < 256; i++) table[i] = i / 255.0f;
+		return table;
+	}();
+
+	// Helpers for colors packed into 32 bit integers (RGBA, with red in the lowest byte, same as ImU32).
+
+	inline uint32_t MultiplyChannel(uint32_t a, uint32_t b)
+	{
+		// Exact rounded (a * b) / 255 for 8 bit values.
+		const uint32_t product = a * b + 128;
+		return (product + (product >> 8)) >> 8;
+	}
+
+	// Multiplies two packed colors channel by channel, like a texel being tinted by a vertex color.
+	inline uint32_t Modulate(uint32_t a, uint32_t b)
+	{
+#ifdef IMGUI_IMPL_SDL_RENDERER_SSE2
+		// All 4 channels are multiplied at once in 16 bit lanes, with the same rounding as MultiplyChannel.
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i product = _mm_add_epi16(_mm_mullo_epi16(
+			_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(a)), zero),
+			_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(b)), zero)), _mm_set1_epi16(128));
+		const __m128i result = _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+		return static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(result, zero)));
+#else
+		return	(MultiplyChannel((a >> 0) & 0xff, (b >> 0) & 0xff) << 0)
+			  | (MultiplyChannel((a >> 8) & 0xff, (b >> 8) & 0xff) << 8)
+			  | (MultiplyChannel((a >> 16) & 0xff, (b >> 16) & 0xff) << 16)
+			  | (MultiplyChannel((a >> 24) & 0xff, (b >> 24) & 0xff) << 24);
+#endif
+	}
+
+	// Linear interpolation between two packed colors, with weight going from 0 (all a) to 256 (all b).
+	// Red/blue and green/alpha are each handled as two lanes of a single 32 bit integer.
+	inline uint32_t Lerp(uint32_t a, uint32_t b, uint32_t weight)
+	{
+		const uint32_t inverse = 256 - weight;
+		const uint32_t redBlue = (((a & 0x00ff00ff) * inverse + (b & 0x00ff00ff) * weight) >> 8) & 0x00ff00ff;
+		const uint32_t greenAlpha = (((a >> 8) & 0x00ff00ff) * inverse + ((b >> 8) & 0x00ff00ff) * weight) & 0xff00ff00;
+		return redBlue | greenAlpha;
+	}
+
 	struct Color
 	{
 		const float R, G, B, A;
 
 		explicit Color(uint32_t color)
-			: R(((color >> 0) & 0xff) / 255.0f), G(((color >> 8) & 0xff) / 255.0f), B(((color >> 16) & 0xff) / 255.0f), A(((color >> 24) & 0xff) / 255.0f) { }
+			: R(ChannelToFloat[(color >> 0) & 0xff]), G(ChannelToFloat[(color >> 8) & 0xff]), B(ChannelToFloat[(color >> 16) & 0xff]), A(ChannelToFloat[(color >> 24) & 0xff]) { }
 		Color(float r, float g, float b, float a) : R(r), G(g), B(b), A(a) { }
 
 		Color operator*(const Color& c) const { return Color(R * c.R, G * c.G, B * c.B, A * c.A); }
@@ -137,6 +195,20 @@ namespace
 		}
 	};
 
+	// A triangle that was sorted into the screen tiles by the tiled rasterizer, together with the clip rectangle of its draw command.
+	struct BinnedTriangle
+	{
+		ImDrawVert Vertices[3];
+		int ClipMinX, ClipMinY, ClipMaxX, ClipMaxY;
+		bool IsSolid;
+	};
+
+	enum class TextureFilter
+	{
+		Nearest,
+		Bilinear
+	};
+
 	struct Device
 	{
 		SDL_Renderer* Renderer;
@@ -168,7 +240,25 @@ namespace
 		LRUCache<UniformColorTriangleKey, std::unique_ptr<TriangleCacheItem>, UniformColorTriangleCacheSize> UniformColorTriangleCache;
 		LRUCache<GenericTriangleKey, std::unique_ptr<TriangleCacheItem>, GenericTriangleCacheSize> GenericTriangleCache;
 
+		// State of the tiled software rasterizer. Only used when it is enabled with ImGui_ImplSDLRenderer_SetTiledRasterization.
+		bool TiledRasterization = false;
+		std::unique_ptr<WorkerPool> Workers;
+		std::vector<uint32_t> Framebuffer;
+		SDL_Texture* FramebufferTexture = nullptr;
+		int FramebufferWidth = 0, FramebufferHeight = 0;
+		int TileColumns = 0, TileRows = 0;
+		std::vector<BinnedTriangle> BinnedTriangles;
+		// For each tile, the indices into BinnedTriangles that touch it, in submission order.
+		std::vector<std::vector<uint32_t>> TileBins;
+
+		ImGui_ImplSDLRenderer_Stats Stats;
+
+		TextureFilter Filter = TextureFilter::Nearest;
+		// Scratch buffer that triangles are rasterized into before they're uploaded to their cache texture.
+		std::vector<uint32_t> TrianglePixels;
+
 		Device(SDL_Renderer* renderer) : Renderer(renderer) { }
+		~Device() { if (FramebufferTexture) SDL_DestroyTexture(FramebufferTexture); }
 
 		void SetClipRect(const ClipRect& rect)
 		{
@@ -180,78 +270,174 @@ namespace
 		void EnableClip() { SetClipRect(Clip); }
 		void DisableClip() { SDL_RenderSetClipRect(Renderer, nullptr); }
 
-		void SetAt(int x, int y, const Color& color)
-		{
-			color.UseAsDrawColor(Renderer);
-			SDL_RenderDrawPoint(Renderer, x, y);
-		}
-
-		SDL_Texture* MakeTexture(int width, int height)
+		SDL_Texture* MakeTexture(int width, int height, const uint32_t* pixels)
 		{
-			SDL_Texture* texture = SDL_CreateTexture(Renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, width, height);
+			SDL_Texture* texture = SDL_CreateTexture(Renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, width, height);
+			Stats.TextureCreations++;
+			SDL_UpdateTexture(texture, nullptr, pixels, width * static_cast<int>(sizeof(uint32_t)));
 			SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
 			return texture;
 		}
-
-		void UseAsRenderTarget(SDL_Texture* texture)
-		{
-			SDL_SetRenderTarget(Renderer, texture);
-			if (texture)
-			{
-				SDL_SetRenderDrawColor(Renderer, 0, 0, 0, 0);
-				SDL_RenderClear(Renderer);
-			}
-		}
 	};
 
 	struct Texture
 	{
-		SDL_Surface* Surface;
-		SDL_Texture* Source;
+		// The CPU side copy of the texture, used for sampling by the triangle renderers. It's either a full RGBA surface,
+		// or an alpha only (A8) atlas with one byte per texel, where the color is implicitly white.
+		SDL_Surface* Surface = nullptr;
+		const unsigned char* Alpha = nullptr;
+		int Width = 0, Height = 0;
+
+		SDL_Texture* Source = nullptr;
 
 		~Texture()
 		{
-			SDL_FreeSurface(Surface);
+			if (Surface) SDL_FreeSurface(Surface);
 			SDL_DestroyTexture(Source);
 		}
 
-		Color Sample(float u, float v) const
+		uint32_t Texel(int x, int y) const
 		{
-			const int x = static_cast<int>(std::round(u * (Surface->w - 1) + 0.5f));
-			const int y = static_cast<int>(std::round(v * (Surface->h - 1) + 0.5f));
+			const int location = y * Width + x;
+			assert(location < Width * Height);
+
+			if (Alpha) return (static_cast<uint32_t>(Alpha[location]) << 24) | 0x00ffffff;
+			return static_cast<const uint32_t*>(Surface->pixels)[location];
+		}
+	};
 
-			const int location = y * Surface->w + x;
-			assert(location < Surface->w * Surface->h);
+	// Reads texels from the CPU copy of a texture. Coordinates are in 16.16 fixed point texel units, so the center of the first texel is at (0.5, 0.5).
+	struct Sampler
+	{
+		const Texture& Source;
+		TextureFilter Filter;
 
-			return Color(static_cast<uint32_t*>(Surface->pixels)[location]);
+		uint32_t Fetch(int32_t u, int32_t v) const
+		{
+			if (Filter == TextureFilter::Nearest)
+			{
+				return Source.Texel(ClampX(u >> 16), ClampY(v >> 16));
+			}
+
+			// Moving back by half a texel puts us at the top left of the 4 texels that we blend between.
+			const int32_t shiftedU = u - 0x8000;
+			const int32_t shiftedV = v - 0x8000;
+			const int x = shiftedU >> 16, y = shiftedV >> 16;
+			const uint32_t weightX = (shiftedU >> 8) & 0xff, weightY = (shiftedV >> 8) & 0xff;
+
+			const int x0 = ClampX(x), x1 = ClampX(x + 1);
+			const int y0 = ClampY(y), y1 = ClampY(y + 1);
+
+			const uint32_t top = Lerp(Source.Texel(x0, y0), Source.Texel(x1, y0), weightX);
+			const uint32_t bottom = Lerp(Source.Texel(x0, y1), Source.Texel(x1, y1), weightX);
+			return Lerp(top, bottom, weightY);
+		}
+
+	private:
+		int ClampX(int x) const { return std::min(std::max(x, 0), Source.Width - 1); }
+		int ClampY(int y) const { return std::min(std::max(y, 0), Source.Height - 1); }
+	};
+
+	// A linear function over the screen, used to interpolate vertex attributes.
+	struct Plane
+	{
+		float Origin, StepX, StepY;
+
+		static Plane Make(float a0, float a1, float a2, const ImVec2& p0, const ImVec2& p1, const ImVec2& p2)
+		{
+			const float area = (p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x);
+			if (area == 0.0f) return Plane{ a0, 0.0f, 0.0f };
+
+			const float stepX = ((a1 - a0) * (p2.y - p0.y) - (a2 - a0) * (p1.y - p0.y)) / area;
+			const float stepY = ((a2 - a0) * (p1.x - p0.x) - (a1 - a0) * (p2.x - p0.x)) / area;
+			return Plane{ a0 - stepX * p0.x - stepY * p0.y, stepX, stepY };
 		}
+
+		float At(float x, float y) const { return Origin + StepX * x + StepY * y; }
 	};
 
-	template <typename T> class InterpolatedFactorEquation
+	// Interpolates the texture coordinates and vertex colors of a triangle, stepping them from pixel to pixel with integer additions.
+	// Texture coordinates are kept in 16.16 fixed point texel units, and colors in 16.16 fixed point channel values.
+	class TriangleShader
 	{
 	public:
-		InterpolatedFactorEquation(const T& value0, const T& value1, const T& value2, const ImVec2& v0, const ImVec2& v1, const ImVec2& v2)
-			: Value0(value0), Value1(value1), Value2(value2), V0(v0), V1(v1), V2(v2),
-			Divisor((V1.y - V2.y) * (V0.x - V2.x) + (V2.x - V1.x) * (V0.y - V2.y)) { }
+		TriangleShader(const Sampler& sampler, const ImDrawVert& v0, const ImDrawVert& v1, const ImDrawVert& v2) : TextureSampler(sampler)
+		{
+			const auto channel = [](const ImDrawVert& v, int shift) { return static_cast<float>((v.col >> shift) & 0xff); };
+			const float width = static_cast<float>(sampler.Source.Width);
+			const float height = static_cast<float>(sampler.Source.Height);
+
+			Planes[0] = Plane::Make(v0.uv.x * width, v1.uv.x * width, v2.uv.x * width, v0.pos, v1.pos, v2.pos);
+			Planes[1] = Plane::Make(v0.uv.y * height, v1.uv.y * height, v2.uv.y * height, v0.pos, v1.pos, v2.pos);
+			for (int i = 0; i < 4; i++)
+			{
+				Planes[2 + i] = Plane::Make(channel(v0, i * 8), channel(v1, i * 8), channel(v2, i * 8), v0.pos, v1.pos, v2.pos);
+			}
+
+			for (std::size_t i = 0; i < Planes.size(); i++) Steps[i] = ToFixed(Planes[i].StepX);
+		}
+
+		// Moves to the center of the given pixel.
+		void BeginRow(int x, int y)
+		{
+			for (std::size_t i = 0; i < Planes.size(); i++) Values[i] = ToFixed(Planes[i].At(x + 0.5f, y + 0.5f));
+		}
 
-		T Evaluate(float x, float y) const
+		uint32_t Shade() const
 		{
-			const float w1 = ((V1.y - V2.y) * (x - V2.x) + (V2.x - V1.x) * (y - V2.y)) / Divisor;
-			const float w2 = ((V2.y - V0.y) * (x - V2.x) + (V0.x - V2.x) * (y - V2.y)) / Divisor;
-			const float w3 = 1.0f - w1 - w2;
+			const uint32_t texel = TextureSampler.Fetch(Values[0], Values[1]);
+			const uint32_t color = ToChannel(Values[2]) | (ToChannel(Values[3]) << 8) | (ToChannel(Values[4]) << 16) | (ToChannel(Values[5]) << 24);
+			return Modulate(texel, color);
+		}
 
-			return static_cast<T>((Value0 * w1) + (Value1 * w2) + (Value2 * w3));
+		void Step()
+		{
+			for (std::size_t i = 0; i < Planes.size(); i++) Values[i] += Steps[i];
 		}
+
 	private:
-		const T Value0;
-		const T Value1;
-		const T Value2;
+		static int32_t ToFixed(float value) { return static_cast<int32_t>(std::lround(value * 65536.0f)); }
+
+		// Colors get extrapolated a bit for pixels on the edges, so they need to be clamped.
+		static uint32_t ToChannel(int32_t value) { return static_cast<uint32_t>(std::min(std::max((value + 0x8000) >> 16, 0), 255)); }
+
+		const Sampler& TextureSampler;
+
+		// Texture U, texture V, and the red, green, blue and alpha channels of the vertex colors.
+		std::array<Plane, 6> Planes;
+		std::array<int32_t, 6> Values{};
+		std::array<int32_t, 6> Steps{};
+	};
+
+	// The shader used for triangles with a single color and no texture.
+	struct SolidShader
+	{
+		uint32_t Color;
 
-		const ImVec2& V0;
-		const ImVec2& V1;
-		const ImVec2& V2;
+		void BeginRow(int, int) { }
+		uint32_t Shade() const { return Color; }
+		void Step() { }
+	};
 
-		const float Divisor;
+	// An edge function of a triangle with vertices in 28.4 fixed point, evaluated at pixel centers. Triangles have to be wound so that their area
+	// is positive. Pixels that lie exactly on an edge only belong to the triangle if it is a top or left edge, so that two triangles sharing
+	// an edge never draw the same pixel twice.
+	struct EdgeFunction
+	{
+		int64_t Value, StepX, StepY;
+
+		EdgeFunction(int64_t ax, int64_t ay, int64_t bx, int64_t by, int startPixelX, int startPixelY)
+		{
+			const int64_t dx = bx - ax;
+			const int64_t dy = by - ay;
+			const bool isTopLeft = dy < 0 || (dy == 0 && dx > 0);
+			const int64_t px = (static_cast<int64_t>(startPixelX) << 4) + 8;
+			const int64_t py = (static_cast<int64_t>(startPixelY) << 4) + 8;
+
+			Value = dx * (py - ay) - dy * (px - ax) + (isTopLeft ? 0 : -1);
+			StepX = -dy * 16;
+			StepY = dx * 16;
+		}
 	};
 
 	struct Rect
@@ -312,74 +498,58 @@ namespace
 		}
 	};
 
-	void DrawTriangleWithColorFunction(const FixedPointTriangleRenderInfo& renderInfo, const std::function<Color(float x, float y)>& colorFunction, Device::TriangleCacheItem* cacheItem)
+	template <typename Shader> void DrawTriangleWithShader(const FixedPointTriangleRenderInfo& renderInfo, Shader& shader, Device::TriangleCacheItem* cacheItem)
 	{
-		// Implementation source: https://web.archive.org/web/20171128164608/http://forum.devmaster.net/t/advanced-rasterization/6145.
-		// This is a fixed point implementation that rounds to top-left.
-
-		const int deltaX12 = renderInfo.X1 - renderInfo.X2;
-		const int deltaX23 = renderInfo.X2 - renderInfo.X3;
-		const int deltaX31 = renderInfo.X3 - renderInfo.X1;
-
-		const int deltaY12 = renderInfo.Y1 - renderInfo.Y2;
-		const int deltaY23 = renderInfo.Y2 - renderInfo.Y3;
-		const int deltaY31 = renderInfo.Y3 - renderInfo.Y1;
-
-		const int fixedDeltaX12 = deltaX12 << 4;
-		const int fixedDeltaX23 = deltaX23 << 4;
-		const int fixedDeltaX31 = deltaX31 << 4;
-
-		const int fixedDeltaY12 = deltaY12 << 4;
-		const int fixedDeltaY23 = deltaY23 << 4;
-		const int fixedDeltaY31 = deltaY31 << 4;
-
 		const int width = renderInfo.MaxX - renderInfo.MinX;
 		const int height = renderInfo.MaxY - renderInfo.MinY;
 		if (width == 0 || height == 0) return;
 
-		int c1 = deltaY12 * renderInfo.X1 - deltaX12 * renderInfo.Y1;
-		int c2 = deltaY23 * renderInfo.X2 - deltaX23 * renderInfo.Y2;
-		int c3 = deltaY31 * renderInfo.X3 - deltaX31 * renderInfo.Y3;
+		int64_t x1 = renderInfo.X1, y1 = renderInfo.Y1;
+		int64_t x2 = renderInfo.X2, y2 = renderInfo.Y2;
+		int64_t x3 = renderInfo.X3, y3 = renderInfo.Y3;
 
-		if (deltaY12 < 0 || (deltaY12 == 0 && deltaX12 > 0)) c1++;
-		if (deltaY23 < 0 || (deltaY23 == 0 && deltaX23 > 0)) c2++;
-		if (deltaY31 < 0 || (deltaY31 == 0 && deltaX31 > 0)) c3++;
+		// The edge functions expect a positive area, so we flip the winding of the triangle when needed.
+		const int64_t area = (x2 - x1) * (y3 - y1) - (y2 - y1) * (x3 - x1);
+		if (area == 0) return;
+		if (area < 0)
+		{
+			std::swap(x2, x3);
+			std::swap(y2, y3);
+		}
 
-		int edgeStart1 = c1 + deltaX12 * (renderInfo.MinY << 4) - deltaY12 * (renderInfo.MinX << 4);
-		int edgeStart2 = c2 + deltaX23 * (renderInfo.MinY << 4) - deltaY23 * (renderInfo.MinX << 4);
-		int edgeStart3 = c3 + deltaX31 * (renderInfo.MinY << 4) - deltaY31 * (renderInfo.MinX << 4);
+		EdgeFunction edge1(x2, y2, x3, y3, renderInfo.MinX, renderInfo.MinY);
+		EdgeFunction edge2(x3, y3, x1, y1, renderInfo.MinX, renderInfo.MinY);
+		EdgeFunction edge3(x1, y1, x2, y2, renderInfo.MinX, renderInfo.MinY);
 
-		SDL_Texture* cache = CurrentDevice->MakeTexture(width, height);
-		CurrentDevice->DisableClip();
-		CurrentDevice->UseAsRenderTarget(cache);
+		// The triangle is rasterized on the CPU and uploaded with a single texture update, with straight alpha just like ImGui gives it to us.
+		std::vector<uint32_t>& pixels = CurrentDevice->TrianglePixels;
+		pixels.assign(static_cast<std::size_t>(width) * height, 0);
 
-		for (int y = renderInfo.MinY; y < renderInfo.MaxY; y++)
+		for (int y = 0; y < height; y++)
 		{
-			int edge1 = edgeStart1;
-			int edge2 = edgeStart2;
-			int edge3 = edgeStart3;
+			int64_t e1 = edge1.Value, e2 = edge2.Value, e3 = edge3.Value;
+			uint32_t* row = pixels.data() + y * width;
+			shader.BeginRow(renderInfo.MinX, renderInfo.MinY + y);
 
-			for (int x = renderInfo.MinX; x < renderInfo.MaxX; x++)
+			for (int x = 0; x < width; x++)
 			{
-				if (edge1 > 0 && edge2 > 0 && edge3 > 0)
+				if ((e1 | e2 | e3) >= 0)
 				{
-					CurrentDevice->SetAt(x - renderInfo.MinX, y - renderInfo.MinY, colorFunction(x + 0.5f, y + 0.5f));
+					row[x] = shader.Shade();
 				}
 
-				edge1 -= fixedDeltaY12;
-				edge2 -= fixedDeltaY23;
-				edge3 -= fixedDeltaY31;
+				e1 += edge1.StepX;
+				e2 += edge2.StepX;
+				e3 += edge3.StepX;
+				shader.Step();
 			}
 
-			edgeStart1 += fixedDeltaX12;
-			edgeStart2 += fixedDeltaX23;
-			edgeStart3 += fixedDeltaX31;
+			edge1.Value += edge1.StepY;
+			edge2.Value += edge2.StepY;
+			edge3.Value += edge3.StepY;
 		}
 
-		CurrentDevice->UseAsRenderTarget(nullptr);
-		CurrentDevice->EnableClip();
-
-		cacheItem->Texture = cache;
+		cacheItem->Texture = CurrentDevice->MakeTexture(width, height, pixels.data());
 		cacheItem->Width = width;
 		cacheItem->Height = height;
 	}
@@ -388,6 +558,7 @@ namespace
 	{
 		const SDL_Rect destination = { renderInfo.MinX, renderInfo.MinY, triangle.Width, triangle.Height };
 		SDL_RenderCopy(CurrentDevice->Renderer, triangle.Texture, nullptr, &destination);
+		CurrentDevice->Stats.DrawCalls++;
 	}
 
 	void DrawTriangle(const ImDrawVert& v1, const ImDrawVert& v2, const ImDrawVert& v3, const Texture* texture)
@@ -404,39 +575,32 @@ namespace
 
 		if (CurrentDevice->GenericTriangleCache.Contains(key))
 		{
+			CurrentDevice->Stats.GenericTriangleCacheHits++;
 			const auto& cached = CurrentDevice->GenericTriangleCache.At(key);
 			DrawCachedTriangle(*cached, renderInfo);
 
 			return;
 		}
 
-		const InterpolatedFactorEquation<float> textureU(v1.uv.x, v2.uv.x, v3.uv.x, v1.pos, v2.pos, v3.pos);
-		const InterpolatedFactorEquation<float> textureV(v1.uv.y, v2.uv.y, v3.uv.y, v1.pos, v2.pos, v3.pos);
+		CurrentDevice->Stats.GenericTriangleCacheMisses++;
 
-		const InterpolatedFactorEquation<Color> shadeColor(Color(v1.col), Color(v2.col), Color(v3.col), v1.pos, v2.pos, v3.pos);
+		const Sampler sampler{ *texture, CurrentDevice->Filter };
+		TriangleShader shader(sampler, v1, v2, v3);
 
 		auto cached = std::make_unique<Device::TriangleCacheItem>();
-		DrawTriangleWithColorFunction(renderInfo, [&](float x, float y) {
-			const float u = textureU.Evaluate(x, y);
-			const float v = textureV.Evaluate(x, y);
-			const Color sampled = texture->Sample(u, v);
-			const Color shade = shadeColor.Evaluate(x, y);
-
-			return sampled * shade;
-		}, cached.get());
+		DrawTriangleWithShader(renderInfo, shader, cached.get());
 
 		if (!cached->Texture) return;
 
 		const SDL_Rect destination = { renderInfo.MinX, renderInfo.MinY, cached->Width, cached->Height };
 		SDL_RenderCopy(CurrentDevice->Renderer, cached->Texture, nullptr, &destination);
+		CurrentDevice->Stats.DrawCalls++;
 
 		CurrentDevice->GenericTriangleCache.Insert(key, std::move(cached));
 	}
 
 	void DrawUniformColorTriangle(const ImDrawVert& v1, const ImDrawVert& v2, const ImDrawVert& v3)
 	{
-		const Color color(v1.col);
-
 		// The naming inconsistency in the parameters is intentional. The fixed point algorithm wants the vertices in a counter clockwise order.
 		const auto& renderInfo = FixedPointTriangleRenderInfo::CalculateFixedPointTriangleInfo(v3.pos, v2.pos, v1.pos);
 
@@ -446,19 +610,25 @@ namespace
 			static_cast<int>(std::round(v3.pos.x)) - renderInfo.MinX, static_cast<int>(std::round(v3.pos.y)) - renderInfo.MinY);
 		if (CurrentDevice->UniformColorTriangleCache.Contains(key))
 		{
+			CurrentDevice->Stats.UniformColorTriangleCacheHits++;
 			const auto& cached = CurrentDevice->UniformColorTriangleCache.At(key);
 			DrawCachedTriangle(*cached, renderInfo);
 
 			return;
 		}
 
+		CurrentDevice->Stats.UniformColorTriangleCacheMisses++;
+
+		SolidShader shader{ v1.col };
+
 		auto cached = std::make_unique<Device::TriangleCacheItem>();
-		DrawTriangleWithColorFunction(renderInfo, [&color](float, float) { return color; }, cached.get());
+		DrawTriangleWithShader(renderInfo, shader, cached.get());
 
 		if (!cached->Texture) return;
 
 		const SDL_Rect destination = { renderInfo.MinX, renderInfo.MinY, cached->Width, cached->Height };
 		SDL_RenderCopy(CurrentDevice->Renderer, cached->Texture, nullptr, &destination);
+		CurrentDevice->Stats.DrawCalls++;
 
 		CurrentDevice->UniformColorTriangleCache.Insert(key, std::move(cached));
 	}
@@ -479,6 +649,7 @@ namespace
 		{
 			color.UseAsDrawColor(CurrentDevice->Renderer);
 			SDL_RenderFillRect(CurrentDevice->Renderer, &destination);
+			CurrentDevice->Stats.DrawCalls++;
 		}
 		else
 		{
@@ -494,13 +665,15 @@ namespace
 			const SDL_RendererFlip flip = static_cast<SDL_RendererFlip>((doHorizontalFlip ? SDL_FLIP_HORIZONTAL : 0) | (doVerticalFlip ? SDL_FLIP_VERTICAL : 0));
 
 			SDL_SetTextureColorMod(texture, static_cast<uint8_t>(color.R * 255), static_cast<uint8_t>(color.G * 255), static_cast<uint8_t>(color.B * 255));
+			SDL_SetTextureAlphaMod(texture, static_cast<uint8_t>(color.A * 255));
 			SDL_RenderCopyEx(CurrentDevice->Renderer, texture, &source, &destination, 0.0, nullptr, flip);
+			CurrentDevice->Stats.DrawCalls++;
 		}
 	}
 
 	void DrawRectangle(const Rect& bounding, const Texture* texture, const Color& color, bool doHorizontalFlip, bool doVerticalFlip)
 	{
-		DrawRectangle(bounding, texture->Source, texture->Surface->w, texture->Surface->h, color, doHorizontalFlip, doVerticalFlip);
+		DrawRectangle(bounding, texture->Source, texture->Width, texture->Height, color, doHorizontalFlip, doVerticalFlip);
 	}
 
 	void DrawRectangle(const Rect& bounding, SDL_Texture* texture, const Color& color, bool doHorizontalFlip, bool doVerticalFlip)
@@ -509,28 +682,569 @@ namespace
 		SDL_QueryTexture(texture, nullptr, nullptr, &width, &height);
 		DrawRectangle(bounding, texture, width, height, color, doHorizontalFlip, doVerticalFlip);
 	}
+
+	// ImFont::RenderText emits every glyph through PrimRectUV: 4 vertices going clockwise from the top left corner, with the indices 0, 1, 2, 0, 2, 3.
+	// Checking for exactly that layout is a lot cheaper than the generic rectangle detection.
+	bool IsGlyphQuad(const ImDrawVert* vertices, const ImDrawIdx* indices)
+	{
+		const unsigned int base = indices[0];
+		if (indices[1] != base + 1 || indices[2] != base + 2 || indices[3] != base || indices[4] != base + 2 || indices[5] != base + 3) return false;
+
+		const ImDrawVert& topLeft = vertices[base + 0];
+		const ImDrawVert& topRight = vertices[base + 1];
+		const ImDrawVert& bottomRight = vertices[base + 2];
+		const ImDrawVert& bottomLeft = vertices[base + 3];
+
+		// Solid rectangles use the same layout, but all of their texture coordinates point at the white pixel, so they are left to the generic path.
+		return topLeft.col == topRight.col && topLeft.col == bottomRight.col && topLeft.col == bottomLeft.col
+			&& topLeft.pos.y == topRight.pos.y && topRight.pos.x == bottomRight.pos.x && bottomRight.pos.y == bottomLeft.pos.y && bottomLeft.pos.x == topLeft.pos.x
+			&& topLeft.uv.y == topRight.uv.y && topRight.uv.x == bottomRight.uv.x && bottomRight.uv.y == bottomLeft.uv.y && bottomLeft.uv.x == topLeft.uv.x
+			&& topLeft.pos.x < bottomRight.pos.x && topLeft.pos.y < bottomRight.pos.y && topLeft.uv.x < bottomRight.uv.x && topLeft.uv.y < bottomRight.uv.y;
+	}
+
+	// Counts how many glyph quads with the same color follow each other, starting at the given indices.
+	unsigned int CountGlyphRun(const ImDrawVert* vertices, const ImDrawIdx* indices, unsigned int indexCount)
+	{
+		unsigned int glyphs = 0;
+		while ((glyphs + 1) * 6 <= indexCount && IsGlyphQuad(vertices, indices + glyphs * 6)
+			&& vertices[indices[glyphs * 6]].col == vertices[indices[0]].col)
+		{
+			glyphs++;
+		}
+		return glyphs;
+	}
+
+	// Draws a run of glyphs as copies out of the font atlas. The color only has to be set once for the whole run, and since nothing else changes
+	// between the copies, SDL can batch them together.
+	void DrawGlyphRun(const ImDrawVert* vertices, const ImDrawIdx* indices, unsigned int glyphCount, const Texture* texture)
+	{
+		const uint32_t color = vertices[indices[0]].col;
+		SDL_SetTextureColorMod(texture->Source, (color >> 0) & 0xff, (color >> 8) & 0xff, (color >> 16) & 0xff);
+		SDL_SetTextureAlphaMod(texture->Source, (color >> 24) & 0xff);
+
+		const float width = static_cast<float>(texture->Width);
+		const float height = static_cast<float>(texture->Height);
+
+		for (unsigned int glyph = 0; glyph < glyphCount; glyph++)
+		{
+			const ImDrawVert& topLeft = vertices[indices[glyph * 6]];
+			const ImDrawVert& bottomRight = vertices[indices[glyph * 6 + 2]];
+
+			// Same rounding as DrawRectangle, so text looks the same no matter which path drew it.
+			const int sourceX = static_cast<int>(topLeft.uv.x * width);
+			const int sourceY = static_cast<int>(topLeft.uv.y * height);
+			const SDL_Rect source = { sourceX, sourceY, static_cast<int>(bottomRight.uv.x * width) - sourceX, static_cast<int>(bottomRight.uv.y * height) - sourceY };
+
+			const int destinationX = static_cast<int>(topLeft.pos.x);
+			const int destinationY = static_cast<int>(topLeft.pos.y);
+			const SDL_Rect destination = { destinationX, destinationY, static_cast<int>(bottomRight.pos.x - topLeft.pos.x), static_cast<int>(bottomRight.pos.y - topLeft.pos.y) };
+
+			SDL_RenderCopy(CurrentDevice->Renderer, texture->Source, &source, &destination);
+		}
+
+		CurrentDevice->Stats.DrawCalls += static_cast<int>(glyphCount);
+		CurrentDevice->Stats.GlyphRuns++;
+		CurrentDevice->Stats.Glyphs += static_cast<int>(glyphCount);
+	}
+
+	void RenderCommandLists(ImDrawData* drawData)
+	{
+		ImGuiIO& io = ImGui::GetIO();
+
+		for (int n = 0; n < drawData->CmdListsCount; n++)
+		{
+			auto commandList = drawData->CmdLists[n];
+
+			for (int cmd_i = 0; cmd_i < commandList->CmdBuffer.Size; cmd_i++)
+			{
+				const ImDrawCmd* drawCommand = &commandList->CmdBuffer[cmd_i];
+
+				// Indices are relative to the command's vertex offset, which ImGui moves forward when a list outgrows 16-bit indices.
+				// ImDrawIdx can also be 32-bit (see imconfig.h), the walking below works the same with either width.
+				const ImDrawVert* vertexBuffer = commandList->VtxBuffer.Data + drawCommand->VtxOffset;
+				const ImDrawIdx* indexBuffer = commandList->IdxBuffer.Data + drawCommand->IdxOffset;
+
+				const Device::ClipRect clipRect = {
+						static_cast<int>(drawCommand->ClipRect.x),
+						static_cast<int>(drawCommand->ClipRect.y),
+						static_cast<int>(drawCommand->ClipRect.z - drawCommand->ClipRect.x),
+						static_cast<int>(drawCommand->ClipRect.w - drawCommand->ClipRect.y)
+				};
+				CurrentDevice->SetClipRect(clipRect);
+
+				if (drawCommand->UserCallback)
+				{
+					drawCommand->UserCallback(commandList, drawCommand);
+				}
+				else
+				{
+					const bool isWrappedTexture = drawCommand->TextureId == io.Fonts->TexID;
+
+					// Loops over triangles.
+					for (unsigned int i = 0; i + 3 <= drawCommand->ElemCount; i += 3)
+					{
+						// Text is most of what gets drawn, so runs of glyphs are picked out before anything else.
+						if (isWrappedTexture)
+						{
+							const unsigned int glyphCount = CountGlyphRun(vertexBuffer, indexBuffer + i, drawCommand->ElemCount - i);
+							if (glyphCount > 0)
+							{
+								DrawGlyphRun(vertexBuffer, indexBuffer + i, glyphCount, static_cast<const Texture*>(drawCommand->TextureId));
+
+								i += glyphCount * 6 - 3;  // The loop itself adds the last 3.
+								continue;
+							}
+						}
+
+						const ImDrawVert& v0 = vertexBuffer[indexBuffer[i + 0]];
+						const ImDrawVert& v1 = vertexBuffer[indexBuffer[i + 1]];
+						const ImDrawVert& v2 = vertexBuffer[indexBuffer[i + 2]];
+
+						const Rect& bounding = Rect::CalculateBoundingBox(v0, v1, v2);
+
+						const bool isTriangleUniformColor = v0.col == v1.col && v1.col == v2.col;
+						const bool doesTriangleUseOnlyColor = bounding.UsesOnlyColor();
+
+						// Actually, since we render a whole bunch of rectangles, we try to first detect those, and render them more efficiently.
+						// How are rectangles detected? It's actually pretty simple: If all 6 vertices lie on the extremes of the bounding box,
+						// it's a rectangle.
+						if (i + 6 <= drawCommand->ElemCount)
+						{
+							const ImDrawVert& v3 = vertexBuffer[indexBuffer[i + 3]];
+							const ImDrawVert& v4 = vertexBuffer[indexBuffer[i + 4]];
+							const ImDrawVert& v5 = vertexBuffer[indexBuffer[i + 5]];
+
+							const bool isUniformColor = isTriangleUniformColor && v2.col == v3.col && v3.col == v4.col && v4.col == v5.col;
+
+							if (isUniformColor
+							&& bounding.IsOnExtreme(v0.pos)
+							&& bounding.IsOnExtreme(v1.pos)
+							&& bounding.IsOnExtreme(v2.pos)
+							&& bounding.IsOnExtreme(v3.pos)
+							&& bounding.IsOnExtreme(v4.pos)
+							&& bounding.IsOnExtreme(v5.pos))
+							{
+								// ImGui gives the triangles in a nice order: the first vertex happens to be the topleft corner of our rectangle.
+								// We need to check for the orientation of the texture, as I believe in theory ImGui could feed us a flipped texture,
+								// so that the larger texture coordinates are at topleft instead of bottomright.
+								// We don't consider equal texture coordinates to require a flip, as then the rectangle is mostlikely simply a colored rectangle.
+								const bool doHorizontalFlip = v2.uv.x < v0.uv.x;
+								const bool doVerticalFlip = v2.uv.x < v0.uv.x;
+
+								if (isWrappedTexture)
+								{
+									DrawRectangle(bounding, static_cast<const Texture*>(drawCommand->TextureId), Color(v0.col), doHorizontalFlip, doVerticalFlip);
+								}
+								else
+								{
+									DrawRectangle(bounding, static_cast<SDL_Texture*>(drawCommand->TextureId), Color(v0.col), doHorizontalFlip, doVerticalFlip);
+								}
+
+								i += 3;  // Additional increment to account for the extra 3 vertices we consumed.
+								continue;
+							}
+						}
+
+						if (isTriangleUniformColor && doesTriangleUseOnlyColor)
+						{
+							DrawUniformColorTriangle(v0, v1, v2);
+						}
+						else
+						{
+							// Currently we assume that any non rectangular texture samples the font texture. Dunno if that's what actually happens, but it seems to work.
+							assert(isWrappedTexture);
+							DrawTriangle(v0, v1, v2, static_cast<const Texture*>(drawCommand->TextureId));
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// The tiled rasterizer renders the whole frame on the CPU. All triangles are first sorted (binned) into the screen tiles they touch, keeping
+	// the submission order, and then the tiles are rasterized in parallel into a framebuffer that gets uploaded as a single texture.
+	// Since every tile is rasterized by only one thread in submission order, blending still happens in the order ImGui intended.
+	namespace Tiled
+	{
+		static constexpr int TileSize = 64;
+
+		// The tile buffers hold premultiplied colors, so that blending over a transparent background stays correct.
+		inline uint32_t BlendPremultiplied(uint32_t destination, uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+		{
+			const uint32_t inverse = 255 - a;
+
+			return	((r + MultiplyChannel((destination >> 0) & 0xff, inverse)) << 0)
+				  | ((g + MultiplyChannel((destination >> 8) & 0xff, inverse)) << 8)
+				  | ((b + MultiplyChannel((destination >> 16) & 0xff, inverse)) << 16)
+				  | ((a + MultiplyChannel((destination >> 24) & 0xff, inverse)) << 24);
+		}
+
+		// Converts a premultiplied color back to straight alpha, which is what SDL_BLENDMODE_BLEND expects.
+		inline uint32_t Unpremultiply(uint32_t color)
+		{
+			// Reciprocals of the alpha values in 16.16 fixed point, scaled by 255.
+			static const std::array<uint32_t, 256> reciprocals = [] {
+				std::array<uint32_t, 256> table{};
+				for (uint32_t alpha = 1; alpha < 256; alpha++) table[alpha] = (255u << 16) / alpha;
+				return table;
+			}();
+
+			const uint32_t a = color >> 24;
+			if (a == 255 || a == 0) return a == 0 ? 0 : color;
+
+			const uint32_t reciprocal = reciprocals[a];
+			const uint32_t r = std::min(255u, (((color >> 0) & 0xff) * reciprocal + 0x8000) >> 16);
+			const uint32_t g = std::min(255u, (((color >> 8) & 0xff) * reciprocal + 0x8000) >> 16);
+			const uint32_t b = std::min(255u, (((color >> 16) & 0xff) * reciprocal + 0x8000) >> 16);
+
+			return r | (g << 8) | (b << 16) | (a << 24);
+		}
+
+		void RasterizeTriangle(const BinnedTriangle& triangle, const Sampler& sampler, uint32_t* tile, int tileX, int tileY, int tileWidth, int tileHeight)
+		{
+			const ImDrawVert* v0 = &triangle.Vertices[0];
+			const ImDrawVert* v1 = &triangle.Vertices[1];
+			const ImDrawVert* v2 = &triangle.Vertices[2];
+
+			// Vertex positions in 28.4 fixed point, same as the cached triangle renderer.
+			int64_t x0 = std::llround(v0->pos.x * 16.0f), y0 = std::llround(v0->pos.y * 16.0f);
+			int64_t x1 = std::llround(v1->pos.x * 16.0f), y1 = std::llround(v1->pos.y * 16.0f);
+			int64_t x2 = std::llround(v2->pos.x * 16.0f), y2 = std::llround(v2->pos.y * 16.0f);
+
+			// The edge functions below expect a positive area, so we flip the winding of the triangle when needed.
+			int64_t area = (x1 - x0) * (y2 - y0) - (y1 - y0) * (x2 - x0);
+			if (area == 0) return;
+			if (area < 0)
+			{
+				std::swap(v1, v2);
+				std::swap(x1, x2);
+				std::swap(y1, y2);
+			}
+
+			const int minX = std::max({ static_cast<int>(std::floor(std::min({ v0->pos.x, v1->pos.x, v2->pos.x }))), triangle.ClipMinX, tileX });
+			const int minY = std::max({ static_cast<int>(std::floor(std::min({ v0->pos.y, v1->pos.y, v2->pos.y }))), triangle.ClipMinY, tileY });
+			const int maxX = std::min({ static_cast<int>(std::ceil(std::max({ v0->pos.x, v1->pos.x, v2->pos.x }))), triangle.ClipMaxX, tileX + tileWidth });
+			const int maxY = std::min({ static_cast<int>(std::ceil(std::max({ v0->pos.y, v1->pos.y, v2->pos.y }))), triangle.ClipMaxY, tileY + tileHeight });
+			if (minX >= maxX || minY >= maxY) return;
+
+			EdgeFunction edge0(x1, y1, x2, y2, minX, minY);
+			EdgeFunction edge1(x2, y2, x0, y0, minX, minY);
+			EdgeFunction edge2(x0, y0, x1, y1, minX, minY);
+
+			if (triangle.IsSolid)
+			{
+				const uint32_t color = v0->col;
+				const uint32_t a = color >> 24;
+				if (a == 0) return;
+
+				const uint32_t r = MultiplyChannel((color >> 0) & 0xff, a);
+				const uint32_t g = MultiplyChannel((color >> 8) & 0xff, a);
+				const uint32_t b = MultiplyChannel((color >> 16) & 0xff, a);
+
+				for (int y = minY; y < maxY; y++)
+				{
+					int64_t e0 = edge0.Value, e1 = edge1.Value, e2 = edge2.Value;
+					uint32_t* row = tile + (y - tileY) * TileSize - tileX;
+
+					for (int x = minX; x < maxX; x++)
+					{
+						if ((e0 | e1 | e2) >= 0)
+						{
+							row[x] = a == 255 ? color : BlendPremultiplied(row[x], r, g, b, a);
+						}
+
+						e0 += edge0.StepX;
+						e1 += edge1.StepX;
+						e2 += edge2.StepX;
+					}
+
+					edge0.Value += edge0.StepY;
+					edge1.Value += edge1.StepY;
+					edge2.Value += edge2.StepY;
+				}
+
+				return;
+			}
+
+			TriangleShader shader(sampler, *v0, *v1, *v2);
+
+			for (int y = minY; y < maxY; y++)
+			{
+				int64_t e0 = edge0.Value, e1 = edge1.Value, e2 = edge2.Value;
+				uint32_t* row = tile + (y - tileY) * TileSize - tileX;
+				shader.BeginRow(minX, y);
+
+				for (int x = minX; x < maxX; x++)
+				{
+					if ((e0 | e1 | e2) >= 0)
+					{
+						const uint32_t color = shader.Shade();
+						const uint32_t a = color >> 24;
+						if (a != 0)
+						{
+							const uint32_t r = MultiplyChannel((color >> 0) & 0xff, a);
+							const uint32_t g = MultiplyChannel((color >> 8) & 0xff, a);
+							const uint32_t b = MultiplyChannel((color >> 16) & 0xff, a);
+							row[x] = BlendPremultiplied(row[x], r, g, b, a);
+						}
+					}
+
+					e0 += edge0.StepX;
+					e1 += edge1.StepX;
+					e2 += edge2.StepX;
+					shader.Step();
+				}
+
+				edge0.Value += edge0.StepY;
+				edge1.Value += edge1.StepY;
+				edge2.Value += edge2.StepY;
+			}
+		}
+
+		void RasterizeTile(int tileIndex, const Texture* texture)
+		{
+			Device& device = *CurrentDevice;
+
+			const int tileX = (tileIndex % device.TileColumns) * TileSize;
+			const int tileY = (tileIndex / device.TileColumns) * TileSize;
+			const int tileWidth = std::min(TileSize, device.FramebufferWidth - tileX);
+			const int tileHeight = std::min(TileSize, device.FramebufferHeight - tileY);
+
+			uint32_t* output = device.Framebuffer.data() + tileY * device.FramebufferWidth + tileX;
+
+			const auto& bin = device.TileBins[tileIndex];
+			if (bin.empty())
+			{
+				for (int y = 0; y < tileHeight; y++) std::fill_n(output + y * device.FramebufferWidth, tileWidth, 0u);
+				return;
+			}
+
+			const Sampler sampler{ *texture, device.Filter };
+			uint32_t tile[TileSize * TileSize] = {};
+			for (const uint32_t triangle : bin)
+			{
+				RasterizeTriangle(device.BinnedTriangles[triangle], sampler, tile, tileX, tileY, tileWidth, tileHeight);
+			}
+
+			for (int y = 0; y < tileHeight; y++)
+			{
+				for (int x = 0; x < tileWidth; x++)
+				{
+					output[y * device.FramebufferWidth + x] = Unpremultiply(tile[y * TileSize + x]);
+				}
+			}
+		}
+
+		bool CanRasterize(ImDrawData* drawData)
+		{
+			// The CPU rasterizer can only read textures that we have a surface for, which is just the font atlas.
+			// Anything else (user textures or callbacks) makes us fall back to the regular path for the whole frame.
+			const ImTextureID fontTexture = ImGui::GetIO().Fonts->TexID;
+
+			for (int n = 0; n < drawData->CmdListsCount; n++)
+			{
+				const ImDrawList* commandList = drawData->CmdLists[n];
+				for (int cmd_i = 0; cmd_i < commandList->CmdBuffer.Size; cmd_i++)
+				{
+					const ImDrawCmd& drawCommand = commandList->CmdBuffer[cmd_i];
+					if (drawCommand.UserCallback || drawCommand.TextureId != fontTexture) return false;
+				}
+			}
+
+			return true;
+		}
+
+		void Bin(ImDrawData* drawData)
+		{
+			Device& device = *CurrentDevice;
+
+			device.BinnedTriangles.clear();
+			for (auto& bin : device.TileBins) bin.clear();
+
+			for (int n = 0; n < drawData->CmdListsCount; n++)
+			{
+				const ImDrawList* commandList = drawData->CmdLists[n];
+
+				for (int cmd_i = 0; cmd_i < commandList->CmdBuffer.Size; cmd_i++)
+				{
+					const ImDrawCmd& drawCommand = commandList->CmdBuffer[cmd_i];
+					const ImDrawVert* vertexBuffer = commandList->VtxBuffer.Data + drawCommand.VtxOffset;
+					const ImDrawIdx* indexBuffer = commandList->IdxBuffer.Data + drawCommand.IdxOffset;
+
+					const int clipMinX = std::max(static_cast<int>(drawCommand.ClipRect.x), 0);
+					const int clipMinY = std::max(static_cast<int>(drawCommand.ClipRect.y), 0);
+					const int clipMaxX = std::min(static_cast<int>(drawCommand.ClipRect.z), device.FramebufferWidth);
+					const int clipMaxY = std::min(static_cast<int>(drawCommand.ClipRect.w), device.FramebufferHeight);
+
+					if (clipMinX < clipMaxX && clipMinY < clipMaxY)
+					{
+						for (unsigned int i = 0; i + 3 <= drawCommand.ElemCount; i += 3)
+						{
+							const ImDrawVert& v0 = vertexBuffer[indexBuffer[i + 0]];
+							const ImDrawVert& v1 = vertexBuffer[indexBuffer[i + 1]];
+							const ImDrawVert& v2 = vertexBuffer[indexBuffer[i + 2]];
+
+							const Rect& bounding = Rect::CalculateBoundingBox(v0, v1, v2);
+
+							const int minX = std::max(static_cast<int>(std::floor(bounding.MinX)), clipMinX);
+							const int minY = std::max(static_cast<int>(std::floor(bounding.MinY)), clipMinY);
+							const int maxX = std::min(static_cast<int>(std::ceil(bounding.MaxX)), clipMaxX);
+							const int maxY = std::min(static_cast<int>(std::ceil(bounding.MaxY)), clipMaxY);
+							if (minX >= maxX || minY >= maxY) continue;
+
+							const uint32_t index = static_cast<uint32_t>(device.BinnedTriangles.size());
+							device.BinnedTriangles.push_back(BinnedTriangle{
+								{ v0, v1, v2 },
+								clipMinX, clipMinY, clipMaxX, clipMaxY,
+								v0.col == v1.col && v1.col == v2.col && bounding.UsesOnlyColor()
+							});
+
+							for (int tileY = minY / TileSize; tileY <= (maxY - 1) / TileSize; tileY++)
+							{
+								for (int tileX = minX / TileSize; tileX <= (maxX - 1) / TileSize; tileX++)
+								{
+									device.TileBins[tileY * device.TileColumns + tileX].push_back(index);
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+
+		void Render(ImDrawData* drawData)
+		{
+			Device& device = *CurrentDevice;
+
+			int width, height;
+			SDL_GetRendererOutputSize(device.Renderer, &width, &height);
+			if (width <= 0 || height <= 0) return;
+
+			if (!device.FramebufferTexture || width != device.FramebufferWidth || height != device.FramebufferHeight)
+			{
+				if (device.FramebufferTexture) SDL_DestroyTexture(device.FramebufferTexture);
+
+				device.FramebufferTexture = SDL_CreateTexture(device.Renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING, width, height);
+				device.Stats.TextureCreations++;
+				SDL_SetTextureBlendMode(device.FramebufferTexture, SDL_BLENDMODE_BLEND);
+
+				device.FramebufferWidth = width;
+				device.FramebufferHeight = height;
+				device.Framebuffer.assign(static_cast<std::size_t>(width) * height, 0);
+				device.TileColumns = (width + TileSize - 1) / TileSize;
+				device.TileRows = (height + TileSize - 1) / TileSize;
+				device.TileBins.assign(static_cast<std::size_t>(device.TileColumns) * device.TileRows, {});
+			}
+
+			Bin(drawData);
+
+			const Texture* texture = static_cast<const Texture*>(ImGui::GetIO().Fonts->TexID);
+			device.Workers->parallelFor(static_cast<int>(device.TileBins.size()), [texture](int tile) { RasterizeTile(tile, texture); });
+
+			SDL_UpdateTexture(device.FramebufferTexture, nullptr, device.Framebuffer.data(), width * static_cast<int>(sizeof(uint32_t)));
+
+			device.DisableClip();
+			SDL_RenderCopy(device.Renderer, device.FramebufferTexture, nullptr, nullptr);
+			device.Stats.DrawCalls++;
+		}
+	}
+
+	// (Re)creates the SDL texture and the CPU side copy of the font atlas from the atlas pixels.
+	void LoadFontsTexture(SDL_Renderer* renderer, Texture* texture, bool alphaOnly)
+	{
+		ImGuiIO& io = ImGui::GetIO();
+		unsigned char* pixels;
+		int width, height;
+
+		if (texture->Surface) SDL_FreeSurface(texture->Surface);
+		if (texture->Source) SDL_DestroyTexture(texture->Source);
+		texture->Surface = nullptr;
+		texture->Alpha = nullptr;
+
+		if (alphaOnly)
+		{
+			// We keep sampling straight from the A8 atlas ImGui built, and only expand it to RGBA in a temporary buffer for the upload.
+			io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+
+			std::vector<uint32_t> expanded(static_cast<std::size_t>(width) * height);
+			for (std::size_t i = 0; i < expanded.size(); i++) expanded[i] = (static_cast<uint32_t>(pixels[i]) << 24) | 0x00ffffff;
+
+			texture->Alpha = pixels;
+			texture->Source = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, width, height);
+			SDL_UpdateTexture(texture->Source, nullptr, expanded.data(), width * static_cast<int>(sizeof(uint32_t)));
+			SDL_SetTextureBlendMode(texture->Source, SDL_BLENDMODE_BLEND);
+		}
+		else
+		{
+			io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+			static constexpr uint32_t rmask = 0x000000ff, gmask = 0x0000ff00, bmask = 0x00ff0000, amask = 0xff000000;
+			SDL_Surface* surface = SDL_CreateRGBSurfaceFrom(pixels, width, height, 32, 4 * width, rmask, gmask, bmask, amask);
+
+			texture->Surface = surface;
+			texture->Source = SDL_CreateTextureFromSurface(renderer, surface);
+		}
+
+		texture->Width = width;
+		texture->Height = height;
+	}
+
+	// With ImFontAtlasFlags_DynamicGlyphs, glyphs are rasterized into the atlas pixels while the frame is built. The CPU side copy already
+	// points to them, so only the SDL texture needs the new texels: the dirty rectangle, or everything when the atlas grew (which reallocates its pixels).
+	void UpdateFontsTexture()
+	{
+		ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+		Texture* texture = static_cast<Texture*>(atlas->TexID);
+		if (!texture || !atlas->IsTexDirty()) return;
+
+		if (atlas->TexWidth != texture->Width || atlas->TexHeight != texture->Height)
+		{
+			LoadFontsTexture(CurrentDevice->Renderer, texture, texture->Alpha != nullptr);
+			CurrentDevice->Stats.TextureCreations++;
+			// The texture coordinates of the atlas changed, so nothing that was cached with the old ones can be hit again.
+			CurrentDevice->GenericTriangleCache.Clear();
+		}
+		else
+		{
+			const SDL_Rect rect = { atlas->TexDirtyX0, atlas->TexDirtyY0, atlas->TexDirtyX1 - atlas->TexDirtyX0, atlas->TexDirtyY1 - atlas->TexDirtyY0 };
+			std::vector<uint32_t> texels(static_cast<std::size_t>(rect.w) * rect.h);
+			if (texture->Alpha)
+			{
+				for (int y = 0; y < rect.h; y++)
+				{
+					const unsigned char* source = texture->Alpha + (rect.y + y) * texture->Width + rect.x;
+					for (int x = 0; x < rect.w; x++) texels[static_cast<std::size_t>(y) * rect.w + x] = (static_cast<uint32_t>(source[x]) << 24) | 0x00ffffff;
+				}
+			}
+			else
+			{
+				// SDL_CreateTextureFromSurface may have picked another format than the surface's.
+				Uint32 format;
+				SDL_QueryTexture(texture->Source, &format, nullptr, nullptr, nullptr);
+				const uint32_t* source = static_cast<const uint32_t*>(texture->Surface->pixels) + rect.y * texture->Width + rect.x;
+				SDL_ConvertPixels(rect.w, rect.h, SDL_PIXELFORMAT_RGBA32, source, texture->Width * static_cast<int>(sizeof(uint32_t)), format, texels.data(), rect.w * static_cast<int>(sizeof(uint32_t)));
+			}
+			SDL_UpdateTexture(texture->Source, &rect, texels.data(), rect.w * static_cast<int>(sizeof(uint32_t)));
+		}
+		atlas->ClearTexDirty();
+	}
 }
 
 
-void ImGui_ImplSDLRenderer_Init(SDL_Renderer* renderer)
+void ImGui_ImplSDLRenderer_Init(SDL_Renderer* renderer, bool alphaOnlyFontAtlas)
 {
 	ImGuiIO& io = ImGui::GetIO();
+	io.BackendRendererName = "imgui_impl_sdl_renderer";
+	io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;  // We can honor the ImDrawCmd::VtxOffset field, allowing for large meshes.
 
 	ImGui::GetStyle().WindowRounding = 0.0f;
 	ImGui::GetStyle().AntiAliasedFill = false;
 	ImGui::GetStyle().AntiAliasedLines = false;
 
 	// Loads the font texture.
-	unsigned char* pixels;
-	int width, height;
-	io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
-	static constexpr uint32_t rmask = 0x000000ff, gmask = 0x0000ff00, bmask = 0x00ff0000, amask = 0xff000000;
-	SDL_Surface* surface = SDL_CreateRGBSurfaceFrom(pixels, width, height, 32, 4 * width, rmask, gmask, bmask, amask);
-
 	Texture* texture = new Texture();
-	texture->Surface = surface;
-	texture->Source = SDL_CreateTextureFromSurface(renderer, surface);
+	LoadFontsTexture(renderer, texture, alphaOnlyFontAtlas);
 	io.Fonts->TexID = (void*)texture;
+	io.Fonts->ClearTexDirty();
 
 	CurrentDevice = new Device(renderer);
 }
@@ -545,6 +1259,32 @@ void ImGui_ImplSDLRenderer_Shutdown()
 	delete CurrentDevice;
 }
 
+void ImGui_ImplSDLRenderer_SetTiledRasterization(bool enabled, int threadCount)
+{
+	CurrentDevice->TiledRasterization = enabled;
+	CurrentDevice->Workers = enabled ? std::make_unique<WorkerPool>(threadCount) : nullptr;
+}
+
+void ImGui_ImplSDLRenderer_SetTextureFilter(bool bilinear)
+{
+	const TextureFilter filter = bilinear ? TextureFilter::Bilinear : TextureFilter::Nearest;
+	if (CurrentDevice->Filter == filter) return;
+
+	CurrentDevice->Filter = filter;
+	// Cached textured triangles were sampled with the previous filter. Solid triangles don't sample anything, so they can stay.
+	CurrentDevice->GenericTriangleCache.Clear();
+}
+
+ImGui_ImplSDLRenderer_Stats ImGui_ImplSDLRenderer_GetStats()
+{
+	return CurrentDevice->Stats;
+}
+
+void ImGui_ImplSDLRenderer_ResetStats()
+{
+	CurrentDevice->Stats = ImGui_ImplSDLRenderer_Stats();
+}
+
 void ImGui_ImplSDLRenderer_RenderDrawData(ImDrawData* drawData)
 {
 	SDL_BlendMode blendMode;
@@ -560,101 +1300,15 @@ void ImGui_ImplSDLRenderer_RenderDrawData(ImDrawData* drawData)
 
 	SDL_Texture* initialRenderTarget = SDL_GetRenderTarget(CurrentDevice->Renderer);
 
-	ImGuiIO& io = ImGui::GetIO();
+	UpdateFontsTexture();
 
-	for (int n = 0; n < drawData->CmdListsCount; n++)
+	if (CurrentDevice->TiledRasterization && Tiled::CanRasterize(drawData))
 	{
-		auto commandList = drawData->CmdLists[n];
-		auto vertexBuffer = commandList->VtxBuffer;
-		auto indexBuffer = commandList->IdxBuffer.Data;
-
-		for (int cmd_i = 0; cmd_i < commandList->CmdBuffer.Size; cmd_i++)
-		{
-			const ImDrawCmd* drawCommand = &commandList->CmdBuffer[cmd_i];
-
-			const Device::ClipRect clipRect = {
-					static_cast<int>(drawCommand->ClipRect.x),
-					static_cast<int>(drawCommand->ClipRect.y),
-					static_cast<int>(drawCommand->ClipRect.z - drawCommand->ClipRect.x),
-					static_cast<int>(drawCommand->ClipRect.w - drawCommand->ClipRect.y)
-			};
-			CurrentDevice->SetClipRect(clipRect);
-
-			if (drawCommand->UserCallback)
-			{
-				drawCommand->UserCallback(commandList, drawCommand);
-			}
-			else
-			{
-				const bool isWrappedTexture = drawCommand->TextureId == io.Fonts->TexID;
-
-				// Loops over triangles.
-				for (unsigned int i = 0; i + 3 <= drawCommand->ElemCount; i += 3)
-				{
-					const ImDrawVert& v0 = vertexBuffer[indexBuffer[i + 0]];
-					const ImDrawVert& v1 = vertexBuffer[indexBuffer[i + 1]];
-					const ImDrawVert& v2 = vertexBuffer[indexBuffer[i + 2]];
-
-					const Rect& bounding = Rect::CalculateBoundingBox(v0, v1, v2);
-
-					const bool isTriangleUniformColor = v0.col == v1.col && v1.col == v2.col;
-					const bool doesTriangleUseOnlyColor = bounding.UsesOnlyColor();
-
-					// Actually, since we render a whole bunch of rectangles, we try to first detect those, and render them more efficiently.
-					// How are rectangles detected? It's actually pretty simple: If all 6 vertices lie on the extremes of the bounding box,
-					// it's a rectangle.
-					if (i + 6 <= drawCommand->ElemCount)
-					{
-						const ImDrawVert& v3 = vertexBuffer[indexBuffer[i + 3]];
-						const ImDrawVert& v4 = vertexBuffer[indexBuffer[i + 4]];
-						const ImDrawVert& v5 = vertexBuffer[indexBuffer[i + 5]];
-
-						const bool isUniformColor = isTriangleUniformColor && v2.col == v3.col && v3.col == v4.col && v4.col == v5.col;
-
-						if (isUniformColor
-						&& bounding.IsOnExtreme(v0.pos)
-						&& bounding.IsOnExtreme(v1.pos)
-						&& bounding.IsOnExtreme(v2.pos)
-						&& bounding.IsOnExtreme(v3.pos)
-						&& bounding.IsOnExtreme(v4.pos)
-						&& bounding.IsOnExtreme(v5.pos))
-						{
-							// ImGui gives the triangles in a nice order: the first vertex happens to be the topleft corner of our rectangle.
-							// We need to check for the orientation of the texture, as I believe in theory ImGui could feed us a flipped texture,
-							// so that the larger texture coordinates are at topleft instead of bottomright.
-							// We don't consider equal texture coordinates to require a flip, as then the rectangle is mostlikely simply a colored rectangle.
-							const bool doHorizontalFlip = v2.uv.x < v0.uv.x;
-							const bool doVerticalFlip = v2.uv.x < v0.uv.x;
-
-							if (isWrappedTexture)
-							{
-								DrawRectangle(bounding, static_cast<const Texture*>(drawCommand->TextureId), Color(v0.col), doHorizontalFlip, doVerticalFlip);
-							}
-							else
-							{
-								DrawRectangle(bounding, static_cast<SDL_Texture*>(drawCommand->TextureId), Color(v0.col), doHorizontalFlip, doVerticalFlip);
-							}
-
-							i += 3;  // Additional increment to account for the extra 3 vertices we consumed.
-							continue;
-						}
-					}
-
-					if (isTriangleUniformColor && doesTriangleUseOnlyColor)
-					{
-						DrawUniformColorTriangle(v0, v1, v2);
-					}
-					else
-					{
-						// Currently we assume that any non rectangular texture samples the font texture. Dunno if that's what actually happens, but it seems to work.
-						assert(isWrappedTexture);
-						DrawTriangle(v0, v1, v2, static_cast<const Texture*>(drawCommand->TextureId));
-					}
-				}
-			}
-
-			indexBuffer += drawCommand->ElemCount;
-		}
+		Tiled::Render(drawData);
+	}
+	else
+	{
+		RenderCommandLists(drawData);
 	}
 
 	CurrentDevice->DisableClip();
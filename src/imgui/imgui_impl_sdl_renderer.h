@@ -3,8 +3,8 @@
 
 // Implemented features:
 //  [X] Renderer: User texture binding. Use 'SDL_Texture *' SDL_Renderer texture identifier as void*/ImTextureID. Read the imgui FAQ about ImTextureID! (https://github.com/ocornut/imgui/blob/master/docs/FAQ.md#q-how-can-i-display-an-image-what-is-imtextureid-how-does-it-work)
-// Missing features:
-//  [ ] Renderer: Support for large meshes (64k+ vertices) with 16-bit indices.
+//  [X] Renderer: Support for large meshes (64k+ vertices) with 16-bit indices.
+//  [X] Renderer: 32-bit indices (#define ImDrawIdx unsigned int in imconfig.h).
 
 #pragma once
 //INCLUDES. (you can change these if need be)
@@ -16,11 +16,38 @@ struct SDL_Renderer;
 
 
 // Call this to initialize the SDL renderer device that is internally used by the renderer.
-IMGUI_IMPL_API void ImGui_ImplSDLRenderer_Init(SDL_Renderer* renderer);
+// With alphaOnlyFontAtlas, the font atlas is kept in memory as one byte per texel (GetTexDataAsAlpha8) instead of RGBA, which needs 4x less memory
+// and is faster to sample. Only use it if you don't add colored custom glyphs to the atlas, as those would turn white.
+IMGUI_IMPL_API void ImGui_ImplSDLRenderer_Init(SDL_Renderer* renderer, bool alphaOnlyFontAtlas = false);
 // Call this before destroying your SDL renderer or ImGui to ensure that proper cleanup is done. This doesn't do anything critically important though,
 // so if you're fine with small memory leaks at the end of your application, you can even omit this.
 IMGUI_IMPL_API void ImGui_ImplSDLRenderer_Shutdown();
 
+// Switches between drawing through SDL_Renderer calls (the default) and the tiled software rasterizer. The tiled rasterizer renders the whole frame
+// on the CPU, split into screen tiles that are rasterized in parallel, and then uploads it as a single texture. This is meant for machines without a GPU,
+// where SDL falls back to its software renderer. A thread count of 0 uses one thread per logical CPU.
+IMGUI_IMPL_API void ImGui_ImplSDLRenderer_SetTiledRasterization(bool enabled, int threadCount = 0);
+
+// Chooses how the font atlas is sampled by triangles that are rasterized in software: nearest texel (the default) or bilinear filtering,
+// which gives smoother text when glyphs end up at fractional positions or scales.
+IMGUI_IMPL_API void ImGui_ImplSDLRenderer_SetTextureFilter(bool bilinear);
+
+// Counters of the work done by the renderer, for comparing optimizations of the backend. They keep adding up until they are reset.
+struct ImGui_ImplSDLRenderer_Stats
+{
+	int DrawCalls = 0;							// SDL_Render* calls that draw something (copies, fills, points and clears).
+	int UniformColorTriangleCacheHits = 0;
+	int UniformColorTriangleCacheMisses = 0;
+	int GenericTriangleCacheHits = 0;
+	int GenericTriangleCacheMisses = 0;
+	int TextureCreations = 0;
+	int GlyphRuns = 0;							// Runs of same colored glyphs drawn as a batch of font atlas copies.
+	int Glyphs = 0;
+};
+
+IMGUI_IMPL_API ImGui_ImplSDLRenderer_Stats ImGui_ImplSDLRenderer_GetStats();
+IMGUI_IMPL_API void ImGui_ImplSDLRenderer_ResetStats();
+
 // Call this every frame after ImGui::Render with ImGui::GetDrawData(). This will use the SDL_Renderer provided to the interfrace with Initialize
 // to draw the contents of the draw data to the screen.
 IMGUI_IMPL_API void ImGui_ImplSDLRenderer_RenderDrawData(ImDrawData* drawData);
@@ -51,6 +51,15 @@ Index of this file:
 #include <math.h>       // sqrtf, fabsf, fmodf, powf, floorf, ceilf, cosf, sinf
 #include <limits.h>     // INT_MIN, INT_MAX
 
+// Enable SSE2 or NEON intrinsics in the tessellation kernels when available (define IMGUI_DISABLE_SIMD in imconfig.h to use the scalar code)
+#if !defined(IMGUI_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define IMGUI_ENABLE_SSE
+#include <emmintrin.h>
+#elif !defined(IMGUI_DISABLE_SIMD) && (defined(__aarch64__) || defined(_M_ARM64))
+#define IMGUI_ENABLE_NEON
+#include <arm_neon.h>   // AArch64 only: the kernels need vdivq_f32/vsqrtq_f32, which 32-bit NEON doesn't have
+#endif
+
 // Visual Studio warnings
 #ifdef _MSC_VER
 #pragma warning (push)
@@ -98,6 +107,7 @@ struct ImBitVector;                 // Store 1-bit per value
 struct ImRect;                      // An axis-aligned rectangle (2 points)
 struct ImDrawDataBuilder;           // Helper to build a ImDrawData instance
 struct ImDrawListSharedData;        // Data shared between all ImDrawList instances
+struct ImTextLayoutCache;           // Cache of laid out text, used by ImFont::RenderText()
 struct ImGuiColorMod;               // Stacked color modifier, backup of modified data so we can restore it
 struct ImGuiContext;                // Main Dear ImGui context
 struct ImGuiContextHook;            // Hook for extensions like ImGuiTestEngine
@@ -260,6 +270,7 @@ namespace ImStb
 // - Helper: ImSpan<>, ImSpanAllocator<>
 // - Helper: ImPool<>
 // - Helper: ImChunkStream<>
+// - Helper: ImSizeClassAllocator
 //-----------------------------------------------------------------------------
 
 // Helpers: Hashing
@@ -295,6 +306,8 @@ IMGUI_API void          ImStrTrimBlanks(char* str);
 IMGUI_API const char*   ImStrSkipBlank(const char* str);
 IMGUI_API int           ImFormatString(char* buf, size_t buf_size, const char* fmt, ...) IM_FMTARGS(3);
 IMGUI_API int           ImFormatStringV(char* buf, size_t buf_size, const char* fmt, va_list args) IM_FMTLIST(3);
+IMGUI_API int           ImFormatFloat(char* buf, size_t buf_size, float v, int precision);  // Same output as "%.*f" without vsnprintf(), locale independent
+IMGUI_API int           ImFormatInt(char* buf, size_t buf_size, int v);                     // Same output as "%d" without vsnprintf(), locale independent
 IMGUI_API const char*   ImParseFormatFindStart(const char* format);
 IMGUI_API const char*   ImParseFormatFindEnd(const char* format);
 IMGUI_API const char*   ImParseFormatTrimDecorations(const char* format, char* buf, size_t buf_size);
@@ -415,6 +428,16 @@ IMGUI_API void       ImTriangleBarycentricCoords(const ImVec2& a, const ImVec2&
 inline float         ImTriangleArea(const ImVec2& a, const ImVec2& b, const ImVec2& c) { return ImFabs((a.x * (b.y - c.y)) + (b.x * (c.y - a.y)) + (c.x * (a.y - b.y))) * 0.5f; }
 IMGUI_API ImGuiDir   ImGetDirQuadrantFromDelta(float dx, float dy);
 
+// Helpers: Tessellation kernels used by ImDrawList (SSE2/NEON with a scalar tail, see IMGUI_ENABLE_SSE/IMGUI_ENABLE_NEON)
+// - ImTessellateSegmentNormals(): out_normals[i] = unit normal of the segment points[i] -> points[(i + 1) % points_count], for i < count.
+// - ImTessellateMiterNormals(): out_miters[(i + 1) % points_count] = averaged normals[i] and normals[i + 1], fixed up for miter joints, for i < count.
+// - ImTessellateArcPoints(), ImTessellateBezierCubicPoints(): the points of _PathArcToN() and PathBezierCubicCurveTo() with an explicit segment count.
+// Arcs use polynomial sin/cos approximations when vectorized, so they may differ from ImCos()/ImSin() in the last bits.
+IMGUI_API void       ImTessellateSegmentNormals(const ImVec2* points, int points_count, int count, ImVec2* out_normals);
+IMGUI_API void       ImTessellateMiterNormals(const ImVec2* normals, int points_count, int count, ImVec2* out_miters);
+IMGUI_API void       ImTessellateArcPoints(ImVec2* out_points, const ImVec2& center, float radius, float a_min, float a_max, int num_segments);       // Writes num_segments + 1 points
+IMGUI_API void       ImTessellateBezierCubicPoints(ImVec2* out_points, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const ImVec2& p4, int num_segments); // Writes num_segments points, p1 excluded
+
 // Helper: ImVec1 (1D vector)
 // (this odd construct is used to facilitate the transition between 1D and 2D, and the maintenance of some branches/patches)
 struct ImVec1
@@ -616,6 +639,41 @@ struct IMGUI_API ImChunkStream
 
 };
 
+// Helper: ImSizeClassAllocator
+// Fixed size blocks carved out of 16 KB pages, one free list per size class (32, 48, 64, 96 .. 6144 bytes).
+// A context created with CreateContext(..., true) owns one, and MemAlloc() serves every small allocation made while that context is current from it:
+// windows, tables, storage, draw lists, etc. This keeps contexts from contending on malloc() and from fragmenting the process heap with their small blocks.
+// Pages are only given back when the allocator is destroyed. Larger requests go straight to the functions set with SetAllocatorFunctions().
+// Not thread-safe, like the rest of the context it belongs to.
+#ifndef IMGUI_DISABLE_POOL_ALLOCATOR
+#define IM_SIZE_CLASS_COUNT         16
+#define IM_SIZE_CLASS_PAGE_SIZE     (16 * 1024)
+struct IMGUI_API ImSizeClassAllocator
+{
+    void*       FreeLists[IM_SIZE_CLASS_COUNT];     // First free block of each size class, the next one is stored in the block
+    void*       Pages;                              // All pages, linked through their first pointer
+    int         PageCount[IM_SIZE_CLASS_COUNT];
+    int         UsedBlocks[IM_SIZE_CLASS_COUNT];
+    int         LargeAllocations;                   // Live allocations too large for a size class
+    size_t      LiveBytes;                          // Bytes requested by live allocations (including large ones)
+    size_t      PeakLiveBytes;
+    ImU64       TotalAllocations;
+    bool        Orphaned;                           // The context was destroyed while some of our blocks were still alive: destroy ourselves when the last one is freed
+
+    ImSizeClassAllocator()      { memset(this, 0, sizeof(*this)); }
+    ~ImSizeClassAllocator()     { ReleasePages(); }
+    void*       AllocBlock(int size_class);
+    void        FreeBlock(void* block, int size_class);
+    void        ReleasePages();
+    int         GetLiveAllocations() const;
+    size_t      GetReservedBytes() const;
+
+    static int  GetSizeClass(size_t block_size);    // -1 when too large for a size class
+    static int  GetBlockSize(int size_class)        { return (size_class & 1) ? (48 << (size_class >> 1)) : (32 << (size_class >> 1)); }
+    static int  GetBlocksPerPage(int size_class)    { return (IM_SIZE_CLASS_PAGE_SIZE - 16) / GetBlockSize(size_class); }
+};
+#endif
+
 //-----------------------------------------------------------------------------
 // [SECTION] ImDrawList support
 //-----------------------------------------------------------------------------
@@ -646,6 +704,45 @@ struct IMGUI_API ImChunkStream
 #endif
 #define IM_DRAWLIST_ARCFAST_SAMPLE_MAX                          IM_DRAWLIST_ARCFAST_TABLE_SIZE // Sample index _PathArcToFastEx() for 360 angle.
 
+// Cache of laid out text, so that labels which don't change from frame to frame don't have to be decoded, looked up and measured again.
+// Entries are keyed by font, size, wrap width and text. An entry only gets filled once its text has been seen on two different frames,
+// so that text which changes every frame (e.g. numbers) costs as little as possible, and entries which haven't been used for a while get discarded.
+#ifndef IMGUI_DISABLE_TEXT_LAYOUT_CACHE
+#define IM_TEXT_LAYOUT_CACHE_MAX_TEXT_LENGTH    256     // Longer text isn't cached
+#define IM_TEXT_LAYOUT_CACHE_MAX_ENTRIES        4096
+#define IM_TEXT_LAYOUT_CACHE_MAX_AGE            60      // Number of frames after which an unused entry gets discarded
+
+struct ImTextLayoutCacheEntry
+{
+    ImGuiID                 Hash;
+    const ImFont*           Font;
+    float                   FontSize;
+    float                   WrapWidth;
+    int                     FontGlyphsVersion;  // Font->GlyphsVersion when the entry was filled (versions are unique across all fonts)
+    int                     FirstUsedFrame;
+    int                     LastUsedFrame;
+    ImVector<char>          Text;
+    bool                    HasSize;
+    ImVec2                  Size;               // CalcTextSizeA() with no max width
+    bool                    HasVertices;
+    ImVector<ImDrawVert>    Vertices;           // Glyph quads (4 vertices each, in PrimRectUV() order) relative to the text position. 'col' is 0, or ~IM_COL32_A_MASK for untinted glyphs.
+    ImVec4                  VerticesBounds;     // Bounding box of the quads, relative to the text position
+};
+
+struct IMGUI_API ImTextLayoutCache
+{
+    ImVector<ImTextLayoutCacheEntry*>   Entries;
+    ImGuiStorage                        Map;    // Hash -> index into Entries + 1
+    int                                 FrameCount;
+
+    ImTextLayoutCache()     { FrameCount = 0; }
+    ~ImTextLayoutCache()    { Clear(); }
+    void                    Clear();
+    void                    NewFrame();         // Discards entries which weren't used recently
+    ImTextLayoutCacheEntry* Find(const ImFont* font, float size, float wrap_width, const char* text_begin, const char* text_end); // Returns NULL when the text shouldn't be cached (yet)
+};
+#endif
+
 // Data shared between all ImDrawList instances
 // You may want to create your own instance of this if you want to use ImDrawList completely without ImGui. In that case, watch out for future changes to this structure.
 struct IMGUI_API ImDrawListSharedData
@@ -664,6 +761,8 @@ struct IMGUI_API ImDrawListSharedData
     ImU8            CircleSegmentCounts[64];    // Precomputed segment count for given radius before we calculate it dynamically (to avoid calculation overhead)
     const ImVec4*   TexUvLines;                 // UV of anti-aliased lines in the atlas
 
+    ImTextLayoutCache* TextLayoutCache;         // Optional cache of laid out text for ImFont::RenderText(), owned by the context
+
     ImDrawListSharedData();
     void SetCircleTessellationMaxError(float max_error);
 };
@@ -1297,6 +1396,12 @@ struct ImGuiContext
     float                   FontSize;                           // (Shortcut) == FontBaseSize * g.CurrentWindow->FontWindowScale == window->FontSize(). Text height for current window.
     float                   FontBaseSize;                       // (Shortcut) == IO.FontGlobalScale * Font->Scale * Font->FontSize. Base text height.
     ImDrawListSharedData    DrawListSharedData;
+#ifndef IMGUI_DISABLE_TEXT_LAYOUT_CACHE
+    ImTextLayoutCache       TextLayoutCache;                    // Laid out text reused across frames by ImFont::RenderText() and CalcTextSize()
+#endif
+#ifndef IMGUI_DISABLE_POOL_ALLOCATOR
+    ImSizeClassAllocator*   Allocator;                          // Serves MemAlloc() while this context is current, when created with CreateContext(..., true)
+#endif
     double                  Time;
     int                     FrameCount;
     int                     FrameCountEnded;
@@ -1432,6 +1537,7 @@ struct ImGuiContext
 
     // Render
     float                   DimBgRatio;                         // 0.0..1.0 animation when fading in a dimming background (for modal window and CTRL+TAB list)
+    ImVector<ImDrawList*>   DrawListsToTessellate;              // Draw lists with primitives recorded by io.ConfigDeferTessellation, gathered in Render()
     ImGuiMouseCursor        MouseCursor;
 
     // Drag and Drop
@@ -1536,6 +1642,12 @@ struct ImGuiContext
         Font = NULL;
         FontSize = FontBaseSize = 0.0f;
         IO.Fonts = shared_font_atlas ? shared_font_atlas : IM_NEW(ImFontAtlas)();
+#ifndef IMGUI_DISABLE_TEXT_LAYOUT_CACHE
+        DrawListSharedData.TextLayoutCache = &TextLayoutCache;
+#endif
+#ifndef IMGUI_DISABLE_POOL_ALLOCATOR
+        Allocator = NULL;
+#endif
         Time = 0.0f;
         FrameCount = 0;
         FrameCountEnded = FrameCountRendered = -1;
@@ -1826,6 +1938,8 @@ struct IMGUI_API ImGuiWindow
 
     int                     MemoryDrawListIdxCapacity;          // Backup of last idx/vtx count, so when waking up the window we can preallocate and avoid iterative alloc/copy
     int                     MemoryDrawListVtxCapacity;
+    int                     DrawListIdxHighWaterMark;           // Largest idx/vtx count the draw list ever reached, reserved up front when io.ConfigDrawListHighWaterMark is set
+    int                     DrawListVtxHighWaterMark;
     bool                    MemoryCompacted;                    // Set when window extraneous data have been garbage collected
 
 public:
@@ -2559,6 +2673,11 @@ IMGUI_API void      ImFontAtlasBuildRender32bppRectFromString(ImFontAtlas* atlas
 IMGUI_API void      ImFontAtlasBuildMultiplyCalcLookupTable(unsigned char out_table[256], float in_multiply_factor);
 IMGUI_API void      ImFontAtlasBuildMultiplyRectAlpha8(const unsigned char table[256], unsigned char* pixels, int x, int y, int w, int h, int stride);
 
+// Helpers for ImFontAtlasFlags_DynamicGlyphs (only implemented by the stb_truetype builder)
+IMGUI_API bool      ImFontAtlasBuildRasterizePendingGlyph(ImFontAtlas* atlas, ImFont* font, ImFontGlyph* glyph);  // Called by FindGlyph(). Returns false if the glyph doesn't fit in the texture yet.
+IMGUI_API void      ImFontAtlasBuildGrowTexture(ImFontAtlas* atlas);    // Called by NewFrame(). Doubles the texture height if a pending glyph didn't fit during the last frame.
+IMGUI_API void      ImFontAtlasBuildDestroyDynamicData(ImFontAtlas* atlas);
+
 //-----------------------------------------------------------------------------
 // [SECTION] Test Engine specific hooks (imgui_test_engine)
 //-----------------------------------------------------------------------------
@@ -272,6 +272,66 @@ void ImGui::TextV(const char* fmt, va_list args)
     TextEx(g.TempBuffer, text_end, ImGuiTextFlags_NoWidthForLargeClippedText);
 }
 
+static char* TextAppend(char* buf, const char* buf_end, const char* s)
+{
+    while (*s && buf + 1 < buf_end)
+        *buf++ = *s++;
+    *buf = 0;
+    return buf;
+}
+
+// Builds "label: v" or "label (x: v0, y: v1, z: v2)" into g.TempBuffer with ImFormatFloat()/ImFormatInt() instead of vsnprintf().
+// Either values or int_value is used.
+static void TextNumbers(const char* label, const float* values, int values_count, int precision, const int* int_value)
+{
+    ImGuiWindow* window = ImGui::GetCurrentWindow();
+    if (window->SkipItems)
+        return;
+
+    ImGuiContext& g = *GImGui;
+    char* buf = g.TempBuffer;
+    char* buf_end = g.TempBuffer + IM_ARRAYSIZE(g.TempBuffer);
+    buf = TextAppend(buf, buf_end, label);
+    if (values_count <= 1)
+    {
+        buf = TextAppend(buf, buf_end, ": ");
+        buf += int_value ? ImFormatInt(buf, (size_t)(buf_end - buf), *int_value) : ImFormatFloat(buf, (size_t)(buf_end - buf), values[0], precision);
+    }
+    else
+    {
+        static const char* component_names[] = { " (x: ", ", y: ", ", z: " };
+        for (int n = 0; n < values_count; n++)
+        {
+            buf = TextAppend(buf, buf_end, component_names[n]);
+            buf += ImFormatFloat(buf, (size_t)(buf_end - buf), values[n], precision);
+        }
+        buf = TextAppend(buf, buf_end, ")");
+    }
+    ImGui::TextEx(g.TempBuffer, buf, ImGuiTextFlags_NoWidthForLargeClippedText);
+}
+
+void ImGui::TextFloat(const char* label, float v, int precision)
+{
+    TextNumbers(label, &v, 1, precision, NULL);
+}
+
+void ImGui::TextFloat2(const char* label, float x, float y, int precision)
+{
+    const float values[2] = { x, y };
+    TextNumbers(label, values, 2, precision, NULL);
+}
+
+void ImGui::TextFloat3(const char* label, float x, float y, float z, int precision)
+{
+    const float values[3] = { x, y, z };
+    TextNumbers(label, values, 3, precision, NULL);
+}
+
+void ImGui::TextInt(const char* label, int v)
+{
+    TextNumbers(label, NULL, 1, 0, &v);
+}
+
 void ImGui::TextColored(const ImVec4& col, const char* fmt, ...)
 {
     va_list args;
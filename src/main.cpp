@@ -3,6 +3,17 @@
 #include "imgui/imgui_impl_sdl.h"
 
 #include "sdl_gamepad.h"
+#include "draw_data_capture.h"
+#include "worker_pool.h"
+#include "settings_journal.h"
+#include "gamepad_nav.h"
+#include "mapping_database.h"
+#include "shared_pad_publisher.h"
+#include "dsu_server.h"
+#include "report_rate_analyzer.h"
+
+#include <cstring>
+#include <memory>
 void ImGUIStyle();
 
 int main(int argc, char * argv[]){
@@ -42,14 +53,98 @@ int main(int argc, char * argv[]){
     // way that controllers are loaded and used typically in libraries such as Window.Gaming.Input, whihc means an array/vector for
     // storing controller instances is needed.
     std::vector<SDLGamepad *> Gamepads;
+    // Pad models that were seen before (in this run or an earlier one) skip the capability probing when they connect.
+    GamepadCapabilityCache capabilityCache("gamepad_capabilities.txt");
+    capabilityCache.load();
+    // What was learned about the centre, noise and range of each pad's sticks and triggers, by serial number (or model).
+    GamepadCalibrationStore calibrations("gamepad_calibration.txt");
+    calibrations.load();
 
     // ImGUI stuff is initialized for the purpose of display in the example.
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO(); (void)io;
+    // The windows grow a lot when touchpad and sensor headers open, so their draw lists keep the space they needed once.
+    io.ConfigDrawListHighWaterMark = true;
+    // Window settings go into an append-only journal written from a background thread, instead of imgui.ini being rewritten
+    // on the main thread every time a window moves. An existing imgui.ini is imported the first time.
+    io.IniFilename = nullptr;
+    SettingsJournal settings("imgui_settings.journal");
+    settings.load("imgui.ini");
     ImGUIStyle();
     ImGui_ImplSDL2_InitForOpenGL(window, NULL);
-    ImGui_ImplSDLRenderer_Init(renderer);
+    // UI navigation is fed from the gamepads that are polled below anyway, so the backend doesn't open a controller of its own.
+    ImGui_ImplSDL2_SetGamepadNavExternal(true);
+    GamepadNavBridge gamepadNav;
+    // Glyphs past Latin-1 (e.g. in localized controller names) are only rasterized into the atlas when they are first drawn.
+    io.Fonts->Flags |= ImFontAtlasFlags_DynamicGlyphs;
+    // The app only uses the default font, so the font atlas can be kept as alpha only.
+    ImGui_ImplSDLRenderer_Init(renderer, true);
+
+    // Passing "--tiled" renders ImGui with the multithreaded tiled software rasterizer instead of SDL_Renderer draw calls,
+    // which is a lot faster on machines that don't have a GPU.
+    // Passing "--record <file>" saves the draw data of every frame, which tools/renderer_benchmark.cpp can replay.
+    // Passing "--parallel-tessellation" writes the vertices of lines and shapes in ImGui::Render(), one window per worker thread.
+    // Passing "--import-settings <file>" loads window settings from an imgui.ini, and "--export-settings <file>" writes them to one at exit.
+    // Passing "--gamepad-nav" lets every connected pad navigate the UI (off by default, since pressing buttons is what the app is for).
+    // Passing "--mappings <file>" reads controller mappings from a gamecontrollerdb.txt style file other than the one next to the app.
+    // Passing "--publish-states" writes every polled pad into shared memory, where other processes can read it with SharedPadReader.
+    // Passing "--dsu-server" streams the pads, with their gyroscope and accelerometer, to emulators on this machine over DSU (UDP 26760).
+    // Passing "--report-rate" timestamps every report the pads send, for the rate, jitter and dropouts in each pad's window.
+    std::unique_ptr<DrawDataCaptureWriter> capture;
+    std::unique_ptr<WorkerPool> tessellationWorkers;
+    std::string exportSettingsPath = "";
+    std::string mappingsPath = "gamecontrollerdb.txt";
+    SharedPadPublisher statePublisher;
+    DSUServer motionServer;
+    ReportRateMonitor reportRates;
+    for (int i = 1; i < argc; i++){
+        if (strcmp(argv[i], "--tiled") == 0){
+            ImGui_ImplSDLRenderer_SetTiledRasterization(true);
+        }
+        if (strcmp(argv[i], "--parallel-tessellation") == 0){
+            tessellationWorkers = std::make_unique<WorkerPool>();
+            io.ConfigDeferTessellation = true;
+            io.ParallelForUserData = tessellationWorkers.get();
+            io.ParallelForFn = [](void * userData, int jobCount, ImGuiParallelJobFn job, void * jobData){
+                static_cast<WorkerPool *>(userData)->parallelFor(jobCount, [&](int index){ job(jobData, index); });
+            };
+        }
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc){
+            capture = std::make_unique<DrawDataCaptureWriter>(argv[++i]);
+            if (!capture->isOpen()){
+                std::cout << "Could not open " << argv[i] << " for recording." << std::endl;
+                capture.reset();
+            }
+        }
+        if (strcmp(argv[i], "--import-settings") == 0 && i + 1 < argc){
+            if (!settings.importText(argv[++i])){
+                std::cout << "Could not import settings from " << argv[i] << "." << std::endl;
+            }
+        }
+        if (strcmp(argv[i], "--export-settings") == 0 && i + 1 < argc){
+            exportSettingsPath = argv[++i];
+        }
+        if (strcmp(argv[i], "--gamepad-nav") == 0){
+            io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;
+        }
+        if (strcmp(argv[i], "--mappings") == 0 && i + 1 < argc){
+            mappingsPath = argv[++i];
+        }
+        if (strcmp(argv[i], "--publish-states") == 0 && !statePublisher.open()){
+            std::cout << "Could not create the shared memory for the pad states." << std::endl;
+        }
+        if (strcmp(argv[i], "--dsu-server") == 0 && !motionServer.open()){
+            std::cout << "Could not open UDP port " << motionServer.getPort() << " for the DSU server." << std::endl;
+        }
+        if (strcmp(argv[i], "--report-rate") == 0){
+            reportRates.open();
+        }
+    }
+    // Extra mappings for pads SDL doesn't know about. The file is indexed once, and a mapping is only handed to SDL when its
+    // joystick connects. Editing the file while the app runs applies the changes to connected pads.
+    ControllerMappingDatabase mappings(mappingsPath);
+    mappings.load();
     int count = 0;
     int show_controller[8] {0,0,0,0,0,0,0,0};
     ImGuiID child_id = 0;
@@ -62,19 +157,30 @@ int main(int argc, char * argv[]){
                 break;
             }
 
+            // Every sensor sample goes to the DSU server, which reports faster than the frames come.
+            if (event.type == SDL_CONTROLLERSENSORUPDATE && motionServer.isOpen()){
+                motionServer.addSensorEvent(event.csensor);
+            }
+
+            // Joysticks show up as game controllers once they have a mapping.
+            if (event.type == SDL_JOYDEVICEADDED){
+                mappings.applyDevice(event.jdevice.which);
+            }
+
             // In order to add controllers, you have to query if controllers have been added on the system.
             if (event.type == SDL_CONTROLLERDEVICEADDED){
                 // If the controller is added, we create an instance. modified this to
                 // handle not adding controllers in the case of it already existing,
+                // (the event holds a device index, while the gamepads keep instance IDs).
                 bool add_device = true;
                 for (int i = 0; i < int(Gamepads.size()); i++){
-                    if (Gamepads[i]->id == event.cdevice.which){
+                    if (Gamepads[i]->id == SDL_JoystickGetDeviceInstanceID(event.cdevice.which)){
                         add_device = false;
                         break;
                     }
                 }
                 if (add_device){
-                    Gamepads.push_back(new SDLGamepad(event.cdevice.which));
+                    Gamepads.push_back(new SDLGamepad(event.cdevice.which, &capabilityCache, &calibrations));
                 }         
             }
 
@@ -96,13 +202,23 @@ int main(int argc, char * argv[]){
             }
         }
 
+        mappings.update();
+
         //the SDLGamepad class relies on polling each connected gamepad
         for (auto controller: Gamepads){
             controller->pollState();
         }
+        statePublisher.publish(Gamepads);
+        if (motionServer.isOpen()){
+            motionServer.update(Gamepads);
+        }
+        if (reportRates.isOpen()){
+            reportRates.update(Gamepads);
+        }
 
         SDL_RenderClear(renderer);
         ImGui_ImplSDL2_NewFrame(window);
+        gamepadNav.apply(Gamepads, io);
         ImGui::NewFrame();
         count = 0;
         ImVec4 color = {.500, .500, .500, 1.0};
@@ -115,6 +231,11 @@ int main(int argc, char * argv[]){
                 ImGui::Begin((controller->getName()+": #" + std::to_string(count)).c_str());
                 ImVec4 pressed = ImVec4(0.0, 1.0, 0.0, 1.0);
 
+                // Rumble, LED, sensors and touchpads are probed in the background after the pad connects.
+                if (!controller->capabilitiesReady()){
+                    ImGui::TextColored(color, "Probing capabilities...");
+                }
+
                 //Set Controller LED (If supported)
                 if (controller->hasLED()){
                     std::vector<float> LED_Color = {float(controller->led_color.r) / float(255),
@@ -133,7 +254,7 @@ int main(int argc, char * argv[]){
                 ImGui::NewLine();
                 // Show number of touchpads if supported.
                 if (controller->getTouchpadCount()){
-                    ImGui::Text("Number of touchpads: %i", controller->getTouchpadCount());
+                    ImGui::TextInt("Number of touchpads", controller->getTouchpadCount());
                 }
                 
                 // Provide options to enable gyro and accelerometer.
@@ -251,14 +372,16 @@ int main(int argc, char * argv[]){
                 ImGui::NewLine();
                 // Print the Axis values for the Triggers
                 ImGui::TextColored(color, "Left Trigger and Right Trigger");
-                ImGui::Text("Left Trigger: %.3f ,  Right Trigger: %.3f", controller->state.LeftTrigger, controller->state.RightTrigger);
+                ImGui::TextFloat("Left Trigger", controller->state.LeftTrigger);
+                ImGui::SameLine();
+                ImGui::TextFloat("Right Trigger", controller->state.RightTrigger);
 
 
                 ImGui::NewLine();
                 // Print the Axis values for the Sticks.
                 ImGui::TextColored(color, "Left Stick and Right Stick");
-                ImGui::Text("Left Stick (x: %.3f ,  y: %.3f)", controller->state.LeftStick.x, controller->state.LeftStick.y);
-                ImGui::Text("Right Stick (x: %.3f ,  y: %.3f)", controller->state.RightStick.x, controller->state.RightStick.y);
+                ImGui::TextFloat2("Left Stick", controller->state.LeftStick.x, controller->state.LeftStick.y);
+                ImGui::TextFloat2("Right Stick", controller->state.RightStick.x, controller->state.RightStick.y);
 
 
                 if (controller->sensorEnabled){
@@ -266,12 +389,12 @@ int main(int argc, char * argv[]){
                     // Print the Axis values for the Sticks.
                     ImGui::TextColored(color, "Gyro and/or Accelerometer");
                     if (controller->hasGyroscope()){
-                        ImGui::Text("Gyroscope (x: %.3f ,  y: %.3f, z: %.3f)", controller->sensor_state.Gyroscope[0],
+                        ImGui::TextFloat3("Gyroscope", controller->sensor_state.Gyroscope[0],
                                                                         controller->sensor_state.Gyroscope[1],
                                                                         controller->sensor_state.Gyroscope[2]);
                     }
                     if (controller->hasAccelerometer()){
-                        ImGui::Text("Accelerometer (x: %.3f ,  y: %.3f, z: %.3f)", controller->sensor_state.Accelerometer[0],
+                        ImGui::TextFloat3("Accelerometer", controller->sensor_state.Accelerometer[0],
                                                                         controller->sensor_state.Accelerometer[1],
                                                                         controller->sensor_state.Accelerometer[2]);
                     }
@@ -332,6 +455,66 @@ int main(int argc, char * argv[]){
                         }
                    }
                 }
+                // Show what the calibration learned about each axis.
+                if (ImGui::CollapsingHeader("Calibration")){
+                    ImGui::Checkbox("Learn", &controller->calibration.learning);
+                    ImGui::SameLine();
+                    if (ImGui::Button("Reset")){
+                        controller->calibration.reset();
+                    }
+                    if (ImGui::BeginTable("Axes", 1)){
+                        for (int axis = 0; axis < SDLGamepadCalibration::axisCount; axis++){
+                            const AxisLearner & learner = controller->calibration.learners[axis];
+                            const AxisCorrection & correction = controller->calibration.corrections[axis];
+                            ImGui::TableNextColumn();
+                            ImGui::Text("%s: (centre: %f, noise: %f, extents: -%f +%f)", SDLGamepadCalibration::axisNames[axis],
+                                        correction.center, correction.noise, learner.negativeExtent(), learner.positiveExtent());
+                        }
+                        ImGui::EndTable();
+                    }
+                }
+                // Show how often the pad reports, and the reports it lost.
+                ReportRateAnalyzer reportRate;
+                if (reportRates.isOpen() && reportRates.getAnalyzer(controller->id, reportRate) && ImGui::CollapsingHeader("Report rate")){
+                    if (ImGui::Button("Clear")){
+                        reportRates.reset(controller->id);
+                    }
+                    ImGui::SameLine();
+                    if (ImGui::Button("Export")){
+                        const std::string path = "report_rate_" + std::to_string(controller->id) + ".txt";
+                        if (reportRates.exportText(controller->id, controller->getName(), path)){
+                            std::cout << "Saved the report rate to " << path << "." << std::endl;
+                        }
+                        else {
+                            std::cout << "Could not save the report rate to " << path << "." << std::endl;
+                        }
+                    }
+                    ImGui::Text("Rate: %.1f Hz (%.1f Hz on average, %llu reports)", reportRate.getRate(ReportRateMonitor::now()),
+                                reportRate.getAverageRate(), (unsigned long long)reportRate.getReports());
+                    ImGui::Text("Interval: %.3f ms (deviation: %.3f ms, jitter: %.3f ms, longest: %.3f ms)", reportRate.getMeanInterval(),
+                                reportRate.getIntervalDeviation(), reportRate.getJitter(), reportRate.getLongestGap());
+                    if (reportRate.isContinuous()){
+                        ImGui::Text("Dropouts: %llu (%llu reports lost, %.2f%%)", (unsigned long long)reportRate.getDropouts(),
+                                    (unsigned long long)reportRate.getLostReports(), reportRate.getLossRatio() * 100.0);
+                        if (reportRate.getDropouts() && ImGui::BeginTable("Dropouts", 2)){
+                            for (int bin = 0; bin < ReportRateAnalyzer::burstBins; bin++){
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%s lost", ReportRateAnalyzer::burstLabel(bin).c_str());
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%llu", (unsigned long long)reportRate.getBursts()[bin]);
+                            }
+                            ImGui::EndTable();
+                        }
+                    }
+                    else {
+                        ImGui::TextColored(color, "Only reports on changes, so dropouts can't be told apart.");
+                    }
+                    float intervals[ReportRateAnalyzer::histogramBins];
+                    for (int bin = 0; bin < ReportRateAnalyzer::histogramBins; bin++){
+                        intervals[bin] = float(reportRate.getHistogram()[bin]);
+                    }
+                    ImGui::PlotHistogram("Intervals", intervals, ReportRateAnalyzer::histogramBins, 0, "0.125 ms - 1 s", 0.0f, FLT_MAX, ImVec2(0, 80));
+                }
                 ImGui::End();
             }
             
@@ -340,7 +523,13 @@ int main(int argc, char * argv[]){
         ImGui::Begin("SDL Game Controller Test/Example App");
         ImGui::Text("This is an application that tests the controllers you have on your system, using SDL2 with a custom class. \nThis serves to also be an example of using SDL2 with controller support.");
         ImGui::NewLine();
-        ImGui::Text("Number of Controllers: %i", Gamepads.size());
+        ImGui::TextInt("Number of Controllers", int(Gamepads.size()));
+        if (mappings.size()){
+            ImGui::TextInt(("Mappings in " + mappings.getPath()).c_str(), mappings.size());
+        }
+        if (motionServer.isOpen()){
+            ImGui::TextInt("DSU clients", motionServer.getClientCount());
+        }
         for (int i = 0; i < Gamepads.size(); i++ ){
             if (ImGui::Button((Gamepads[i]->getName()+" (Index: "+ std::to_string(i) +")").c_str())){
                 if (show_controller[i]){
@@ -354,6 +543,10 @@ int main(int argc, char * argv[]){
         ImGui::End();
         ImGui::EndFrame();
         ImGui::Render();
+        if (capture){
+            capture->writeFrame(ImGui::GetDrawData());
+        }
+        settings.update();
 
         SDL_SetRenderTarget(renderer, NULL);
         SDL_SetRenderDrawColor(renderer, 240, 240, 240, 255);
@@ -363,6 +556,25 @@ int main(int argc, char * argv[]){
     }
 
 
+    settings.update(true);
+    if (!exportSettingsPath.empty() && !settings.exportText(exportSettingsPath)){
+        std::cout << "Could not export settings to " << exportSettingsPath << "." << std::endl;
+    }
+
+    // The monitor's thread reads the pads, so it stops before they go away.
+    reportRates.close();
+    // Deleting the pads waits for any probing that is still going on, so its results make it into the cache, and stores their calibrations.
+    for (auto controller: Gamepads){
+        delete controller;
+    }
+    Gamepads.clear();
+    if (!capabilityCache.save()){
+        std::cout << "Could not save the gamepad capabilities." << std::endl;
+    }
+    if (!calibrations.save()){
+        std::cout << "Could not save the gamepad calibrations." << std::endl;
+    }
+
     ImGui_ImplSDLRenderer_Shutdown();
     ImGui_ImplSDL2_Shutdown();
     ImGui::DestroyContext();
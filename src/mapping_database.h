@@ -0,0 +1,457 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_gamecontroller.h>
+
+#include <sys/stat.h>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// Loads a gamecontrollerdb.txt style mapping file without handing all of its lines to SDL at every start.
+// The text is parsed once into a binary index next to it ("<file>.index"): the mappings for this platform, sorted by GUID.
+// Later runs map that index into memory as long as the text file hasn't changed, and a mapping is only given to SDL when a
+// joystick with its GUID connects. update() watches the text file, and when it changes, rebuilds the index and re-applies the
+// mappings that changed for the joysticks that are connected.
+//
+// Index layout (all values are little endian, as written by the machine):
+//   header: "GCDX", uint32 version, uint64 text modification time (ns), uint64 text size, uint32 hash of SDL_GetPlatform(), uint32 count
+//   entries: count times {uint8 GUID[16], uint32 offset, uint32 length, uint32 hash of the mapping}, sorted by GUID
+//   then the mappings, each one a line of the text file that ends with a 0, so that SDL can be handed a pointer into the index.
+namespace MappingIndexFormat {
+    static constexpr char magic[4] = {'G', 'C', 'D', 'X'};
+    static constexpr uint32_t version = 2;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint64_t sourceTime;    // ns, so that edits within the same second as the last one are seen
+        uint64_t sourceSize;
+        uint32_t platformHash;
+        uint32_t count;
+    };
+
+    struct Entry {
+        uint8_t guid[16];
+        uint32_t offset;
+        uint32_t length;
+        uint32_t hash;
+    };
+}
+
+class ControllerMappingDatabase {
+private:
+    // A read only view of a whole file, or nothing.
+    class MappedFile {
+    private:
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = NULL;
+#endif
+        const unsigned char * bytes = nullptr;
+        size_t size = 0;
+
+    public:
+        ~MappedFile(){
+            close();
+        }
+
+        bool open(const std::string & path){
+            close();
+#ifdef _WIN32
+            file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+            if (file == INVALID_HANDLE_VALUE){
+                return false;
+            }
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0){
+                close();
+                return false;
+            }
+            mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            bytes = mapping ? (const unsigned char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+            if (!bytes){
+                close();
+                return false;
+            }
+            size = size_t(fileSize.QuadPart);
+#else
+            int descriptor = ::open(path.c_str(), O_RDONLY);
+            if (descriptor < 0){
+                return false;
+            }
+            struct stat info;
+            if (fstat(descriptor, &info) != 0 || info.st_size == 0){
+                ::close(descriptor);
+                return false;
+            }
+            void * view = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+            ::close(descriptor);
+            if (view == MAP_FAILED){
+                return false;
+            }
+            bytes = (const unsigned char *)view;
+            size = size_t(info.st_size);
+#endif
+            return true;
+        }
+
+        void close(){
+#ifdef _WIN32
+            if (bytes){
+                UnmapViewOfFile(bytes);
+            }
+            if (mapping){
+                CloseHandle(mapping);
+            }
+            if (file != INVALID_HANDLE_VALUE){
+                CloseHandle(file);
+            }
+            mapping = NULL;
+            file = INVALID_HANDLE_VALUE;
+#else
+            if (bytes){
+                munmap((void *)bytes, size);
+            }
+#endif
+            bytes = nullptr;
+            size = 0;
+        }
+
+        const unsigned char * data() const{
+            return bytes;
+        }
+
+        size_t length() const{
+            return size;
+        }
+    };
+
+    std::string sourcePath;
+    std::string indexPath;
+    MappedFile mappedIndex;
+    std::string builtIndex;                 // Used instead of the mapped index when it couldn't be written
+    const MappingIndexFormat::Header * header = nullptr;
+    const MappingIndexFormat::Entry * entries = nullptr;
+    uint64_t sourceTime = 0;
+    uint64_t sourceSize = 0;
+    std::map<std::string, uint32_t> appliedHashes;  // GUID -> hash of the mapping SDL was given for it
+    Uint32 lastCheck = 0;
+
+    static uint32_t hash(const char * text, size_t length){
+        // FNV-1a
+        uint32_t value = 2166136261u;
+        for (size_t i = 0; i < length; i++){
+            value = (value ^ (unsigned char)text[i]) * 16777619u;
+        }
+        return value;
+    }
+
+    static bool parseGUID(const char * text, size_t length, uint8_t guid[16]){
+        if (length != 32){
+            return false;
+        }
+        for (int i = 0; i < 32; i++){
+            char c = text[i];
+            int digit = (c >= '0' && c <= '9') ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+            if (digit < 0){
+                return false;
+            }
+            guid[i / 2] = uint8_t((i % 2) ? (guid[i / 2] | digit) : (digit << 4));
+        }
+        return true;
+    }
+
+    // The modification time is in ns (as precise as the file system keeps it), not in whole seconds like st_mtime.
+    static bool statSource(const std::string & path, uint64_t & time, uint64_t & size){
+#ifdef _WIN32
+        WIN32_FILE_ATTRIBUTE_DATA info;
+        if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &info)){
+            return false;
+        }
+        time = ((uint64_t(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime) * 100;
+        size = (uint64_t(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+#else
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0){
+            return false;
+        }
+#ifdef __APPLE__
+        time = uint64_t(info.st_mtimespec.tv_sec) * 1000000000ull + uint64_t(info.st_mtimespec.tv_nsec);
+#else
+        time = uint64_t(info.st_mtim.tv_sec) * 1000000000ull + uint64_t(info.st_mtim.tv_nsec);
+#endif
+        size = uint64_t(info.st_size);
+#endif
+        return true;
+    }
+
+    static uint32_t platformHash(){
+        const char * platform = SDL_GetPlatform();
+        return hash(platform, strlen(platform));
+    }
+
+    // Builds the index of the mappings for this platform, the same ones SDL_GameControllerAddMappingsFromFile() would add:
+    // like SDL 2.0.15, only lines with a "platform:" field (ended by a comma) whose value matches SDL_GetPlatform(), ignoring case.
+    // When a GUID shows up more than once, the last line wins, as it would when SDL adds them in order.
+    static std::string buildIndex(const std::string & text, uint64_t time, uint64_t size){
+        struct Line {
+            MappingIndexFormat::Entry entry;
+            size_t start;
+        };
+        std::vector<Line> lines;
+        const char * platform = SDL_GetPlatform();
+        size_t lineStart = 0;
+        while (lineStart < text.size()){
+            size_t lineEnd = text.find('\n', lineStart);
+            lineEnd = lineEnd == std::string::npos ? text.size() : lineEnd;
+            size_t start = text.find_first_not_of(" \t", lineStart);
+            size_t end = lineEnd;
+            while (end > lineStart && (text[end - 1] == '\r' || text[end - 1] == ' ' || text[end - 1] == '\t')){
+                end--;
+            }
+            lineStart = lineEnd + 1;
+            if (start == std::string::npos || start >= end || text[start] == '#'){
+                continue;
+            }
+            std::string line = text.substr(start, end - start);
+            size_t comma = line.find(',');
+            Line parsed;
+            if (comma == std::string::npos || !parseGUID(line.c_str(), comma, parsed.entry.guid)){
+                continue;
+            }
+            size_t platformField = line.find("platform:");
+            if (platformField == std::string::npos){
+                continue;
+            }
+            size_t valueStart = platformField + strlen("platform:");
+            size_t valueEnd = line.find(',', valueStart);
+            if (valueEnd == std::string::npos || valueEnd - valueStart != strlen(platform)
+                || SDL_strncasecmp(line.c_str() + valueStart, platform, valueEnd - valueStart) != 0){
+                continue;
+            }
+            parsed.entry.length = uint32_t(line.size());
+            parsed.entry.hash = hash(line.c_str(), line.size());
+            parsed.start = start;
+            lines.push_back(parsed);
+        }
+        std::stable_sort(lines.begin(), lines.end(), [](const Line & a, const Line & b){
+            return memcmp(a.entry.guid, b.entry.guid, 16) < 0;
+        });
+        std::vector<Line> unique;
+        for (const Line & line: lines){
+            if (!unique.empty() && memcmp(unique.back().entry.guid, line.entry.guid, 16) == 0){
+                unique.back() = line;
+            }
+            else {
+                unique.push_back(line);
+            }
+        }
+
+        MappingIndexFormat::Header indexHeader;
+        memcpy(indexHeader.magic, MappingIndexFormat::magic, 4);
+        indexHeader.version = MappingIndexFormat::version;
+        indexHeader.sourceTime = time;
+        indexHeader.sourceSize = size;
+        indexHeader.platformHash = platformHash();
+        indexHeader.count = uint32_t(unique.size());
+        std::string strings;
+        for (Line & line: unique){
+            line.entry.offset = uint32_t(sizeof(MappingIndexFormat::Header) + unique.size() * sizeof(MappingIndexFormat::Entry) + strings.size());
+            strings.append(text, line.start, line.entry.length);
+            strings += '\0';
+        }
+        std::string index((const char *)&indexHeader, sizeof(indexHeader));
+        for (const Line & line: unique){
+            index.append((const char *)&line.entry, sizeof(line.entry));
+        }
+        return index + strings;
+    }
+
+    // Points header and entries at an index, if it is complete and was built from the text file as it is now.
+    bool useIndex(const unsigned char * bytes, size_t size){
+        header = nullptr;
+        entries = nullptr;
+        if (!bytes || size < sizeof(MappingIndexFormat::Header)){
+            return false;
+        }
+        const MappingIndexFormat::Header * candidate = (const MappingIndexFormat::Header *)bytes;
+        if (memcmp(candidate->magic, MappingIndexFormat::magic, 4) != 0 || candidate->version != MappingIndexFormat::version
+            || candidate->sourceTime != sourceTime || candidate->sourceSize != sourceSize || candidate->platformHash != platformHash()
+            || candidate->count > (size - sizeof(MappingIndexFormat::Header)) / sizeof(MappingIndexFormat::Entry)){
+            return false;
+        }
+        const MappingIndexFormat::Entry * candidateEntries = (const MappingIndexFormat::Entry *)(bytes + sizeof(MappingIndexFormat::Header));
+        for (uint32_t i = 0; i < candidate->count; i++){
+            const MappingIndexFormat::Entry & entry = candidateEntries[i];
+            if (entry.offset > size || entry.length >= size - entry.offset || bytes[entry.offset + entry.length] != '\0'){
+                return false;
+            }
+        }
+        header = candidate;
+        entries = candidateEntries;
+        return true;
+    }
+
+    bool writeIndex(const std::string & index){
+        std::string temporaryPath = indexPath + ".tmp";
+        bool ok = false;
+        if (FILE * file = fopen(temporaryPath.c_str(), "wb")){
+            ok = fwrite(index.data(), 1, index.size(), file) == index.size();
+            ok = (fclose(file) == 0) && ok;
+        }
+#ifdef _WIN32
+        if (ok){
+            remove(indexPath.c_str()); // rename() doesn't replace existing files on Windows
+        }
+#endif
+        return ok && rename(temporaryPath.c_str(), indexPath.c_str()) == 0;
+    }
+
+    // Parses the text file again, and maps the index it gets written to (or keeps it in memory when it can't be written).
+    bool rebuild(){
+        FILE * file = fopen(sourcePath.c_str(), "rb");
+        if (!file){
+            return false;
+        }
+        std::string text;
+        char buffer[16 * 1024];
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0){
+            text.append(buffer, read);
+        }
+        fclose(file);
+
+        std::string index = buildIndex(text, sourceTime, sourceSize);
+        mappedIndex.close();  // Windows can't replace a file that is mapped
+        builtIndex.clear();
+        if (writeIndex(index) && mappedIndex.open(indexPath) && useIndex(mappedIndex.data(), mappedIndex.length())){
+            return true;
+        }
+        mappedIndex.close();
+        builtIndex = std::move(index);
+        return useIndex((const unsigned char *)builtIndex.data(), builtIndex.size());
+    }
+
+    const MappingIndexFormat::Entry * find(const uint8_t guid[16]) const{
+        if (!header){
+            return nullptr;
+        }
+        const MappingIndexFormat::Entry * end = entries + header->count;
+        const MappingIndexFormat::Entry * entry = std::lower_bound(entries, end, guid, [](const MappingIndexFormat::Entry & a, const uint8_t * b){
+            return memcmp(a.guid, b, 16) < 0;
+        });
+        return (entry != end && memcmp(entry->guid, guid, 16) == 0) ? entry : nullptr;
+    }
+
+    const char * mappingText(const MappingIndexFormat::Entry & entry) const{
+        return (const char *)header + entry.offset;
+    }
+
+public:
+    // How often update() looks at the text file.
+    Uint32 checkIntervalMs = 1000;
+
+    ControllerMappingDatabase(const std::string & path): sourcePath(path), indexPath(path + ".index"){}
+
+    ControllerMappingDatabase(const ControllerMappingDatabase &) = delete;
+    ControllerMappingDatabase & operator=(const ControllerMappingDatabase &) = delete;
+
+    // Maps the index, or builds it when it is missing or older than the text file. Returns false if there is no text file.
+    bool load(){
+        lastCheck = SDL_GetTicks();
+        if (!statSource(sourcePath, sourceTime, sourceSize)){
+            sourceTime = 0;
+            sourceSize = 0;
+            mappedIndex.close();
+            builtIndex.clear();
+            header = nullptr;
+            entries = nullptr;
+            return false;
+        }
+        if (mappedIndex.open(indexPath) && useIndex(mappedIndex.data(), mappedIndex.length())){
+            return true;
+        }
+        return rebuild();
+    }
+
+    // Gives SDL the mapping for a joystick, unless it already has that exact one. Call it for every SDL_JOYDEVICEADDED event.
+    // SDL only reports joysticks that have a mapping as game controllers, so when this turns a joystick into one, an
+    // SDL_CONTROLLERDEVICEADDED event is pushed for it (SDL may send one too, so handle pads that are already open).
+    bool applyDevice(int deviceIndex){
+        SDL_JoystickGUID guid = SDL_JoystickGetDeviceGUID(deviceIndex);
+        const MappingIndexFormat::Entry * entry = find(guid.data);
+        if (!entry){
+            return false;
+        }
+        std::string key((const char *)guid.data, 16);
+        auto applied = appliedHashes.find(key);
+        if (applied != appliedHashes.end() && applied->second == entry->hash){
+            return false;
+        }
+        const bool wasController = SDL_IsGameController(deviceIndex);
+        if (SDL_GameControllerAddMapping(mappingText(*entry)) < 0){
+            return false;
+        }
+        appliedHashes[key] = entry->hash;
+        if (!wasController && SDL_IsGameController(deviceIndex)){
+            SDL_Event added;
+            SDL_zero(added);
+            added.type = SDL_CONTROLLERDEVICEADDED;
+            added.cdevice.which = deviceIndex;
+            SDL_PushEvent(&added);
+        }
+        return true;
+    }
+
+    // Call once per frame. Every checkIntervalMs, checks if the text file changed, and if it did, loads it again and re-applies
+    // the mappings that changed for the joysticks that are connected. SDL sends SDL_CONTROLLERDEVICEREMAPPED for open pads.
+    // Returns true when the file was reloaded.
+    bool update(){
+        if (!SDL_TICKS_PASSED(SDL_GetTicks(), lastCheck + checkIntervalMs)){
+            return false;
+        }
+        lastCheck = SDL_GetTicks();
+        uint64_t fileTime = 0, fileSize = 0;
+        const bool exists = statSource(sourcePath, fileTime, fileSize);
+        if (exists == (header != nullptr) && fileTime == sourceTime && fileSize == sourceSize){
+            return false;
+        }
+        load();
+        for (int i = 0; i < SDL_NumJoysticks(); i++){
+            applyDevice(i);
+        }
+        return true;
+    }
+
+    int size() const{
+        return header ? int(header->count) : 0;
+    }
+
+    // The mapping for a GUID, or nullptr. It stays valid until the next load() or update().
+    const char * mapping(SDL_JoystickGUID guid) const{
+        const MappingIndexFormat::Entry * entry = find(guid.data);
+        return entry ? mappingText(*entry) : nullptr;
+    }
+
+    const std::string & getPath() const{
+        return sourcePath;
+    }
+};
@@ -0,0 +1,480 @@
+#pragma once
+#include "sdl_gamepad.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Statistics of the reports one pad sends, in constant memory: how many arrive per second, how far apart they are (a histogram
+// in quarter octaves from 0.125 ms to 1 s, their mean and deviation, and an RFC 3550 style jitter), and dropouts, where a report
+// comes so late that reports in between must have been lost (what Bluetooth interference looks like), with how many were lost
+// in each. Times are in ns, on any clock that only goes forward.
+//
+// Reports are expected on a schedule of one interval apart, which follows the arrivals slowly. Comparing each arrival with the
+// schedule instead of with the report before keeps reports that are read in bunches (two in one go, then none in the next) from
+// looking like lost ones.
+//
+// Dropouts only mean something for pads that report continuously (pads with their sensors on): other pads only have updates
+// when something changes, and the time between them is how long the player didn't touch anything.
+class ReportRateAnalyzer{
+public:
+    static constexpr int histogramBins = 52;
+    static constexpr int binsPerOctave = 4;
+    static constexpr double firstBinStart = 0.125; // ms
+    // Lost reports per dropout: 1, 2, 3 - 4, 5 - 8, ... 65 and more
+    static constexpr int burstBins = 8;
+    // The rate is counted in buckets of 100 ms, over the last second.
+    static constexpr int rateBuckets = 10;
+    static constexpr uint64_t bucketLength = 100000000;
+    // A report this many intervals behind the schedule means one was lost (and one more for every interval after that).
+    static constexpr double dropoutLateness = 0.75;
+    // Reports lost this few reports after a dropout belong to it (reports that are read in bunches can make the first report after
+    // a dropout look like it came one report early).
+    static constexpr uint64_t dropoutMerge = 4;
+    // Reports on the schedule before it is trusted enough to find dropouts.
+    static constexpr uint64_t warmupReports = 64;
+
+private:
+    bool continuous = true;
+    uint64_t reports = 0;
+    uint64_t firstTime = 0;
+    uint64_t lastTime = 0;
+    uint64_t bucketEpochs[rateBuckets] = {};
+    uint32_t bucketCounts[rateBuckets] = {};
+    uint64_t histogram[histogramBins] = {};
+    // Welford's mean and variance of the intervals (ms) that weren't dropouts
+    uint64_t intervals = 0;
+    double intervalMean = 0.0;
+    double intervalSquares = 0.0;
+    // Exponential average of the intervals (ms) that weren't dropouts, which is what the next one is expected to be.
+    double expectedInterval = 0.0;
+    // When the next report is expected, in ms since the first one, and when the schedule started and how many reports were sent
+    // since then (lost ones included).
+    double nextArrival = 0.0;
+    double scheduleStart = 0.0;
+    uint64_t scheduleReports = 0;
+    double jitter = 0.0;
+    uint64_t dropouts = 0;
+    uint64_t lostReports = 0;
+    double longestGap = 0.0;
+    uint64_t lastDropoutTime = 0;
+    // Reports lost in the last dropout, and reports since it.
+    uint64_t lastDropoutLost = 0;
+    uint64_t sinceDropout = 0;
+    uint64_t bursts[burstBins] = {};
+
+    static int burstBin(uint64_t lost){
+        int bin = 0;
+        while (bin < burstBins - 1 && (uint64_t(1) << bin) < lost){
+            bin++;
+        }
+        return bin;
+    }
+
+public:
+    // Off for pads that only have updates when something changes, see above.
+    void setContinuous(bool value){
+        continuous = value;
+    }
+
+    bool isContinuous() const{
+        return continuous;
+    }
+
+    void reset(){
+        const bool wasContinuous = continuous;
+        *this = ReportRateAnalyzer();
+        continuous = wasContinuous;
+    }
+
+    void addReport(uint64_t time){
+        const uint64_t epoch = time / bucketLength;
+        const int bucket = int(epoch % rateBuckets);
+        if (bucketEpochs[bucket] != epoch){
+            bucketEpochs[bucket] = epoch;
+            bucketCounts[bucket] = 0;
+        }
+        bucketCounts[bucket]++;
+        if (reports++ == 0){
+            firstTime = time;
+            lastTime = time;
+            return;
+        }
+        if (time < lastTime){
+            lastTime = time;
+            return;
+        }
+        const double interval = double(time - lastTime) / 1e6;
+        const double arrival = double(time - firstTime) / 1e6;
+        lastTime = time;
+        histogram[binOf(interval)]++;
+        longestGap = std::max(longestGap, interval);
+
+        // How far apart the reports are on the schedule: the time since it started over the reports sent since then, which gets
+        // more exact the longer it runs.
+        const double period = scheduleReports ? (arrival - interval - scheduleStart) / double(scheduleReports) : interval;
+        double lost = 0.0;
+        if (continuous && scheduleReports >= warmupReports && period > 0.0){
+            lost = std::floor((arrival - nextArrival) / period + 1.0 - dropoutLateness);
+            if (lost >= 1.0){
+                if (lastDropoutLost && sinceDropout <= dropoutMerge){
+                    bursts[burstBin(lastDropoutLost)]--;
+                }
+                else {
+                    dropouts++;
+                    lastDropoutLost = 0;
+                }
+                sinceDropout = 0;
+                lostReports += uint64_t(lost);
+                lastDropoutTime = time;
+                lastDropoutLost += uint64_t(lost);
+                bursts[burstBin(lastDropoutLost)]++;
+                nextArrival += lost * period;
+                scheduleReports += uint64_t(lost);
+            }
+            else if (arrival < nextArrival - period){
+                // Far too early: the schedule was off (e.g. the pad changed its rate), so it starts over.
+                scheduleStart = arrival - interval;
+                scheduleReports = 0;
+            }
+        }
+        sinceDropout++;
+        nextArrival = scheduleReports ? nextArrival + period + (arrival - nextArrival) / 8.0 : arrival + period;
+        scheduleReports++;
+        if (lost >= 1.0){
+            // An interval with lost reports in it says nothing about the intervals of the pad.
+            return;
+        }
+        intervals++;
+        const double distance = interval - intervalMean;
+        intervalMean += distance / double(intervals);
+        intervalSquares += distance * (interval - intervalMean);
+        expectedInterval = intervals == 1 ? interval : expectedInterval + (interval - expectedInterval) / 32.0;
+        jitter += (std::fabs(interval - expectedInterval) - jitter) / 16.0;
+    }
+
+    static int binOf(double interval){
+        if (interval < firstBinStart){
+            return 0;
+        }
+        const int bin = int(std::log2(interval / firstBinStart) * binsPerOctave);
+        return std::min(bin, histogramBins - 1);
+    }
+
+    // Where a bin of the histogram starts, in ms. The first bin also holds everything shorter, and the last everything longer.
+    static double binStart(int bin){
+        return firstBinStart * std::exp2(double(bin) / binsPerOctave);
+    }
+
+    uint64_t getReports() const{
+        return reports;
+    }
+
+    // Reports per second over the last second before now, or since the first report if that was later.
+    double getRate(uint64_t now) const{
+        if (!reports || now < firstTime){
+            return 0.0;
+        }
+        const uint64_t nowEpoch = now / bucketLength;
+        uint64_t count = 0;
+        for (int bucket = 0; bucket < rateBuckets; bucket++){
+            if (bucketEpochs[bucket] + rateBuckets > nowEpoch && bucketEpochs[bucket] <= nowEpoch){
+                count += bucketCounts[bucket];
+            }
+        }
+        const uint64_t covered = std::min(now - firstTime, (rateBuckets - 1) * bucketLength + now % bucketLength);
+        return covered ? double(count) * 1e9 / double(covered) : 0.0;
+    }
+
+    // Reports per second since the first report.
+    double getAverageRate() const{
+        return lastTime > firstTime ? double(reports - 1) * 1e9 / double(lastTime - firstTime) : 0.0;
+    }
+
+    double getMeanInterval() const{
+        return intervalMean;
+    }
+
+    double getIntervalDeviation() const{
+        return intervals > 1 ? std::sqrt(intervalSquares / double(intervals - 1)) : 0.0;
+    }
+
+    double getExpectedInterval() const{
+        return expectedInterval;
+    }
+
+    double getJitter() const{
+        return jitter;
+    }
+
+    const uint64_t * getHistogram() const{
+        return histogram;
+    }
+
+    uint64_t getDropouts() const{
+        return dropouts;
+    }
+
+    uint64_t getLostReports() const{
+        return lostReports;
+    }
+
+    // Of the reports that were sent, the part that never arrived.
+    double getLossRatio() const{
+        return reports + lostReports ? double(lostReports) / double(reports + lostReports) : 0.0;
+    }
+
+    double getLongestGap() const{
+        return longestGap;
+    }
+
+    uint64_t getLastDropoutTime() const{
+        return lastDropoutTime;
+    }
+
+    // Dropouts by how many reports they lost, see burstBins.
+    const uint64_t * getBursts() const{
+        return bursts;
+    }
+
+    static std::string burstLabel(int bin){
+        char text[32];
+        const uint64_t last = uint64_t(1) << bin;
+        const uint64_t first = bin < 2 ? last : last / 2 + 1;
+        if (bin == burstBins - 1){
+            snprintf(text, sizeof(text), "%llu+", (unsigned long long)first);
+        }
+        else if (first == last){
+            snprintf(text, sizeof(text), "%llu", (unsigned long long)first);
+        }
+        else {
+            snprintf(text, sizeof(text), "%llu-%llu", (unsigned long long)first, (unsigned long long)last);
+        }
+        return text;
+    }
+
+    // Everything above as text, for saving along with a bug report.
+    std::string format(uint64_t now) const{
+        std::string text;
+        char line[160];
+        snprintf(line, sizeof(line), "Reports: %llu over %.3f s (%s)\n", (unsigned long long)reports,
+            lastTime > firstTime ? double(lastTime - firstTime) / 1e9 : 0.0, continuous ? "continuous" : "only on changes");
+        text += line;
+        snprintf(line, sizeof(line), "Rate: %.1f per second over the last second, %.1f on average\n", getRate(now), getAverageRate());
+        text += line;
+        snprintf(line, sizeof(line), "Interval: %.3f ms mean, %.3f ms deviation, %.3f ms expected, %.3f ms jitter, %.3f ms longest\n",
+            getMeanInterval(), getIntervalDeviation(), getExpectedInterval(), getJitter(), getLongestGap());
+        text += line;
+        if (continuous){
+            snprintf(line, sizeof(line), "Dropouts: %llu, lost reports: %llu (%.3f%%)\n", (unsigned long long)dropouts,
+                (unsigned long long)lostReports, getLossRatio() * 100.0);
+            text += line;
+            for (int bin = 0; bin < burstBins; bin++){
+                snprintf(line, sizeof(line), "  %s lost: %llu\n", burstLabel(bin).c_str(), (unsigned long long)bursts[bin]);
+                text += line;
+            }
+        }
+        text += "Intervals (ms):\n";
+        for (int bin = 0; bin < histogramBins; bin++){
+            if (histogram[bin]){
+                snprintf(line, sizeof(line), "  %.3f - %.3f: %llu\n", binStart(bin), binStart(bin + 1), (unsigned long long)histogram[bin]);
+                text += line;
+            }
+        }
+        return text;
+    }
+};
+
+// Timestamps every report of every pad as SDL takes it in (through an event watch), and keeps a ReportRateAnalyzer for each pad.
+// SDL only reads the pads when events are pumped, which the app does once per frame, so all the reports of a frame would arrive
+// at once: while the monitor is open, a thread has SDL read them about every millisecond instead. The pads' sensors are turned
+// on, since only pads with sensors report all the time (every report has one update of each sensor, and the updates of the first
+// sensor seen are counted); pads without them are counted by their button, axis and touchpad updates.
+class ReportRateMonitor{
+public:
+    // Button, axis and touchpad events of a pad this close together came from the same report.
+    static constexpr uint64_t sameReport = 250000;
+    static constexpr std::chrono::microseconds updateInterval{1000};
+
+private:
+    struct Pad{
+        ReportRateAnalyzer analyzer;
+        uint64_t lastEvent = 0;
+        int sensor = SDL_SENSOR_INVALID;
+        bool sensorsRequested = false;
+
+        Pad(){
+            analyzer.setContinuous(false);
+        }
+    };
+
+    mutable std::mutex mutex;
+    std::map<SDL_JoystickID, Pad> pads;
+    std::thread updater;
+    std::atomic<bool> updating{false};
+    bool watching = false;
+
+    // sensor is the SDL_SensorType of a sensor update, and SDL_SENSOR_INVALID for other updates.
+    void addEvent(SDL_JoystickID id, int sensor, uint64_t time){
+        std::lock_guard<std::mutex> lock(mutex);
+        Pad & pad = pads[id];
+        if (sensor != SDL_SENSOR_INVALID && pad.sensor == SDL_SENSOR_INVALID){
+            // From the first sensor update on, only the updates of that sensor count, and they come all the time.
+            pad.sensor = sensor;
+            pad.analyzer.reset();
+            pad.analyzer.setContinuous(true);
+        }
+        if (sensor != pad.sensor){
+            return;
+        }
+        if (sensor == SDL_SENSOR_INVALID){
+            if (pad.lastEvent && time - pad.lastEvent < sameReport){
+                return;
+            }
+            pad.lastEvent = time;
+        }
+        pad.analyzer.addReport(time);
+    }
+
+    static int SDLCALL watch(void * userData, SDL_Event * event){
+        ReportRateMonitor * monitor = static_cast<ReportRateMonitor *>(userData);
+        switch (event->type){
+            case SDL_CONTROLLERSENSORUPDATE:
+                monitor->addEvent(event->csensor.which, event->csensor.sensor, now());
+                break;
+            case SDL_CONTROLLERAXISMOTION:
+                monitor->addEvent(event->caxis.which, SDL_SENSOR_INVALID, now());
+                break;
+            case SDL_CONTROLLERBUTTONDOWN:
+            case SDL_CONTROLLERBUTTONUP:
+                monitor->addEvent(event->cbutton.which, SDL_SENSOR_INVALID, now());
+                break;
+            case SDL_CONTROLLERTOUCHPADDOWN:
+            case SDL_CONTROLLERTOUCHPADMOTION:
+            case SDL_CONTROLLERTOUCHPADUP:
+                monitor->addEvent(event->ctouchpad.which, SDL_SENSOR_INVALID, now());
+                break;
+            case SDL_CONTROLLERDEVICEREMOVED:{
+                std::lock_guard<std::mutex> lock(monitor->mutex);
+                monitor->pads.erase(event->cdevice.which);
+                break;
+            }
+            default:
+                break;
+        }
+        return 1;
+    }
+
+public:
+    // SDL_GetPerformanceCounter() in ns
+    static uint64_t now(){
+        const uint64_t counter = SDL_GetPerformanceCounter();
+        const uint64_t frequency = SDL_GetPerformanceFrequency();
+        return counter / frequency * 1000000000ull + counter % frequency * 1000000000ull / frequency;
+    }
+
+    ReportRateMonitor() = default;
+    ReportRateMonitor(const ReportRateMonitor &) = delete;
+    ReportRateMonitor & operator=(const ReportRateMonitor &) = delete;
+
+    ~ReportRateMonitor(){
+        close();
+    }
+
+    void open(){
+        close();
+        SDL_AddEventWatch(watch, this);
+        watching = true;
+        updating = true;
+        updater = std::thread([this]{
+            while (updating){
+                SDL_GameControllerUpdate();
+                std::this_thread::sleep_for(updateInterval);
+            }
+        });
+    }
+
+    void close(){
+        if (updater.joinable()){
+            updating = false;
+            updater.join();
+        }
+        if (watching){
+            SDL_DelEventWatch(watch, this);
+            watching = false;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        pads.clear();
+    }
+
+    bool isOpen() const{
+        return watching;
+    }
+
+    // Call once per frame: turns on the sensors of pads once they are known to have them.
+    void update(const std::vector<SDLGamepad *> & gamepads){
+        for (SDLGamepad * gamepad: gamepads){
+            if (!gamepad->capabilitiesReady()){
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                Pad & pad = pads[gamepad->id];
+                if (pad.sensorsRequested){
+                    continue;
+                }
+                pad.sensorsRequested = true;
+            }
+            if (gamepad->hasGyroscope()){
+                gamepad->setSensor(SDL_SENSOR_GYRO, SDL_TRUE);
+            }
+            if (gamepad->hasAccelerometer()){
+                gamepad->setSensor(SDL_SENSOR_ACCEL, SDL_TRUE);
+            }
+        }
+    }
+
+    // Copies the analyzer of a pad, for showing it without holding up the thread that adds reports.
+    bool getAnalyzer(SDL_JoystickID id, ReportRateAnalyzer & analyzer) const{
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = pads.find(id);
+        if (found == pads.end()){
+            return false;
+        }
+        analyzer = found->second.analyzer;
+        return true;
+    }
+
+    void reset(SDL_JoystickID id){
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = pads.find(id);
+        if (found != pads.end()){
+            found->second.analyzer.reset();
+            found->second.lastEvent = 0;
+        }
+    }
+
+    // Writes a pad's statistics to a text file, under the pad's name.
+    bool exportText(SDL_JoystickID id, const std::string & name, const std::string & path) const{
+        ReportRateAnalyzer analyzer;
+        if (!getAnalyzer(id, analyzer)){
+            return false;
+        }
+        const std::string text = name + "\n" + analyzer.format(now());
+        FILE * file = fopen(path.c_str(), "wb");
+        if (!file){
+            return false;
+        }
+        bool ok = fwrite(text.data(), 1, text.size(), file) == text.size();
+        ok = (fclose(file) == 0) && ok;
+        return ok;
+    }
+};
@@ -1,8 +1,12 @@
 #pragma once
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_gamecontroller.h>
+#include "axis_calibration.h"
+#include "gamepad_capability_cache.h"
 
+#include <atomic>
 #include <string>
+#include <thread>
 #include <vector>
 #include <iostream>
 
@@ -57,6 +61,23 @@ struct SDLGamepadSensorState {
     float Gyroscope[3] = {0.0f, 0.0f, 0.0f};
 };
 
+// Dead zones used wherever stick and trigger values get turned into navigation or digital inputs, so they all agree.
+struct SDLGamepadDeadzones{
+    // SDL_gamecontroller.h suggests 8000 out of 32767 for the sticks.
+    float stick = 8000.0f / float(SDL_JOYSTICK_AXIS_MAX);
+    // XInput's XINPUT_GAMEPAD_TRIGGER_THRESHOLD (30 out of 255).
+    float trigger = 30.0f / 255.0f;
+
+    // Rescales the part of a 0.0 - 1.0 value past the dead zone to 0.0 - 1.0. Pass the half of a stick axis you want, e.g. -y for up.
+    static float apply(float value, float deadzone){
+        if (value <= deadzone){
+            return 0.0f;
+        }
+        value = (value - deadzone) / (1.0f - deadzone);
+        return value > 1.0f ? 1.0f : value;
+    }
+};
+
 struct SDLGamepadTouchpadFinger{
     Uint8 state;
     float x = 0.0f;
@@ -79,6 +100,49 @@ private:
     bool gyroSupported = false;
     bool accelSupported = false;
     bool touchpadSupported = false;
+    bool ledSupported = false;
+    // The capabilities above are written by the probe thread, and only read once this is set.
+    std::atomic<bool> capabilitiesProbed{false};
+    std::thread probeThread;
+    GamepadCapabilityCache * capabilityCache = nullptr;
+    std::string capabilityKey = "";
+    GamepadCalibrationStore * calibrationStore = nullptr;
+    std::string calibrationKey = "";
+
+    void applyCapabilities(const SDLGamepadCapabilities & capabilities){
+        hapticsSupported = capabilities.haptics;
+        triggerHapticsSupported = capabilities.triggerHaptics;
+        accelSupported = capabilities.accelerometer;
+        gyroSupported = capabilities.gyroscope;
+        sensorSupported = accelSupported || gyroSupported;
+        ledSupported = capabilities.led;
+        touchpadCount = int(capabilities.touchpadFingers.size());
+        touchpadSupported = touchpadCount != 0;
+        touchpads.resize(touchpadCount);
+        for (int i = 0; i < touchpadCount; i++){
+            touchpads[i].fingers.resize(capabilities.touchpadFingers[i]);
+        }
+        capabilitiesProbed.store(true, std::memory_order_release);
+    }
+
+    // Rumble probes and the sensor and touchpad queries can take tens of ms over Bluetooth, so they run on their own thread
+    // instead of stalling the frame that handles SDL_CONTROLLERDEVICEADDED. SDL serializes joystick calls across threads.
+    void probeCapabilities(){
+        SDLGamepadCapabilities capabilities;
+        capabilities.haptics = SDL_GameControllerRumble(controller, 0, 0, 0) == 0;
+        capabilities.triggerHaptics = SDL_GameControllerRumbleTriggers(controller, 0, 0, 0) == 0;
+        capabilities.accelerometer = SDL_GameControllerHasSensor(controller, SDL_SENSOR_ACCEL);
+        capabilities.gyroscope = SDL_GameControllerHasSensor(controller, SDL_SENSOR_GYRO);
+        capabilities.led = SDL_GameControllerHasLED(controller);
+        const int count = SDL_GameControllerGetNumTouchpads(controller);
+        for (int i = 0; i < count; i++){
+            capabilities.touchpadFingers.push_back(SDL_GameControllerGetNumTouchpadFingers(controller, i));
+        }
+        if (capabilityCache){
+            capabilityCache->store(capabilityKey, capabilities);
+        }
+        applyCapabilities(capabilities);
+    }
 
 public:
     //What's below was added pureply for the purpose of ImGui.
@@ -90,6 +154,8 @@ public:
     } vibration;
 
     SDL_Color led_color{0, 0, 255, 255};
+    // Shared by all gamepads.
+    inline static SDLGamepadDeadzones deadzones;
     //Required stuff is below___________________
     SDL_JoystickID id;
     SDLGamepadState last_state;
@@ -101,37 +167,39 @@ public:
     bool gyroActive = false;
     bool accelActive = false;
     bool queryTouchpads = false;
+    // Learned from the axes while the pad is polled, and applied to them in pollState().
+    SDLGamepadCalibration calibration;
 
-    SDLGamepad(int index){
+    // The pad can be polled for buttons and axes right away, its other capabilities show up once capabilitiesReady() returns true.
+    // With a cache, models that were probed before get their capabilities straight away, and newly probed ones are added to it.
+    // With a calibration store, the pad starts out with what was learned about it last time, and adds what it learns when it's closed.
+    SDLGamepad(int index, GamepadCapabilityCache * cache = nullptr, GamepadCalibrationStore * calibrations = nullptr):
+        capabilityCache(cache), calibrationStore(calibrations){
         controller = SDL_GameControllerOpen(index);
         id = SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(controller));
         name = SDL_GameControllerName(controller);
-        if (SDL_GameControllerRumble(controller, 0, 0, 0) == 0){
-            hapticsSupported = true;
-        }
-        if (SDL_GameControllerRumbleTriggers(controller, 0, 0, 0) == 0){
-            triggerHapticsSupported = true;
-        }
-        if (SDL_GameControllerHasSensor(controller, SDL_SENSOR_ACCEL) || SDL_GameControllerHasSensor(controller, SDL_SENSOR_GYRO)){
-            sensorSupported = true;
-            if (SDL_GameControllerHasSensor(controller, SDL_SENSOR_ACCEL)){
-                accelSupported = true;
-            }
-            if (SDL_GameControllerHasSensor(controller, SDL_SENSOR_GYRO)){
-                gyroSupported = true;
-            }
+        if (calibrationStore){
+            calibrationKey = GamepadCalibrationStore::key(controller);
+            calibrationStore->find(calibrationKey, calibration);
         }
-        touchpadCount = SDL_GameControllerGetNumTouchpads(controller);
-        if (touchpadCount){
-            touchpadSupported = true;
-            touchpads.resize(touchpadCount);
-            for (int i = 0; i < touchpadCount; i++){
-                touchpads[i].fingers.resize(SDL_GameControllerGetNumTouchpadFingers(controller, i));
+        SDLGamepadCapabilities capabilities;
+        if (capabilityCache){
+            capabilityKey = GamepadCapabilityCache::key(controller);
+            if (capabilityCache->find(capabilityKey, capabilities)){
+                applyCapabilities(capabilities);
+                return;
             }
         }
+        probeThread = std::thread([this]{ probeCapabilities(); });
     }
 
     ~SDLGamepad(){
+        if (probeThread.joinable()){
+            probeThread.join();
+        }
+        if (calibrationStore && calibration.samples){
+            calibrationStore->store(calibrationKey, calibration);
+        }
         SDL_GameControllerClose(controller);
     }
 
@@ -139,32 +207,36 @@ public:
         return name;
     }
 
+    bool capabilitiesReady(){
+        return capabilitiesProbed.load(std::memory_order_acquire);
+    }
+
     SDL_GameController * getController(){
         return controller;
     }
 
     int getTouchpadCount(){
-        return touchpadCount;
+        return capabilitiesReady() ? touchpadCount : 0;
     }
 
     bool hasHaptics(){
-        return hapticsSupported;
+        return capabilitiesReady() && hapticsSupported;
     }
 
     bool hasTriggerHaptics(){
-        return triggerHapticsSupported;
+        return capabilitiesReady() && triggerHapticsSupported;
     }
 
     bool hasSensors(){
-        return sensorSupported;
+        return capabilitiesReady() && sensorSupported;
     }
 
     bool hasAccelerometer(){
-        return sensorSupported && accelSupported;
+        return hasSensors() && accelSupported;
     }
 
     bool hasGyroscope(){
-        return sensorSupported && gyroSupported;
+        return hasSensors() && gyroSupported;
     }
 
     bool hasAllSensors(){
@@ -172,7 +244,7 @@ public:
     }
 
     bool hasLED(){
-        return SDL_GameControllerHasLED(controller);
+        return capabilitiesReady() && ledSupported;
     }
 
     void setSensor(SDL_SensorType type, SDL_bool active){
@@ -187,13 +259,13 @@ public:
     }
 
     void setTouchpadSensing(bool active){
-        if (touchpadSupported){
+        if (capabilitiesReady() && touchpadSupported){
             queryTouchpads = active;
         }
     }
 
     void pollTouchpad(){
-        if (queryTouchpads){
+        if (queryTouchpads && capabilitiesReady()){
             for (int index = 0; index < touchpadCount; index++){
                 for (int finger = 0; finger < touchpads[index].fingers.size(); finger++){
                     SDL_GameControllerGetTouchpadFinger(controller, index, finger,
@@ -247,6 +319,10 @@ public:
         //Left and Right Trigger
         state.LeftTrigger = float(SDL_GameControllerGetAxis(controller, SDL_CONTROLLER_AXIS_TRIGGERLEFT)) / float(SDL_JOYSTICK_AXIS_MAX);
         state.RightTrigger = float(SDL_GameControllerGetAxis(controller, SDL_CONTROLLER_AXIS_TRIGGERRIGHT)) / float(SDL_JOYSTICK_AXIS_MAX);
+        // Centre, noise and range of worn sticks and triggers
+        float * const axes[SDLGamepadCalibration::axisCount] = {&state.LeftStick.x, &state.LeftStick.y, &state.RightStick.x,
+            &state.RightStick.y, &state.LeftTrigger, &state.RightTrigger};
+        calibration.process(axes);
 
         if (sensorEnabled){
             if (accelActive){
@@ -261,14 +337,14 @@ public:
 
     // left and right values go from 0.0 to 1.0, while duration is in ms.
     void Rumble(float left, float right, Uint32 duration){
-        if (hapticsSupported){
+        if (hasHaptics()){
             SDL_GameControllerRumble(controller, 0xFFFF*left, 0xFFFF*right, duration);
         }
     }
 
     // left and right trigger values go from 0.0 to 1.0, while duration is in ms.
     void RumbleTriggers(float left_trigger, float right_trigger, Uint32 duration){
-        if (triggerHapticsSupported){
+        if (hasTriggerHaptics()){
             SDL_GameControllerRumbleTriggers(controller, 0xFFFF*left_trigger, 0xFFFF*right_trigger, duration);
         }    
     }
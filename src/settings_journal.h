@@ -0,0 +1,378 @@
+#pragma once
+#include "imgui/imgui.h"
+#include "imgui/imgui_internal.h"  // ImHashData (CRC32)
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Keeps the ImGui settings (window positions and sizes, table columns...) in an append-only journal instead of imgui.ini.
+// ImGui normally formats every section and rewrites the whole imgui.ini a few seconds after any window moves, on the main thread.
+// With io.IniFilename = NULL, ImGui only raises io.WantSaveIniSettings, and update() then compares each section with the last saved
+// version, and hands just the ones that changed to a background thread, which appends them to the journal. When the journal has
+// grown to more than twice the size of the live sections, the thread rewrites it with one record per section (through a temporary
+// file that replaces the old one, so that a crash never loses the settings).
+//
+// File layout (all values are little endian, as written by the machine):
+//   header: "IMSJ", uint32 version
+//   record: uint32 CRC32 of the rest of the record, uint32 key length, uint32 body length (0xFFFFFFFF for a removed section),
+//           then the key (the section header, e.g. "[Window][Debug##Default]") and the body (the lines of the section, as in imgui.ini)
+// A record that is cut short or fails its CRC (e.g. the app was killed in the middle of a write) ends the journal, and the next
+// write compacts the file to get rid of it.
+namespace SettingsJournalFormat {
+    static constexpr char magic[4] = {'I', 'M', 'S', 'J'};
+    static constexpr uint32_t version = 1;
+    static constexpr uint32_t removedSection = 0xFFFFFFFF;
+    static constexpr size_t headerSize = 8;
+    // The journal is only compacted past this size, so that a few windows being dragged around don't rewrite it all the time.
+    static constexpr size_t minCompactSize = 64 * 1024;
+}
+
+class SettingsJournal {
+private:
+    struct Section {
+        std::string key;
+        std::string body;
+        bool removed = false;
+    };
+
+    std::string path;
+    std::vector<Section> sections;          // In the order in which they were first seen, so that the exported text keeps ImGui's order
+    std::map<std::string, size_t> sectionIndices;
+    size_t journalBytes = 0;                // What the journal will hold once the writer thread is done with the queue
+    size_t liveBytes = 0;                   // What a compacted journal would hold
+    bool needsCompaction = false;
+
+    // The writer thread appends queued records, or replaces the whole file when a job is a full snapshot.
+    struct WriteJob {
+        std::string bytes;
+        bool snapshot;
+    };
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::vector<WriteJob> queue;
+    bool writing = false;
+    bool stopping = false;
+    std::string writeError = "";
+
+    template <typename T> static void put(std::string & out, const T & value){
+        out.append((const char *)&value, sizeof(T));
+    }
+
+    static void appendRecord(std::string & out, const std::string & key, const std::string * body){
+        std::string record;
+        put(record, uint32_t(key.size()));
+        put(record, body ? uint32_t(body->size()) : SettingsJournalFormat::removedSection);
+        record += key;
+        if (body){
+            record += *body;
+        }
+        put(out, uint32_t(ImHashData(record.data(), record.size())));
+        out += record;
+    }
+
+    static size_t recordSize(const Section & section){
+        return 12 + section.key.size() + (section.removed ? 0 : section.body.size());
+    }
+
+    // Splits ImGui's ini text into "[Type][Name]" sections, each keeping its lines and the blank line that ends it.
+    static std::vector<std::pair<std::string, std::string>> splitSections(const char * text, size_t size){
+        std::vector<std::pair<std::string, std::string>> result;
+        const char * end = text + size;
+        while (text < end){
+            const char * lineEnd = (const char *)memchr(text, '\n', size_t(end - text));
+            lineEnd = lineEnd ? lineEnd + 1 : end;
+            std::string line(text, lineEnd);
+            if (line[0] == '['){
+                while (!line.empty() && (line.back() == '\n' || line.back() == '\r')){
+                    line.pop_back();
+                }
+                result.emplace_back(line, "");
+            }
+            else if (!result.empty()){
+                result.back().second += line;
+            }
+            text = lineEnd;
+        }
+        return result;
+    }
+
+    // Updates the in-memory copy, and returns true if the section changed.
+    bool setSection(const std::string & key, const std::string * body){
+        auto existing = sectionIndices.find(key);
+        if (existing == sectionIndices.end()){
+            if (!body){
+                return false;
+            }
+            sectionIndices[key] = sections.size();
+            sections.push_back({key, *body, false});
+            liveBytes += recordSize(sections.back());
+            return true;
+        }
+        Section & section = sections[existing->second];
+        if (body ? (!section.removed && section.body == *body) : section.removed){
+            return false;
+        }
+        if (!section.removed){
+            liveBytes -= recordSize(section);
+        }
+        section.removed = body == nullptr;
+        section.body = body ? *body : "";
+        if (!section.removed){
+            liveBytes += recordSize(section);
+        }
+        return true;
+    }
+
+    std::string snapshot(){
+        std::string bytes(SettingsJournalFormat::magic, 4);
+        put(bytes, SettingsJournalFormat::version);
+        for (const Section & section: sections){
+            if (!section.removed){
+                appendRecord(bytes, section.key, &section.body);
+            }
+        }
+        return bytes;
+    }
+
+    void enqueue(std::string bytes, bool isSnapshot){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back({std::move(bytes), isSnapshot});
+        }
+        wake.notify_one();
+    }
+
+    bool writeJob(const WriteJob & job){
+        if (job.snapshot){
+            // Written next to the journal and renamed over it, so that the old journal stays complete until the new one is
+            std::string temporaryPath = path + ".tmp";
+            FILE * file = fopen(temporaryPath.c_str(), "wb");
+            if (!file){
+                return false;
+            }
+            bool ok = fwrite(job.bytes.data(), 1, job.bytes.size(), file) == job.bytes.size();
+            ok = (fclose(file) == 0) && ok;
+            if (!ok){
+                return false;
+            }
+#ifdef _WIN32
+            remove(path.c_str()); // rename() doesn't replace existing files on Windows
+#endif
+            return rename(temporaryPath.c_str(), path.c_str()) == 0;
+        }
+        FILE * file = fopen(path.c_str(), "ab");
+        if (!file){
+            return false;
+        }
+        bool ok = fwrite(job.bytes.data(), 1, job.bytes.size(), file) == job.bytes.size();
+        return (fclose(file) == 0) && ok;
+    }
+
+    void writerLoop(){
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true){
+            wake.wait(lock, [&]{ return stopping || !queue.empty(); });
+            if (queue.empty()){
+                return;
+            }
+            std::vector<WriteJob> jobs;
+            jobs.swap(queue);
+            writing = true;
+
+            lock.unlock();
+            std::string error = "";
+            for (const WriteJob & job: jobs){
+                if (!writeJob(job)){
+                    error = "Could not write " + path;
+                }
+            }
+            lock.lock();
+
+            writing = false;
+            if (!error.empty()){
+                writeError = error;
+            }
+            idle.notify_all();
+        }
+    }
+
+    static bool readFile(const std::string & filePath, std::string & bytes){
+        FILE * file = fopen(filePath.c_str(), "rb");
+        if (!file){
+            return false;
+        }
+        char buffer[16 * 1024];
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0){
+            bytes.append(buffer, read);
+        }
+        fclose(file);
+        return true;
+    }
+
+    // Replays the journal into sections. Returns false if it doesn't exist or isn't a journal.
+    bool replay(){
+        std::string bytes;
+        if (!readFile(path, bytes)){
+            return false;
+        }
+        uint32_t fileVersion = 0;
+        if (bytes.size() < SettingsJournalFormat::headerSize || memcmp(bytes.data(), SettingsJournalFormat::magic, 4) != 0){
+            return false;
+        }
+        memcpy(&fileVersion, bytes.data() + 4, 4);
+        if (fileVersion != SettingsJournalFormat::version){
+            return false;
+        }
+
+        size_t offset = SettingsJournalFormat::headerSize;
+        while (offset + 12 <= bytes.size()){
+            uint32_t crc, keySize, bodySize;
+            memcpy(&crc, bytes.data() + offset, 4);
+            memcpy(&keySize, bytes.data() + offset + 4, 4);
+            memcpy(&bodySize, bytes.data() + offset + 8, 4);
+            const bool removed = bodySize == SettingsJournalFormat::removedSection;
+            const size_t payloadSize = size_t(keySize) + (removed ? 0 : size_t(bodySize));
+            if (payloadSize > bytes.size() - offset - 12 || uint32_t(ImHashData(bytes.data() + offset + 4, 8 + payloadSize)) != crc){
+                break;
+            }
+            std::string key(bytes.data() + offset + 12, keySize);
+            std::string body = removed ? "" : std::string(bytes.data() + offset + 12 + keySize, bodySize);
+            setSection(key, removed ? nullptr : &body);
+            offset += 12 + payloadSize;
+        }
+        journalBytes = bytes.size();
+        needsCompaction = offset != bytes.size();
+        return true;
+    }
+
+    void apply(const std::vector<std::pair<std::string, std::string>> & newSections, bool removeMissing){
+        std::string records;
+        std::map<std::string, bool> present;
+        for (const auto & section: newSections){
+            present[section.first] = true;
+            if (setSection(section.first, &section.second)){
+                appendRecord(records, section.first, &section.second);
+            }
+        }
+        if (removeMissing){
+            for (size_t i = 0; i < sections.size(); i++){
+                const std::string key = sections[i].key;
+                if (!sections[i].removed && !present.count(key) && setSection(key, nullptr)){
+                    appendRecord(records, key, nullptr);
+                }
+            }
+        }
+        if (records.empty() && !needsCompaction){
+            return;
+        }
+
+        journalBytes += records.size();
+        if (needsCompaction || (journalBytes > SettingsJournalFormat::minCompactSize && journalBytes > 2 * (liveBytes + SettingsJournalFormat::headerSize))){
+            std::string bytes = snapshot();
+            journalBytes = bytes.size();
+            needsCompaction = false;
+            enqueue(std::move(bytes), true);
+        }
+        else {
+            enqueue(std::move(records), false);
+        }
+    }
+
+public:
+    SettingsJournal(const std::string & journalPath): path(journalPath){
+        writer = std::thread([this]{ writerLoop(); });
+    }
+
+    // Whatever is still queued gets written before the thread stops. Call update() one last time before destroying the ImGui context.
+    ~SettingsJournal(){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        writer.join();
+    }
+
+    SettingsJournal(const SettingsJournal &) = delete;
+    SettingsJournal & operator=(const SettingsJournal &) = delete;
+
+    // Loads the journal into ImGui, or imports iniPath (an imgui.ini from before the journal existed) when there is no journal yet.
+    // Call it after ImGui::CreateContext() and before the first frame, with io.IniFilename = NULL.
+    bool load(const std::string & iniPath = ""){
+        if (!replay()){
+            journalBytes = 0;
+            needsCompaction = true;
+            return iniPath.empty() ? false : importText(iniPath);
+        }
+        std::string text = getText();
+        ImGui::LoadIniSettingsFromMemory(text.c_str(), text.size());
+        return true;
+    }
+
+    // Call once per frame. Only does something when ImGui asks for the settings to be saved (io.IniSavingRate after a change),
+    // or when force is set (e.g. at exit).
+    void update(bool force = false){
+        ImGuiIO & io = ImGui::GetIO();
+        if (!io.WantSaveIniSettings && !force){
+            return;
+        }
+        io.WantSaveIniSettings = false;
+        size_t size = 0;
+        const char * text = ImGui::SaveIniSettingsToMemory(&size);
+        apply(splitSections(text, size), true);
+    }
+
+    // Blocks until the writer thread has written everything that was queued so far.
+    void flush(){
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [&]{ return queue.empty() && !writing; });
+    }
+
+    // The settings in imgui.ini format.
+    std::string getText(){
+        std::string text;
+        for (const Section & section: sections){
+            if (!section.removed){
+                text += section.key + "\n" + section.body;
+            }
+        }
+        return text;
+    }
+
+    bool exportText(const std::string & iniPath){
+        FILE * file = fopen(iniPath.c_str(), "wb");
+        if (!file){
+            return false;
+        }
+        std::string text = getText();
+        bool ok = fwrite(text.data(), 1, text.size(), file) == text.size();
+        return (fclose(file) == 0) && ok;
+    }
+
+    // Loads an imgui.ini into ImGui and records its sections. Sections that aren't in the file are kept.
+    bool importText(const std::string & iniPath){
+        std::string text;
+        if (!readFile(iniPath, text)){
+            return false;
+        }
+        ImGui::LoadIniSettingsFromMemory(text.c_str(), text.size());
+        apply(splitSections(text.c_str(), text.size()), false);
+        return true;
+    }
+
+    // The last write error from the writer thread, if any.
+    std::string getError(){
+        std::lock_guard<std::mutex> lock(mutex);
+        return writeError;
+    }
+};
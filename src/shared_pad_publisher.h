@@ -0,0 +1,118 @@
+#pragma once
+#include "sdl_gamepad.h"
+#include "action_bindings.h"
+#include "shared_pad_states.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Writes the state of every polled pad into the shared region that SharedPadReader reads (see shared_pad_states.h), right after
+// the pads are polled. A pad keeps its slot for as long as it is connected, and its slot is marked disconnected when it goes away.
+// Sensor and touchpad values are only filled in while the pad polls them (gyroActive, accelActive, queryTouchpads).
+class SharedPadPublisher {
+private:
+    SharedPadWriter writer;
+    SDL_JoystickID slotIds[SharedPadFormat::maxPads];
+    std::string slotNames[SharedPadFormat::maxPads];
+
+    void writePad(int slot, SDLGamepad & pad){
+        writer.write(slot, [&](SharedPadFormat::PadState & state){
+            state.connected = 1;
+            state.instanceId = pad.id;
+            state.pollCount++;
+            state.timestamp = SharedPadWriter::now();
+            state.buttons = uint32_t(GamepadInput::packButtons(pad.state));
+            GamepadInput::packAxes(pad.state, state.axes);
+            state.sensors = 0;
+            if (pad.sensorEnabled && pad.accelActive){
+                memcpy(state.accelerometer, pad.sensor_state.Accelerometer, sizeof(state.accelerometer));
+                state.sensors |= SharedPadFormat::accelerometerValid;
+            }
+            if (pad.sensorEnabled && pad.gyroActive){
+                memcpy(state.gyroscope, pad.sensor_state.Gyroscope, sizeof(state.gyroscope));
+                state.sensors |= SharedPadFormat::gyroscopeValid;
+            }
+            // The touchpads are sized by the capability probe, so they are only looked at once it is done.
+            state.touchpadCount = 0;
+            if (pad.queryTouchpads && pad.capabilitiesReady()){
+                const int touchpads = std::min(int(pad.touchpads.size()), SharedPadFormat::maxTouchpads);
+                for (int touchpad = 0; touchpad < touchpads; touchpad++){
+                    const std::vector<SDLGamepadTouchpadFinger> & fingers = pad.touchpads[touchpad].fingers;
+                    for (int finger = 0; finger < SharedPadFormat::maxFingers; finger++){
+                        SharedPadFormat::Finger & shared = state.fingers[touchpad][finger];
+                        if (finger < int(fingers.size())){
+                            shared = {fingers[finger].state, fingers[finger].x, fingers[finger].y, fingers[finger].pressure};
+                        }
+                        else {
+                            shared = {0, 0.0f, 0.0f, 0.0f};
+                        }
+                    }
+                }
+                state.touchpadCount = uint32_t(touchpads);
+            }
+            memcpy(state.name, slotNames[slot].c_str(), slotNames[slot].size() + 1);
+        });
+    }
+
+public:
+    SharedPadPublisher(const std::string & name = SharedPadFormat::defaultName): writer(name){
+        for (int slot = 0; slot < SharedPadFormat::maxPads; slot++){
+            slotIds[slot] = -1;
+        }
+    }
+
+    bool open(){
+        for (int slot = 0; slot < SharedPadFormat::maxPads; slot++){
+            slotIds[slot] = -1;
+        }
+        return writer.open();
+    }
+
+    void close(){
+        writer.close();
+    }
+
+    bool isOpen() const{
+        return writer.isOpen();
+    }
+
+    // Call once per poll, after pollState() of every pad.
+    void publish(const std::vector<SDLGamepad *> & pads){
+        if (!writer.isOpen()){
+            return;
+        }
+        bool connected[SharedPadFormat::maxPads] = {};
+        for (SDLGamepad * pad: pads){
+            int slot = -1;
+            int freeSlot = -1;
+            for (int i = 0; i < SharedPadFormat::maxPads; i++){
+                if (slotIds[i] == pad->id){
+                    slot = i;
+                    break;
+                }
+                if (slotIds[i] == -1 && freeSlot == -1){
+                    freeSlot = i;
+                }
+            }
+            if (slot == -1){
+                // More pads than slots: the ones that connected last aren't published.
+                if (freeSlot == -1){
+                    continue;
+                }
+                slot = freeSlot;
+                slotIds[slot] = pad->id;
+                slotNames[slot] = pad->getName().substr(0, SharedPadFormat::nameLength - 1);
+            }
+            connected[slot] = true;
+            writePad(slot, *pad);
+        }
+        for (int slot = 0; slot < SharedPadFormat::maxPads; slot++){
+            if (slotIds[slot] != -1 && !connected[slot]){
+                writer.clear(slot);
+                slotIds[slot] = -1;
+            }
+        }
+        writer.published();
+    }
+};
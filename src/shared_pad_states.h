@@ -0,0 +1,342 @@
+#pragma once
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// The states of all polled pads, in a named shared memory region that other processes on the machine (an overlay, a recorder,
+// a game) can map and read at poll rate, without opening the devices themselves and without a syscall per read.
+// This header doesn't need SDL: a consumer includes it alone and uses SharedPadReader. The visualizer writes the region through
+// SharedPadPublisher (shared_pad_publisher.h) when started with "--publish-states".
+//
+// Every pad has a slot guarded by a seqlock: the publisher makes the slot's sequence odd, writes the state in place, and makes it
+// even again. A reader copies the state and keeps the copy only if the sequence was even and unchanged around it, so readers
+// never block the publisher, and a copy is never half of one poll and half of the next.
+//
+// The region is "SDL2GamepadStates" by default: a POSIX shared memory object ("/SDL2GamepadStates", in /dev/shm on Linux), or
+// a pagefile backed file mapping on Windows ("Local\SDL2GamepadStates"). Both are laid out as a SharedPadFormat::Region.
+namespace SharedPadFormat {
+    static constexpr char magic[4] = {'S', 'P', 'A', 'D'};
+    static constexpr uint32_t version = 1;
+    static constexpr const char * defaultName = "SDL2GamepadStates";
+    static constexpr int maxPads = 8;
+    static constexpr int maxTouchpads = 2;
+    static constexpr int maxFingers = 4;
+    static constexpr int nameLength = 64;
+
+    // Bits of PadState::sensors
+    static constexpr uint32_t accelerometerValid = 1;
+    static constexpr uint32_t gyroscopeValid = 2;
+
+    struct Finger {
+        uint32_t down;
+        float x;
+        float y;
+        float pressure;
+    };
+
+    // One poll of one pad. Buttons are bits in the order of GamepadInput::Button (A, B, X, Y, DPadUp, DPadDown, DPadLeft,
+    // DPadRight, LeftShoulder, RightShoulder, LeftStickClick, RightStickClick, Start, Back, Guide, Touchpad, Misc, Paddle1-4),
+    // axes are LeftX, LeftY, RightX, RightY (-1 to 1, y is positive down), LeftTrigger and RightTrigger (0 to 1).
+    struct PadState {
+        uint32_t connected;
+        int32_t instanceId;
+        uint64_t pollCount;
+        // std::chrono::steady_clock, in ns, which is the same clock in every process of the machine.
+        uint64_t timestamp;
+        uint32_t buttons;
+        float axes[6];
+        uint32_t sensors;
+        float accelerometer[3];
+        float gyroscope[3];
+        uint32_t touchpadCount;
+        Finger fingers[maxTouchpads][maxFingers];
+        char name[nameLength];
+    };
+
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> sequence;
+        PadState state;
+    };
+
+    struct alignas(64) Header {
+        char magic[4];
+        // Written last by the publisher, so a reader that sees the version sees the rest of the header.
+        std::atomic<uint32_t> version;
+        uint32_t slotCount;
+        uint32_t slotSize;
+        // Cleared when the publisher exits, and set again by the next one.
+        std::atomic<uint32_t> running;
+        // When the publisher last published (steady_clock ns), to tell a publisher that is gone without clearing running.
+        std::atomic<uint64_t> publishTime;
+    };
+
+    struct Region {
+        Header header;
+        Slot slots[maxPads];
+    };
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+        "The region is shared between processes, so its atomics can't be locks");
+}
+
+// A mapping of the region, shared by the reader and the publisher.
+class SharedPadMapping {
+private:
+#ifdef _WIN32
+    HANDLE mapping = NULL;
+#endif
+    SharedPadFormat::Region * view = nullptr;
+
+public:
+    ~SharedPadMapping(){
+        close();
+    }
+
+    // The publisher creates the region (or attaches to the one a previous publisher left behind), readers only open it.
+    bool open(const std::string & name, bool create){
+        close();
+        const size_t size = sizeof(SharedPadFormat::Region);
+#ifdef _WIN32
+        const std::string path = "Local\\" + name;
+        if (create){
+            mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, DWORD(size), path.c_str());
+        }
+        else {
+            mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, path.c_str());
+        }
+        void * bytes = mapping ? MapViewOfFile(mapping, create ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size) : nullptr;
+        if (!bytes){
+            close();
+            return false;
+        }
+#else
+        const std::string path = "/" + name;
+        int descriptor = create ? shm_open(path.c_str(), O_RDWR | O_CREAT, 0644) : shm_open(path.c_str(), O_RDONLY, 0);
+        if (descriptor < 0){
+            return false;
+        }
+        struct stat info;
+        if (fstat(descriptor, &info) != 0 || (create ? ftruncate(descriptor, off_t(size)) != 0 : size_t(info.st_size) < size)){
+            ::close(descriptor);
+            return false;
+        }
+        void * bytes = mmap(nullptr, size, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, descriptor, 0);
+        ::close(descriptor);
+        if (bytes == MAP_FAILED){
+            return false;
+        }
+#endif
+        view = (SharedPadFormat::Region *)bytes;
+        return true;
+    }
+
+    void close(){
+#ifdef _WIN32
+        if (view){
+            UnmapViewOfFile(view);
+        }
+        if (mapping){
+            CloseHandle(mapping);
+        }
+        mapping = NULL;
+#else
+        if (view){
+            munmap(view, sizeof(SharedPadFormat::Region));
+        }
+#endif
+        view = nullptr;
+    }
+
+    // Removes the name, so that the next publisher starts from a new region. Readers that have it mapped keep their view.
+    static void unlink(const std::string & name){
+#ifndef _WIN32
+        shm_unlink(("/" + name).c_str());
+#else
+        // A Windows mapping goes away with its last handle.
+        (void)name;
+#endif
+    }
+
+    SharedPadFormat::Region * region() const{
+        return view;
+    }
+};
+
+// The writing side of the region: creates it, and writes slots under their seqlocks. SharedPadPublisher fills the slots from
+// SDLGamepad, this is the part of it that doesn't need SDL.
+class SharedPadWriter {
+private:
+    std::string name;
+    SharedPadMapping mapping;
+    SharedPadFormat::Region * region = nullptr;
+
+public:
+    static uint64_t now(){
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    SharedPadWriter(const std::string & name = SharedPadFormat::defaultName): name(name){}
+
+    ~SharedPadWriter(){
+        close();
+    }
+
+    // Creates the region, or takes over the one a publisher that crashed left behind. Readers that still have that one mapped
+    // keep reading from it.
+    bool open(){
+        close();
+        if (!mapping.open(name, true)){
+            return false;
+        }
+        region = mapping.region();
+        SharedPadFormat::Header & header = region->header;
+        memcpy(header.magic, SharedPadFormat::magic, sizeof(SharedPadFormat::magic));
+        header.slotCount = SharedPadFormat::maxPads;
+        header.slotSize = sizeof(SharedPadFormat::Slot);
+        for (int slot = 0; slot < SharedPadFormat::maxPads; slot++){
+            // A sequence left odd by a crash would make readers wait for a write that never ends.
+            SharedPadFormat::Slot & shared = region->slots[slot];
+            shared.sequence.store(shared.sequence.load(std::memory_order_relaxed) & ~1u, std::memory_order_relaxed);
+            clear(slot);
+        }
+        header.publishTime.store(now(), std::memory_order_relaxed);
+        header.running.store(1, std::memory_order_relaxed);
+        header.version.store(SharedPadFormat::version, std::memory_order_release);
+        return true;
+    }
+
+    // Marks every slot disconnected and removes the region's name, so that readers know to open it again later.
+    void close(){
+        if (!region){
+            return;
+        }
+        for (int slot = 0; slot < SharedPadFormat::maxPads; slot++){
+            clear(slot);
+        }
+        region->header.running.store(0, std::memory_order_release);
+        mapping.close();
+        SharedPadMapping::unlink(name);
+        region = nullptr;
+    }
+
+    bool isOpen() const{
+        return region != nullptr;
+    }
+
+    // Calls write(PadState &) on the slot's state in place, between making its sequence odd and making it even again.
+    // The state still holds what was written last time.
+    template <typename Write> void write(int slot, Write && write){
+        SharedPadFormat::Slot & shared = region->slots[slot];
+        const uint32_t sequence = shared.sequence.load(std::memory_order_relaxed);
+        shared.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        write(shared.state);
+        shared.sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    void clear(int slot){
+        write(slot, [](SharedPadFormat::PadState & state){
+            memset(&state, 0, sizeof(state));
+            state.instanceId = -1;
+        });
+    }
+
+    // Call after writing the slots of a poll, so that readers can tell that the publisher is still alive.
+    void published(){
+        region->header.publishTime.store(now(), std::memory_order_release);
+    }
+};
+
+// Reads the pad states a publisher writes. Reading a slot is a copy of a few hundred bytes and two loads of its sequence,
+// so it can be done for every pad on every frame (or more often) without any cost to the publisher.
+//
+//     SharedPadReader reader;
+//     if (reader.open()){
+//         SharedPadFormat::PadState pad;
+//         for (int slot = 0; slot < reader.getSlotCount(); slot++){
+//             if (reader.read(slot, pad) && (pad.buttons & 1)){ ... A is down on pad.name ... }
+//         }
+//     }
+//
+// A publisher that exits clears running(). Open the reader again later to attach to the next one.
+class SharedPadReader {
+private:
+    SharedPadMapping mapping;
+    const SharedPadFormat::Region * region = nullptr;
+
+public:
+    bool open(const std::string & name = SharedPadFormat::defaultName){
+        region = nullptr;
+        if (!mapping.open(name, false)){
+            return false;
+        }
+        const SharedPadFormat::Header & header = mapping.region()->header;
+        if (header.version.load(std::memory_order_acquire) != SharedPadFormat::version
+            || memcmp(header.magic, SharedPadFormat::magic, sizeof(SharedPadFormat::magic)) != 0
+            || header.slotCount != SharedPadFormat::maxPads || header.slotSize != sizeof(SharedPadFormat::Slot)){
+            mapping.close();
+            return false;
+        }
+        region = mapping.region();
+        return true;
+    }
+
+    bool isOpen() const{
+        return region != nullptr;
+    }
+
+    int getSlotCount() const{
+        return region ? SharedPadFormat::maxPads : 0;
+    }
+
+    bool running() const{
+        return region && region->header.running.load(std::memory_order_acquire) != 0;
+    }
+
+    uint64_t publishTime() const{
+        return region ? region->header.publishTime.load(std::memory_order_acquire) : 0;
+    }
+
+    // Goes up with every write of the slot, so a reader can skip copying a slot that hasn't changed since its last read.
+    uint32_t writeCount(int slot) const{
+        return region ? region->slots[slot].sequence.load(std::memory_order_acquire) >> 1 : 0;
+    }
+
+    // Copies the last complete state of a slot. Returns false when no pad is connected to the slot, or when the publisher kept
+    // writing the slot through all of the attempts (which takes a publisher that died in the middle of a write).
+    bool read(int slot, SharedPadFormat::PadState & state) const{
+        if (!region || slot < 0 || slot >= SharedPadFormat::maxPads){
+            return false;
+        }
+        const SharedPadFormat::Slot & shared = region->slots[slot];
+        for (int attempt = 0; attempt < 10000; attempt++){
+            const uint32_t before = shared.sequence.load(std::memory_order_acquire);
+            if (before & 1){
+                continue;
+            }
+            memcpy(&state, &shared.state, sizeof(state));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (shared.sequence.load(std::memory_order_relaxed) == before){
+                return state.connected != 0;
+            }
+        }
+        return false;
+    }
+};
@@ -0,0 +1,110 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A small fixed size pool of worker threads, used for splitting per-frame work (like rasterizing screen tiles)
+// across all of the cores of the machine. The thread that calls parallelFor() also works on the items,
+// so a pool created with 1 thread simply runs everything inline.
+class WorkerPool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const std::function<void(int)> * job = nullptr;
+    int jobCount = 0;
+    std::atomic<int> nextItem{0};
+    int busyWorkers = 0;
+    unsigned int generation = 0;
+    bool stopping = false;
+
+    void runItems(){
+        for (int item = nextItem++; item < jobCount; item = nextItem++){
+            (*job)(item);
+        }
+    }
+
+    void workerLoop(){
+        unsigned int seenGeneration = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true){
+            wake.wait(lock, [&]{ return stopping || generation != seenGeneration; });
+            if (stopping){
+                return;
+            }
+            seenGeneration = generation;
+
+            lock.unlock();
+            runItems();
+            lock.lock();
+
+            if (--busyWorkers == 0){
+                finished.notify_one();
+            }
+        }
+    }
+
+public:
+    // A thread count of 0 (or less) uses one thread per logical CPU.
+    WorkerPool(int threadCount = 0){
+        if (threadCount <= 0){
+            threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+        }
+        for (int i = 1; i < threadCount; i++){
+            threads.emplace_back([this]{ workerLoop(); });
+        }
+    }
+
+    ~WorkerPool(){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto & thread: threads){
+            thread.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool & operator=(const WorkerPool &) = delete;
+
+    int getThreadCount(){
+        return int(threads.size()) + 1;
+    }
+
+    // Calls fn(0) to fn(count - 1) spread over the pool, and returns once all of the calls have finished.
+    // The order in which items run is unspecified, so each item must only touch its own data.
+    void parallelFor(int count, const std::function<void(int)> & fn){
+        if (count <= 0){
+            return;
+        }
+        if (threads.empty() || count == 1){
+            for (int i = 0; i < count; i++){
+                fn(i);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &fn;
+            jobCount = count;
+            nextItem = 0;
+            busyWorkers = int(threads.size());
+            generation++;
+        }
+        wake.notify_all();
+
+        runItems();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&]{ return busyWorkers == 0; });
+        job = nullptr;
+    }
+};
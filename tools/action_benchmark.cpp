@@ -0,0 +1,271 @@
+// Compares ActionMap, which compiles a binding table into bit masks, with testing the SDLGamepadState fields of every binding one
+// by one, both for speed and for giving the exact same actions (held, pressed and released) on every tick.
+// Also checks that a constexpr table and the same table loaded as text give the same actions.
+//
+// Usage: ActionBenchmark [--bindings N] [--pads N] [--ticks N]
+#include "../src/action_bindings.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// The straightforward way, kept here as the reference.
+static const size_t referenceButtonOffsets[GamepadInput::buttonCount] = {
+    offsetof(SDLGamepadState, A), offsetof(SDLGamepadState, B), offsetof(SDLGamepadState, X), offsetof(SDLGamepadState, Y),
+    offsetof(SDLGamepadState, DPadUp), offsetof(SDLGamepadState, DPadDown), offsetof(SDLGamepadState, DPadLeft),
+    offsetof(SDLGamepadState, DPadRight), offsetof(SDLGamepadState, LeftShoulder), offsetof(SDLGamepadState, RightShoulder),
+    offsetof(SDLGamepadState, LeftStickClick), offsetof(SDLGamepadState, RightStickClick), offsetof(SDLGamepadState, Start),
+    offsetof(SDLGamepadState, Back), offsetof(SDLGamepadState, Guide), offsetof(SDLGamepadState, Touchpad), offsetof(SDLGamepadState, Misc),
+    offsetof(SDLGamepadState, Paddle1), offsetof(SDLGamepadState, Paddle2), offsetof(SDLGamepadState, Paddle3), offsetof(SDLGamepadState, Paddle4),
+};
+
+static int ReferenceButton(const SDLGamepadState & state, int button){
+    return *(const int *)((const char *)&state + referenceButtonOffsets[button]);
+}
+
+static float ReferenceAxis(const SDLGamepadState & state, GamepadInput::Axis axis){
+    switch (axis){
+        case GamepadInput::LeftX: return state.LeftStick.x;
+        case GamepadInput::LeftY: return state.LeftStick.y;
+        case GamepadInput::RightX: return state.RightStick.x;
+        case GamepadInput::RightY: return state.RightStick.y;
+        case GamepadInput::LeftTrigger: return state.LeftTrigger;
+        default: return state.RightTrigger;
+    }
+}
+
+static bool ReferenceMatches(const ActionBinding & binding, const SDLGamepadState & state){
+    for (int button = 0; button < GamepadInput::buttonCount; button++){
+        if ((binding.buttons >> button) & 1){
+            if (!ReferenceButton(state, button)){
+                return false;
+            }
+        }
+        if ((binding.without >> button) & 1){
+            if (ReferenceButton(state, button)){
+                return false;
+            }
+        }
+    }
+    for (int i = 0; i < binding.thresholdCount; i++){
+        const AxisThreshold & threshold = binding.thresholds[i];
+        const float value = ReferenceAxis(state, threshold.axis);
+        if (threshold.comparison == GamepadInput::Greater ? !(value > threshold.value) : !(value < threshold.value)){
+            return false;
+        }
+    }
+    return true;
+}
+
+static void ReferenceActions(const std::vector<ActionBinding> & table, int actionCount, const SDLGamepadState & state, std::vector<char> & held){
+    held.assign(size_t(actionCount), 0);
+    for (const ActionBinding & binding: table){
+        if (ReferenceMatches(binding, state)){
+            held[size_t(binding.action)] = 1;
+        }
+    }
+}
+
+static std::vector<ActionBinding> MakeTable(int bindingCount, int actionCount){
+    // With both comparisons, these make exactly the 32 distinct thresholds there are bits for.
+    const float thresholdValues[] = {0.0f, 0.5f, -0.5f};
+    std::vector<ActionBinding> table;
+    for (int i = 0; i < bindingCount; i++){
+        ActionBinding binding(i % actionCount, 0);
+        for (int b = 0, count = 1 + rand() % 2; b < count; b++){
+            binding.buttons |= 1ull << (rand() % GamepadInput::buttonCount);
+        }
+        if (rand() % 3 == 0){
+            binding.without |= (1ull << (rand() % GamepadInput::buttonCount)) & ~binding.buttons;
+        }
+        if (rand() % 3 == 0){
+            GamepadInput::Axis axis = GamepadInput::Axis(rand() % GamepadInput::AxisCount);
+            float value = thresholdValues[rand() % 3];
+            if (axis >= GamepadInput::LeftTrigger){
+                value = value < 0.0f ? -value : value;
+            }
+            // Either comparison goes with either sign ("LeftY > -0.5" is the stick not pushed up far).
+            const GamepadInput::Comparison comparison = rand() % 2 ? GamepadInput::Greater : GamepadInput::Less;
+            binding.thresholds[binding.thresholdCount++] = {axis, comparison, value};
+        }
+        table.push_back(binding);
+    }
+    return table;
+}
+
+static SDLGamepadState MakeState(){
+    SDLGamepadState state;
+    int * buttons[GamepadInput::buttonCount] = {
+        &state.A, &state.B, &state.X, &state.Y, &state.DPadUp, &state.DPadDown, &state.DPadLeft, &state.DPadRight, &state.LeftShoulder,
+        &state.RightShoulder, &state.LeftStickClick, &state.RightStickClick, &state.Start, &state.Back, &state.Guide, &state.Touchpad,
+        &state.Misc, &state.Paddle1, &state.Paddle2, &state.Paddle3, &state.Paddle4,
+    };
+    for (int * button: buttons){
+        *button = rand() % 3 == 0;
+    }
+    // Whole steps of 0.25 land exactly on the thresholds now and then.
+    state.LeftStick.x = float(rand() % 9 - 4) * 0.25f;
+    state.LeftStick.y = float(rand() % 9 - 4) * 0.25f;
+    state.RightStick.x = float(rand() % 2001 - 1000) / 1000.0f;
+    state.RightStick.y = float(rand() % 2001 - 1000) / 1000.0f;
+    state.LeftTrigger = float(rand() % 5) * 0.25f;
+    state.RightTrigger = float(rand() % 1001) / 1000.0f;
+    return state;
+}
+
+// A fixed ruleset, compiled when the benchmark is.
+enum ExampleAction {Jump, Fire, Aim, Pause, QuickSave, WalkUp, ExampleActionCount};
+static constexpr ActionBinding exampleTable[] = {
+    {Jump, GamepadInput::A, GamepadInput::LeftShoulder},
+    {Fire, GamepadInput::None, {GamepadInput::RightTrigger, GamepadInput::Greater, 0.5f}},
+    {Aim, GamepadInput::None, {GamepadInput::LeftTrigger, GamepadInput::Greater, 0.5f}},
+    {Pause, GamepadInput::Start},
+    {QuickSave, GamepadInput::LeftShoulder | GamepadInput::A},
+    {WalkUp, GamepadInput::None, {GamepadInput::LeftY, GamepadInput::Less, -0.5f}},
+    {WalkUp, GamepadInput::DPadUp},
+};
+static constexpr auto exampleProgram = compileActionBindings(exampleTable);
+static_assert(exampleProgram.ok && exampleProgram.thresholdCount == 3 && exampleProgram.actionCount == ExampleActionCount, "");
+static_assert(exampleProgram.bindings[4].required == (GamepadInput::LeftShoulder | GamepadInput::A), "");
+
+static const char * exampleText =
+    "# The same ruleset as exampleTable\n"
+    "Jump = A + !LeftShoulder\n"
+    "Fire = RightTrigger > 0.5\n"
+    "Aim = LeftTrigger > 0.5\n"
+    "Pause = Start\n"
+    "QuickSave = LeftShoulder + A\n"
+    "WalkUp = LeftY < -0.5\n"
+    "WalkUp = DPadUp\n";
+
+int main(int argc, char * argv[]){
+    int bindingCount = 400;
+    int padCount = 16;
+    int ticks = 20000;
+    for (int i = 1; i < argc; i++){
+        if (strcmp(argv[i], "--bindings") == 0 && i + 1 < argc){
+            bindingCount = std::max(1, atoi(argv[++i]));
+        }
+        if (strcmp(argv[i], "--pads") == 0 && i + 1 < argc){
+            padCount = std::max(1, atoi(argv[++i]));
+        }
+        if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc){
+            ticks = std::max(2, atoi(argv[++i]));
+        }
+    }
+    srand(1234);
+    const int actionCount = std::max(1, bindingCount / 3);
+    std::vector<ActionBinding> table = MakeTable(bindingCount, actionCount);
+    ActionMap actions;
+    if (!actions.load(table.data(), table.size())){
+        std::cout << "The table has too many thresholds" << std::endl;
+        return 1;
+    }
+
+    // A few hundred distinct states, cycled through so that making them isn't what gets timed.
+    std::vector<SDLGamepadState> states;
+    for (int i = 0; i < 509; i++){
+        states.push_back(MakeState());
+    }
+
+    int mismatches = 0;
+    std::vector<std::vector<char>> previous(padCount);
+    std::vector<char> held;
+    for (int tick = 0; tick < 200; tick++){
+        for (int pad = 0; pad < padCount; pad++){
+            const SDLGamepadState & state = states[size_t(tick * padCount + pad) % states.size()];
+            actions.update(pad, state);
+            ReferenceActions(table, actionCount, state, held);
+            for (int action = 0; action < actionCount; action++){
+                const bool was = !previous[size_t(pad)].empty() && previous[size_t(pad)][size_t(action)];
+                const bool is = held[size_t(action)];
+                if (actions.actionHeld(pad, action) != is || actions.actionPressed(pad, action) != (is && !was)
+                    || actions.actionReleased(pad, action) != (!is && was)){
+                    mismatches++;
+                }
+            }
+            previous[size_t(pad)] = held;
+        }
+    }
+
+    ActionMap fromProgram, fromText;
+    fromProgram.load(exampleProgram);
+    if (!fromText.loadText(exampleText) || fromText.actionIndex("WalkUp") != WalkUp){
+        std::cout << "Could not load the example ruleset from text" << std::endl;
+        return 1;
+    }
+    for (size_t i = 0; i < states.size(); i++){
+        fromProgram.update(0, states[i]);
+        fromText.update(0, states[i]);
+        uint64_t bits = 0;
+        evaluateActionBindings(exampleProgram.bindings, exampleProgram.bindingCount, packActionInput(exampleProgram.thresholds, exampleProgram.thresholdCount, states[i]), &bits);
+        std::vector<ActionBinding> exampleVector(std::begin(exampleTable), std::end(exampleTable));
+        ReferenceActions(exampleVector, ExampleActionCount, states[i], held);
+        for (int action = 0; action < ExampleActionCount; action++){
+            if (fromProgram.actionHeld(0, action) != bool(held[size_t(action)]) || fromText.actionHeld(0, action) != bool(held[size_t(action)])
+                || bool((bits >> action) & 1) != bool(held[size_t(action)])){
+                mismatches++;
+            }
+        }
+    }
+
+    // Thresholds at 0 go the way they are written: "LeftY < 0" is the stick pushed up and "RightTrigger > 0" the trigger pulled,
+    // and neither is on at rest.
+    ActionMap zeroThresholds;
+    if (!zeroThresholds.loadText("Up = LeftY < 0\nFire = RightTrigger > 0\nNotUp = LeftY > -0\n")){
+        std::cout << "Could not load thresholds at 0 from text" << std::endl;
+        return 1;
+    }
+    const int up = zeroThresholds.actionIndex("Up"), fire = zeroThresholds.actionIndex("Fire"), notUp = zeroThresholds.actionIndex("NotUp");
+    const float stickValues[] = {-1.0f, -0.25f, 0.0f, 0.25f, 1.0f};
+    for (float stick: stickValues){
+        for (float trigger: stickValues){
+            if (trigger < 0.0f){
+                continue;
+            }
+            SDLGamepadState state;
+            state.LeftStick.y = stick;
+            state.RightTrigger = trigger;
+            zeroThresholds.update(0, state);
+            if (zeroThresholds.actionHeld(0, up) != (stick < 0.0f) || zeroThresholds.actionHeld(0, fire) != (trigger > 0.0f)
+                || zeroThresholds.actionHeld(0, notUp) != (stick > 0.0f)){
+                std::cout << "Thresholds at 0 match the wrong way (LeftY " << stick << ", RightTrigger " << trigger << ")" << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    if (mismatches){
+        std::cout << mismatches << " actions differ from the reference!" << std::endl;
+        return 1;
+    }
+    std::cout << "All actions match the reference (" << table.size() << " bindings, " << actionCount << " actions, " << padCount << " pads)" << std::endl;
+
+    // The sums keep the compiler from optimizing the evaluation away.
+    size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < ticks; tick++){
+        for (int pad = 0; pad < padCount; pad++){
+            ReferenceActions(table, actionCount, states[size_t(tick * padCount + pad) % states.size()], held);
+            sink += size_t(held[size_t(tick % actionCount)]);
+        }
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < ticks; tick++){
+        for (int pad = 0; pad < padCount; pad++){
+            actions.update(pad, states[size_t(tick * padCount + pad) % states.size()]);
+        }
+        sink += size_t(actions.actionPressed(tick % padCount, tick % actionCount));
+    }
+    auto end = std::chrono::steady_clock::now();
+    const double reference = std::chrono::duration<double, std::micro>(middle - start).count() / double(ticks);
+    const double compiled = std::chrono::duration<double, std::micro>(end - middle).count() / double(ticks);
+    std::cout << "Field by field: " << reference << " us per tick" << std::endl;
+    std::cout << "ActionMap:      " << compiled << " us per tick" << std::endl;
+    return sink == 42 ? 2 : 0;
+}
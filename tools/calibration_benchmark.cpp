@@ -0,0 +1,369 @@
+// Checks SDLGamepadCalibration against simulated worn pads: every axis rests off centre with some noise and stops short of its
+// ends by a different amount in each direction, and the stream of polls mixes resting, full pushes, partial moves and spikes.
+// After learning from it, the centre and extents must be close to the simulated ones, a resting pad must read exactly 0 and a
+// full push must read 1, and a calibration saved and loaded through GamepadCalibrationStore must correct the same way. Holding a
+// stick still off centre (like walking slowly) for a long time, reaching the spot from the centre or back from a full push,
+// must not move any centre.
+// Then times conditioning a poll's six axes with the plain division of pollState(), and with the calibration added: learning
+// from every poll as it does until every axis settled, learning from one poll in SDLGamepadCalibration::settledInterval after
+// that, and only applying.
+//
+// Usage: CalibrationBenchmark [--pads N] [--polls N] [--passes N] [--hold-seconds N]
+#include "../src/axis_calibration.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+struct SimulatedAxis{
+    float center;
+    float noise;
+    float negativeExtent;
+    float positiveExtent;
+};
+
+struct SimulatedPad{
+    SimulatedAxis axes[SDLGamepadCalibration::axisCount];
+};
+
+static SimulatedPad MakePad(std::mt19937 & random){
+    std::uniform_real_distribution<float> offset(-0.12f, 0.12f);
+    std::uniform_real_distribution<float> noise(0.0003f, 0.003f);
+    std::uniform_real_distribution<float> extent(0.78f, 0.98f);
+    SimulatedPad pad;
+    for (int axis = 0; axis < SDLGamepadCalibration::axisCount; axis++){
+        SimulatedAxis & simulated = pad.axes[axis];
+        simulated.noise = noise(random);
+        if (SDLGamepadCalibration::isTrigger(axis)){
+            simulated.center = std::fabs(offset(random)) * 0.5f;
+            simulated.negativeExtent = 0.0f;
+            simulated.positiveExtent = extent(random) - simulated.center;
+        }
+        else {
+            // Short enough that the pad doesn't hit the ends of the raw range.
+            simulated.center = offset(random);
+            simulated.negativeExtent = std::min(extent(random), 0.995f - std::fabs(simulated.center));
+            simulated.positiveExtent = std::min(extent(random), 0.995f - std::fabs(simulated.center));
+        }
+    }
+    return pad;
+}
+
+// What SDL_GameControllerGetAxis() would report for an axis pushed to intent (-1.0 - 1.0, 0.0 - 1.0 for triggers).
+static int16_t RawAxis(const SimulatedAxis & axis, bool trigger, float intent, float noise){
+    float value = axis.center + intent * (intent < 0.0f ? axis.negativeExtent : axis.positiveExtent) + noise * axis.noise;
+    value = std::max(trigger ? 0.0f : -1.0f, std::min(value, 1.0f));
+    return int16_t(std::lround(value * float(SDL_JOYSTICK_AXIS_MAX)));
+}
+
+// A poll's intent for every axis, and whether the pad is resting or pushed all the way.
+struct Poll{
+    float intent[SDLGamepadCalibration::axisCount];
+    bool resting;
+};
+
+// Phases of a few dozen polls: resting, a push to the end, a partial move, or a single spike.
+static std::vector<Poll> MakeIntents(std::mt19937 & random, int polls){
+    std::vector<Poll> intents;
+    std::uniform_int_distribution<int> phase(0, 5);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    std::uniform_int_distribution<int> gate(0, 7);
+    while (int(intents.size()) < polls){
+        const int kind = phase(random);
+        const int length = 20 + int(unit(random) * 60.0f);
+        // Full pushes go to one of the eight directions of the gate, partial moves anywhere.
+        float direction[2] = {angle(random), angle(random)};
+        if (kind == 2){
+            direction[0] = float(gate(random)) * 0.78539816f;
+            direction[1] = float(gate(random)) * 0.78539816f;
+        }
+        const float reach = kind == 3 ? 0.2f + unit(random) * 0.6f : 1.0f;
+        const float trigger[2] = {unit(random) < 0.5f ? reach : 0.0f, unit(random) < 0.5f ? reach : 0.0f};
+        for (int i = 0; i < length; i++){
+            Poll poll{};
+            poll.resting = kind <= 1;
+            if (kind == 2 || kind == 3){
+                // Ramp up over a third of the phase, hold, and let go for the last poll.
+                const float amount = i == length - 1 ? 0.0f : std::min(1.0f, float(i) * 3.0f / float(length)) * reach;
+                for (int stick = 0; stick < 2; stick++){
+                    poll.intent[stick * 2] = std::cos(direction[stick]) * amount;
+                    poll.intent[stick * 2 + 1] = std::sin(direction[stick]) * amount;
+                    poll.intent[4 + stick] = trigger[stick] * amount / reach;
+                }
+            }
+            if (kind == 4 && i == length / 2){
+                // A glitch: one poll at the end of every axis.
+                for (float & intent: poll.intent){
+                    intent = 1.0f;
+                }
+            }
+            intents.push_back(poll);
+        }
+    }
+    intents.resize(size_t(polls));
+    return intents;
+}
+
+static void ReferenceConditioning(const int16_t raw[SDLGamepadCalibration::axisCount], float out[SDLGamepadCalibration::axisCount]){
+    for (int axis = 0; axis < SDLGamepadCalibration::axisCount; axis++){
+        out[axis] = float(raw[axis]) / float(SDL_JOYSTICK_AXIS_MAX);
+    }
+}
+
+static void CalibratedConditioning(SDLGamepadCalibration & calibration, const int16_t raw[SDLGamepadCalibration::axisCount],
+    float out[SDLGamepadCalibration::axisCount]){
+    ReferenceConditioning(raw, out);
+    float * const axes[SDLGamepadCalibration::axisCount] = {&out[0], &out[1], &out[2], &out[3], &out[4], &out[5]};
+    calibration.process(axes);
+}
+
+// Makes the raw polls of a pad for a stream of intents.
+static std::vector<int16_t> MakeRaw(const SimulatedPad & pad, const std::vector<Poll> & intents, std::mt19937 & random){
+    std::normal_distribution<float> gaussian(0.0f, 1.0f);
+    std::vector<int16_t> raw;
+    raw.reserve(intents.size() * SDLGamepadCalibration::axisCount);
+    for (const Poll & poll: intents){
+        for (int axis = 0; axis < SDLGamepadCalibration::axisCount; axis++){
+            raw.push_back(RawAxis(pad.axes[axis], SDLGamepadCalibration::isTrigger(axis), poll.intent[axis], gaussian(random)));
+        }
+    }
+    return raw;
+}
+
+// Holds the left stick still at 0.15 to the right for holdPolls, a few times over: reached from the centre, or pulled back to it
+// from a full push (which is a return, like letting go), and let go in between. Returns how far the centres moved.
+static float HoldOffCentre(SDLGamepadCalibration & calibration, const SimulatedPad & pad, std::mt19937 & random, int holdPolls){
+    std::vector<Poll> intents;
+    for (int hold = 0; hold < 6; hold++){
+        for (int i = 0; i < 30; i++){
+            intents.push_back(Poll{});
+        }
+        Poll poll{};
+        if (hold % 2){
+            for (int i = 1; i <= 20; i++){
+                poll.intent[0] = std::min(1.0f, float(i) / 10.0f);
+                intents.push_back(poll);
+            }
+        }
+        for (int i = 0; i < holdPolls; i++){
+            poll.intent[0] = 0.15f;
+            intents.push_back(poll);
+        }
+    }
+    for (int i = 0; i < 30; i++){
+        intents.push_back(Poll{});
+    }
+    float before[SDLGamepadCalibration::axisCount];
+    for (int axis = 0; axis < SDLGamepadCalibration::axisCount; axis++){
+        before[axis] = calibration.learners[axis].center;
+    }
+    const std::vector<int16_t> raw = MakeRaw(pad, intents, random);
+    for (size_t i = 0; i < raw.size(); i += SDLGamepadCalibration::axisCount){
+        float out[SDLGamepadCalibration::axisCount];
+        CalibratedConditioning(calibration, &raw[i], out);
+    }
+    float moved = 0.0f;
+    for (int axis = 0; axis < SDLGamepadCalibration::axisCount; axis++){
+        moved = std::max(moved, std::fabs(calibration.learners[axis].center - before[axis]));
+    }
+    return moved;
+}
+
+// Counts how the calibration reads a fresh stream, without learning from it.
+static bool CheckCorrections(SDLGamepadCalibration calibration, const SimulatedPad & pad, std::mt19937 & random, int polls,
+    double & restingZero, double & fullOne, double & uncalibratedZero){
+    calibration.learning = false;
+    std::vector<Poll> intents;
+    for (int i = 0; i < polls; i++){
+        Poll poll{};
+        poll.resting = i % 2 == 0;
+        if (!poll.resting){
+            // Every axis pushed all the way, in the direction that is the shorter one on this pad.
+            for (int axis = 0; axis < SDLGamepadCalibration::axisCount; axis++){
+                const SimulatedAxis & simulated = pad.axes[axis];
+                poll.intent[axis] = SDLGamepadCalibration::isTrigger(axis) || simulated.positiveExtent < simulated.negativeExtent ? 1.0f : -1.0f;
+            }
+        }
+        intents.push_back(poll);
+    }
+    const std::vector<int16_t> raw = MakeRaw(pad, intents, random);
+    uint64_t zero = 0, one = 0, plainZero = 0, resting = 0, full = 0;
+    for (int i = 0; i < polls; i++){
+        float plain[SDLGamepadCalibration::axisCount];
+        float corrected[SDLGamepadCalibration::axisCount];
+        ReferenceConditioning(&raw[size_t(i) * SDLGamepadCalibration::axisCount], plain);
+        CalibratedConditioning(calibration, &raw[size_t(i) * SDLGamepadCalibration::axisCount], corrected);
+        for (int axis = 0; axis < SDLGamepadCalibration::axisCount; axis++){
+            if (std::fabs(corrected[axis]) > 1.0f){
+                std::cout << "Axis " << SDLGamepadCalibration::axisNames[axis] << " read " << corrected[axis] << std::endl;
+                return false;
+            }
+            if (intents[size_t(i)].resting){
+                resting++;
+                zero += corrected[axis] == 0.0f;
+                plainZero += plain[axis] == 0.0f;
+            }
+            else {
+                full++;
+                one += std::fabs(corrected[axis]) >= 0.999f;
+            }
+        }
+    }
+    restingZero = double(zero) / double(resting);
+    fullOne = double(one) / double(full);
+    uncalibratedZero = double(plainZero) / double(resting);
+    return true;
+}
+
+int main(int argc, char * argv[]){
+    int padCount = 64;
+    int polls = 20000;
+    int passes = 500;
+    int holdSeconds = 20;
+    for (int i = 1; i < argc; i++){
+        if (strcmp(argv[i], "--pads") == 0 && i + 1 < argc){
+            padCount = std::max(1, atoi(argv[++i]));
+        }
+        if (strcmp(argv[i], "--polls") == 0 && i + 1 < argc){
+            polls = std::max(1000, atoi(argv[++i]));
+        }
+        if (strcmp(argv[i], "--passes") == 0 && i + 1 < argc){
+            passes = std::max(1, atoi(argv[++i]));
+        }
+        if (strcmp(argv[i], "--hold-seconds") == 0 && i + 1 < argc){
+            holdSeconds = std::max(1, atoi(argv[++i]));
+        }
+    }
+    std::mt19937 random(1234);
+    const char * path = "calibration_benchmark.txt";
+    GamepadCalibrationStore store(path);
+    std::vector<SDLGamepadCalibration> learned(static_cast<size_t>(padCount));
+    std::vector<SimulatedPad> pads;
+    double worstCenter = 0.0, worstExtent = 0.0, worstZero = 1.0, worstOne = 1.0, plainZero = 0.0;
+    for (int p = 0; p < padCount; p++){
+        pads.push_back(MakePad(random));
+        const SimulatedPad & pad = pads.back();
+        const std::vector<int16_t> raw = MakeRaw(pad, MakeIntents(random, polls), random);
+        SDLGamepadCalibration & calibration = learned[size_t(p)];
+        for (size_t i = 0; i < raw.size(); i += SDLGamepadCalibration::axisCount){
+            float out[SDLGamepadCalibration::axisCount];
+            CalibratedConditioning(calibration, &raw[i], out);
+        }
+        for (int axis = 0; axis < SDLGamepadCalibration::axisCount; axis++){
+            const SimulatedAxis & simulated = pad.axes[axis];
+            const AxisLearner & learner = calibration.learners[axis];
+            worstCenter = std::max(worstCenter, double(std::fabs(learner.center - simulated.center)));
+            worstExtent = std::max(worstExtent, double(std::fabs(learner.positiveExtent() - simulated.positiveExtent)));
+            if (!SDLGamepadCalibration::isTrigger(axis)){
+                worstExtent = std::max(worstExtent, double(std::fabs(learner.negativeExtent() - simulated.negativeExtent)));
+            }
+        }
+        double restingZero, fullOne, uncalibratedZero;
+        if (!CheckCorrections(calibration, pad, random, 2000, restingZero, fullOne, uncalibratedZero)){
+            return 1;
+        }
+        worstZero = std::min(worstZero, restingZero);
+        worstOne = std::min(worstOne, fullOne);
+        plainZero += uncalibratedZero / double(padCount);
+        store.store("serial:pad" + std::to_string(p), calibration);
+    }
+    std::cout << "Learned " << padCount << " pads from " << polls << " polls each: centres within " << worstCenter
+        << ", extents within " << worstExtent << std::endl;
+    std::cout << "At rest, at least " << worstZero * 100.0 << "% of the axes read 0 (" << plainZero * 100.0
+        << "% without calibration), pushed all the way at least " << worstOne * 100.0 << "% read 1" << std::endl;
+    if (worstCenter > 0.005 || worstExtent > 0.02 || worstZero < 0.999 || worstOne < 0.999){
+        std::cout << "The calibration didn't converge!" << std::endl;
+        return 1;
+    }
+
+    // Save, load into another store, and compare the corrections.
+    if (!store.save()){
+        std::cout << "Could not save " << path << std::endl;
+        return 1;
+    }
+    GamepadCalibrationStore loaded(path);
+    const bool read = loaded.load();
+    remove(path);
+    if (!read || loaded.size() != size_t(padCount)){
+        std::cout << "Could not load the saved calibrations" << std::endl;
+        return 1;
+    }
+    for (int p = 0; p < padCount; p++){
+        SDLGamepadCalibration calibration;
+        if (!loaded.find("serial:pad" + std::to_string(p), calibration)){
+            std::cout << "Pad " << p << " is missing from the saved calibrations" << std::endl;
+            return 1;
+        }
+        learned[size_t(p)].refresh();
+        for (int axis = 0; axis < SDLGamepadCalibration::axisCount; axis++){
+            for (float value = -1.0f; value <= 1.0f; value += 1.0f / 64.0f){
+                if (std::fabs(calibration.corrections[axis].apply(value) - learned[size_t(p)].corrections[axis].apply(value)) > 1e-5f){
+                    std::cout << "Pad " << p << " corrects " << SDLGamepadCalibration::axisNames[axis] << " differently after loading" << std::endl;
+                    return 1;
+                }
+            }
+        }
+    }
+    std::cout << "The saved calibrations load back the same" << std::endl;
+
+    // Hold a stick off centre for a while, polled at 60 fps, and the centres must stay put.
+    float worstMove = 0.0f;
+    double worstHeldZero = 1.0;
+    for (int p = 0; p < padCount; p++){
+        SDLGamepadCalibration calibration = learned[size_t(p)];
+        worstMove = std::max(worstMove, HoldOffCentre(calibration, pads[size_t(p)], random, holdSeconds * 60));
+        double restingZero, fullOne, uncalibratedZero;
+        if (!CheckCorrections(calibration, pads[size_t(p)], random, 2000, restingZero, fullOne, uncalibratedZero)){
+            return 1;
+        }
+        worstHeldZero = std::min(worstHeldZero, restingZero);
+    }
+    std::cout << "Holding a stick off centre for " << holdSeconds << " s moved the centres at most " << worstMove
+        << ", and afterwards at least " << worstHeldZero * 100.0 << "% of the resting axes read 0" << std::endl;
+    if (worstMove > 0.005f || worstHeldZero < 0.999){
+        std::cout << "Holding a stick moved its centre!" << std::endl;
+        return 1;
+    }
+
+    // Passes over one pad's polls, and the fastest pass counts, since the time of a few ns is easily lost in the noise of the
+    // machine. The sums keep the compiler from optimizing the work away.
+    const int pollCount = 4096;
+    const std::vector<int16_t> raw = MakeRaw(pads[0], MakeIntents(random, pollCount), random);
+    float sink = 0.0f;
+    auto time = [&](auto && condition){
+        double best = 1e30;
+        for (int pass = 0; pass < passes; pass++){
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < pollCount; i++){
+                float out[SDLGamepadCalibration::axisCount];
+                condition(&raw[size_t(i) * SDLGamepadCalibration::axisCount], out);
+                sink += out[i % SDLGamepadCalibration::axisCount];
+            }
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count() / double(pollCount));
+        }
+        return best;
+    };
+    const double reference = time([](const int16_t * in, float * out){ ReferenceConditioning(in, out); });
+    SDLGamepadCalibration unsettled = learned[0];
+    const double everyPoll = time([&](const int16_t * in, float * out){
+        unsettled.settled = false;
+        CalibratedConditioning(unsettled, in, out);
+    });
+    SDLGamepadCalibration learning = learned[0];
+    const double withLearning = time([&](const int16_t * in, float * out){ CalibratedConditioning(learning, in, out); });
+    SDLGamepadCalibration applying = learned[0];
+    applying.learning = false;
+    const double applyOnly = time([&](const int16_t * in, float * out){ CalibratedConditioning(applying, in, out); });
+    std::cout << "Division only:        " << reference << " ns per poll of " << SDLGamepadCalibration::axisCount << " axes" << std::endl;
+    std::cout << "Calibrated, learning: " << everyPoll << " ns per poll until settled, " << withLearning << " ns per poll after" << std::endl;
+    std::cout << "Calibrated, applying: " << applyOnly << " ns per poll" << std::endl;
+    return sink == 42.0f ? 2 : 0;
+}
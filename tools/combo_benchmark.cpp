@@ -0,0 +1,242 @@
+// Compares ComboRecognizer, which compiles the combos into one automaton, with scanning the input history of every pad for every
+// combo on every frame, both for speed and for recognizing the exact same combos on the exact same frames.
+//
+// Usage: ComboBenchmark [--combos N] [--pads N] [--frames N]
+#include "../src/combo_recognizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// The straightforward way, kept here as the reference: the events of each pad, and every combo checked against their end.
+struct ReferenceEvent{
+    bool buttonEvent;
+    int direction;
+    uint64_t buttons;
+    uint32_t frame;
+};
+
+struct ReferencePad{
+    std::deque<ReferenceEvent> events;
+    int direction = 5;
+    uint64_t buttons = 0;
+};
+
+static bool ReferenceEndsWith(const std::deque<ReferenceEvent> & events, const ComboDefinition & combo){
+    const size_t count = combo.steps.size();
+    if (events.size() < count){
+        return false;
+    }
+    for (size_t i = 0; i < count; i++){
+        const ComboStep & step = combo.steps[i];
+        const ReferenceEvent & event = events[events.size() - count + i];
+        const bool matches = step.buttons == 0 ? (!event.buttonEvent && event.direction == step.direction)
+            : (event.buttonEvent && (step.direction == 0 || step.direction == event.direction) && (event.buttons & step.buttons) == step.buttons);
+        if (!matches){
+            return false;
+        }
+        if (i > 0 && combo.gapFrames && event.frame - events[events.size() - count + i - 1].frame > combo.gapFrames){
+            return false;
+        }
+    }
+    return !combo.totalFrames || events.back().frame - events[events.size() - count].frame <= combo.totalFrames;
+}
+
+static void ReferenceUpdate(ReferencePad & pad, const std::vector<ComboDefinition> & combos, uint64_t relevant, const SDLGamepadState & state,
+    uint32_t frame, std::vector<int> & recognized){
+    recognized.clear();
+    const int direction = ComboInput::direction(state, 0.5f);
+    const uint64_t buttons = GamepadInput::packButtons(state);
+    const uint64_t pressed = buttons & ~pad.buttons;
+    pad.buttons = buttons;
+    std::vector<ReferenceEvent> newEvents;
+    if (direction != pad.direction){
+        pad.direction = direction;
+        newEvents.push_back({false, direction, 0, frame});
+    }
+    if (pressed & relevant){
+        newEvents.push_back({true, direction, pressed, frame});
+    }
+    for (const ReferenceEvent & event: newEvents){
+        pad.events.push_back(event);
+        if (pad.events.size() > 64){
+            pad.events.pop_front();
+        }
+        for (size_t c = 0; c < combos.size(); c++){
+            if (ReferenceEndsWith(pad.events, combos[c])){
+                recognized.push_back(int(c));
+            }
+        }
+    }
+    std::sort(recognized.begin(), recognized.end());
+}
+
+static const uint64_t comboButtons[] = {GamepadInput::A, GamepadInput::B, GamepadInput::X, GamepadInput::Y, GamepadInput::LeftShoulder, GamepadInput::RightShoulder};
+
+static std::vector<ComboDefinition> MakeCombos(int count){
+    const char * motions[] = {"236", "214", "623", "421", "41236", "63214", "656", "454", "22", "2363214", "8", "2"};
+    std::vector<ComboDefinition> combos;
+    for (int i = 0; i < count; i++){
+        ComboDefinition combo;
+        combo.name = "Move " + std::to_string(i);
+        const char * motion = motions[rand() % 12];
+        for (const char * c = motion; *c; c++){
+            combo.steps.push_back({*c - '0', 0});
+        }
+        for (int b = 0, presses = rand() % 3; b < presses; b++){
+            ComboStep step;
+            step.buttons = comboButtons[rand() % 6] | (rand() % 4 == 0 ? comboButtons[rand() % 6] : 0);
+            step.direction = rand() % 3 == 0 ? 1 + rand() % 9 : 0;
+            combo.steps.push_back(step);
+        }
+        combo.gapFrames = rand() % 2 ? 6 + rand() % 8 : 0;
+        combo.totalFrames = rand() % 2 ? 15 + rand() % 30 : 0;
+        combos.push_back(combo);
+    }
+    return combos;
+}
+
+static void SetDirection(SDLGamepadState & state, int direction){
+    state.DPadLeft = (direction - 1) % 3 == 0;
+    state.DPadRight = (direction - 1) % 3 == 2;
+    state.DPadDown = direction <= 3;
+    state.DPadUp = direction >= 7;
+}
+
+static void SetButtons(SDLGamepadState & state, uint64_t buttons){
+    state.A = (buttons & GamepadInput::A) != 0;
+    state.B = (buttons & GamepadInput::B) != 0;
+    state.X = (buttons & GamepadInput::X) != 0;
+    state.Y = (buttons & GamepadInput::Y) != 0;
+    state.LeftShoulder = (buttons & GamepadInput::LeftShoulder) != 0;
+    state.RightShoulder = (buttons & GamepadInput::RightShoulder) != 0;
+}
+
+// The input of a pad, frame by frame: mostly random combos performed with random timing, with noise in between.
+static std::vector<SDLGamepadState> MakeInput(const std::vector<ComboDefinition> & combos, int frames){
+    std::vector<SDLGamepadState> input;
+    int direction = 5;
+    while (int(input.size()) < frames){
+        if (rand() % 3){
+            const ComboDefinition & combo = combos[size_t(rand()) % combos.size()];
+            for (const ComboStep & step: combo.steps){
+                for (int wait = rand() % 6; wait > 0; wait--){
+                    SDLGamepadState state;
+                    SetDirection(state, direction);
+                    input.push_back(state);
+                }
+                SDLGamepadState state;
+                if (step.buttons){
+                    direction = step.direction ? step.direction : direction;
+                    SetButtons(state, step.buttons);
+                }
+                else {
+                    direction = step.direction;
+                }
+                SetDirection(state, direction);
+                input.push_back(state);
+            }
+        }
+        else {
+            SDLGamepadState state;
+            direction = 1 + rand() % 9;
+            SetDirection(state, direction);
+            SetButtons(state, rand() % 2 ? comboButtons[rand() % 6] : 0);
+            state.Start = rand() % 4 == 0;
+            input.push_back(state);
+        }
+    }
+    input.resize(size_t(frames));
+    return input;
+}
+
+int main(int argc, char * argv[]){
+    int comboCount = 300;
+    int padCount = 8;
+    int frames = 20000;
+    for (int i = 1; i < argc; i++){
+        if (strcmp(argv[i], "--combos") == 0 && i + 1 < argc){
+            comboCount = std::max(1, atoi(argv[++i]));
+        }
+        if (strcmp(argv[i], "--pads") == 0 && i + 1 < argc){
+            padCount = std::max(1, atoi(argv[++i]));
+        }
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc){
+            frames = std::max(1, atoi(argv[++i]));
+        }
+    }
+    srand(1234);
+    std::vector<ComboDefinition> combos = MakeCombos(comboCount);
+    ComboRecognizer recognizer;
+    auto compileStart = std::chrono::steady_clock::now();
+    if (!recognizer.load(combos)){
+        std::cout << "Could not compile the combos" << std::endl;
+        return 1;
+    }
+    const double compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileStart).count();
+    uint64_t relevant = 0;
+    for (const ComboDefinition & combo: combos){
+        for (const ComboStep & step: combo.steps){
+            relevant |= step.buttons;
+        }
+    }
+    std::vector<std::vector<SDLGamepadState>> inputs;
+    for (int pad = 0; pad < padCount; pad++){
+        inputs.push_back(MakeInput(combos, frames));
+    }
+
+    ComboRecognizer text;
+    if (!text.loadText("Fireball = 2 3 6 X gap 8 total 20\nDash = 6 5 6 gap 6\n# comment\nSuper = 2 3 6 2 3 6 X+Y\nUppercut = 6 2 3 3+X\n")
+        || text.comboIndex("Super") != 2 || text.getCombo(3).steps[3].direction != 3 || text.getCombo(0).gapFrames != 8){
+        std::cout << "Could not load combos from text" << std::endl;
+        return 1;
+    }
+
+    int mismatches = 0;
+    size_t recognizedCount = 0;
+    std::vector<ReferencePad> reference(padCount);
+    std::vector<int> expected;
+    for (int frame = 0; frame < frames; frame++){
+        for (int pad = 0; pad < padCount; pad++){
+            recognizer.update(pad, inputs[size_t(pad)][size_t(frame)], uint32_t(frame));
+            ReferenceUpdate(reference[size_t(pad)], combos, relevant, inputs[size_t(pad)][size_t(frame)], uint32_t(frame), expected);
+            mismatches += recognizer.recognized(pad) != expected;
+            recognizedCount += expected.size();
+        }
+    }
+    if (mismatches){
+        std::cout << mismatches << " frames recognize other combos than the reference!" << std::endl;
+        return 1;
+    }
+    std::cout << "All " << recognizedCount << " recognized combos match the reference (" << combos.size() << " combos, " << padCount
+        << " pads, " << recognizer.getStateCount() << " states, compiled in " << compileMs << " ms)" << std::endl;
+
+    // The sums keep the compiler from optimizing the recognizing away.
+    size_t sink = 0;
+    std::vector<ReferencePad> timedReference(padCount);
+    ComboRecognizer timed;
+    timed.load(combos);
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++){
+        for (int pad = 0; pad < padCount; pad++){
+            ReferenceUpdate(timedReference[size_t(pad)], combos, relevant, inputs[size_t(pad)][size_t(frame)], uint32_t(frame), expected);
+            sink += expected.size();
+        }
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++){
+        for (int pad = 0; pad < padCount; pad++){
+            timed.update(pad, inputs[size_t(pad)][size_t(frame)], uint32_t(frame));
+            sink += timed.recognized(pad).size();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "History scan:      " << std::chrono::duration<double, std::micro>(middle - start).count() / double(frames) << " us per frame" << std::endl;
+    std::cout << "ComboRecognizer:   " << std::chrono::duration<double, std::micro>(end - middle).count() / double(frames) << " us per frame" << std::endl;
+    return sink == 42 ? 2 : 0;
+}
@@ -0,0 +1,304 @@
+// Runs DSUServer on a local port with a made up client: the client asks for the protocol version and the slots, subscribes to
+// all of them, and checks every data packet it gets (CRC, slot, buttons, sticks, one packet per sensor sample with the sample's
+// values, timestamps and packet numbers that only go up). Then times a frame of 8 pads with their sensors at 1000 Hz against the
+// straightforward way, a packet built from scratch and a sendto() for every sample.
+//
+// Usage: DSUBenchmark [--port N] [--frames N] [--samples N]
+#include "../src/dsu_server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+static void CloseSocket(SOCKET handle){
+    closesocket(handle);
+}
+#else
+typedef int SOCKET;
+static void CloseSocket(int handle){
+    close(handle);
+}
+#endif
+
+static const int padCount = 8;
+
+static SDLGamepadState MakeState(int pad, int frame){
+    SDLGamepadState state;
+    state.A = (frame + pad) % 2;
+    state.Y = (frame + pad) % 3 == 0;
+    state.DPadLeft = (frame + pad) % 5 == 0;
+    state.Start = pad == 3;
+    state.LeftStick.x = float((frame * 7 + pad) % 201 - 100) / 100.0f;
+    state.LeftStick.y = -1.0f;
+    state.RightTrigger = float(frame % 11) / 10.0f;
+    return state;
+}
+
+// The gyroscope value of a sample says which pad, frame and sample it is, so the client can check it got the right one.
+static float SampleValue(int pad, int frame, int sample){
+    return float(pad * 1000 + (frame % 100) * 10 + sample);
+}
+
+static void FeedSamples(DSUServer & server, int frame, int samples){
+    for (int i = 0; i < samples; i++){
+        for (int pad = 0; pad < padCount; pad++){
+            SDL_ControllerSensorEvent event{};
+            event.type = SDL_CONTROLLERSENSORUPDATE;
+            event.which = 100 + pad;
+            event.sensor = SDL_SENSOR_GYRO;
+            event.data[0] = SampleValue(pad, frame, i) / 57.2957795f;
+            server.addSensorEvent(event);
+            event.sensor = SDL_SENSOR_ACCEL;
+            event.data[0] = 0.0f;
+            event.data[1] = SDL_STANDARD_GRAVITY;
+            server.addSensorEvent(event);
+        }
+    }
+}
+
+static void SendRequest(SOCKET client, const sockaddr_in & server, uint32_t message, const std::vector<uint8_t> & payload){
+    std::vector<uint8_t> packet(size_t(DSUProtocol::headerSize + 4) + payload.size());
+    memcpy(packet.data(), "DSUC", 4);
+    DSUProtocol::write16(packet.data() + 4, DSUProtocol::version);
+    DSUProtocol::write16(packet.data() + 6, uint16_t(packet.size() - DSUProtocol::headerSize));
+    DSUProtocol::write32(packet.data() + 12, 1234);
+    DSUProtocol::write32(packet.data() + 16, message);
+    std::copy(payload.begin(), payload.end(), packet.begin() + DSUProtocol::headerSize + 4);
+    DSUProtocol::sealPacket(packet.data(), int(packet.size()));
+    sendto(client, (const char *)packet.data(), int(packet.size()), 0, (const sockaddr *)&server, sizeof(server));
+}
+
+struct ClientCheck {
+    int versions = 0;
+    int infos = 0;
+    int connectedInfos = 0;
+    uint64_t data = 0;
+    uint64_t errors = 0;
+    uint32_t lastPacketNumber = 0;
+    uint64_t lastTimestamp[padCount] = {};
+    int samplesOfFrame[padCount] = {};
+};
+
+static void CheckPacket(ClientCheck & check, uint8_t * packet, int size, int frame){
+    if (size < 20 || memcmp(packet, "DSUS", 4) != 0 || DSUProtocol::headerSize + DSUProtocol::read16(packet + 6) != size){
+        check.errors++;
+        return;
+    }
+    const uint32_t crc = DSUProtocol::read32(packet + 8);
+    DSUProtocol::write32(packet + 8, 0);
+    if (DSUProtocol::crc32(packet, size_t(size)) != crc){
+        check.errors++;
+        return;
+    }
+    const uint32_t message = DSUProtocol::read32(packet + 16);
+    if (message == DSUProtocol::versionMessage){
+        check.versions++;
+        check.errors += DSUProtocol::read16(packet + 20) != DSUProtocol::version;
+        return;
+    }
+    if (message == DSUProtocol::infoMessage){
+        check.infos++;
+        check.connectedInfos += packet[21] == DSUProtocol::slotConnected;
+        return;
+    }
+    if (message != DSUProtocol::dataMessage || size != DSUProtocol::dataPacketSize){
+        check.errors++;
+        return;
+    }
+    const int pad = packet[20];
+    const SDLGamepadState state = MakeState(pad, frame);
+    const uint32_t packetNumber = DSUProtocol::read32(packet + 32);
+    const uint64_t timestamp = uint64_t(DSUProtocol::read32(packet + 68)) | uint64_t(DSUProtocol::read32(packet + 72)) << 32;
+    float gyro;
+    uint32_t bits = DSUProtocol::read32(packet + 88);
+    memcpy(&gyro, &bits, sizeof(gyro));
+    float accelY;
+    bits = DSUProtocol::read32(packet + 80);
+    memcpy(&accelY, &bits, sizeof(accelY));
+    const bool buttons = ((packet[37] & 0x40) != 0) == bool(state.A) && ((packet[37] & 0x10) != 0) == bool(state.Y)
+        && ((packet[36] & 0x80) != 0) == bool(state.DPadLeft) && ((packet[36] & 0x08) != 0) == bool(state.Start)
+        && ((packet[37] & 0x02) != 0) == (state.RightTrigger > SDLGamepad::deadzones.trigger) && (packet[37] & 0x01) == 0;
+    const bool sticks = std::abs(int(packet[40]) - int(128.0f + state.LeftStick.x * 127.0f + 0.5f)) <= 1 && packet[41] == 255
+        && std::abs(int(packet[54]) - int(state.RightTrigger * 255.0f + 0.5f)) <= 1;
+    const int sample = check.samplesOfFrame[pad]++;
+    const bool motion = std::abs(gyro - SampleValue(pad, frame, sample)) < 0.01f && std::abs(accelY - 1.0f) < 0.001f;
+    const bool order = (check.data == 0 || packetNumber == check.lastPacketNumber + 1) && timestamp > check.lastTimestamp[pad];
+    if (pad >= padCount || packet[21] != DSUProtocol::slotConnected || !buttons || !sticks || !motion || !order){
+        check.errors++;
+    }
+    check.lastPacketNumber = packetNumber;
+    check.lastTimestamp[pad] = timestamp;
+    check.data++;
+}
+
+// Reads what the server sent, until nothing more comes for a few ms.
+static void Drain(SOCKET client, ClientCheck * check, int frame){
+    uint8_t packet[512];
+    auto last = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - last < std::chrono::milliseconds(5)){
+#ifdef _WIN32
+        const int size = recvfrom(client, (char *)packet, int(sizeof(packet)), 0, nullptr, nullptr);
+#else
+        const int size = int(recvfrom(client, packet, sizeof(packet), MSG_DONTWAIT, nullptr, nullptr));
+#endif
+        if (size > 0){
+            if (check){
+                CheckPacket(*check, packet, size, frame);
+            }
+            last = std::chrono::steady_clock::now();
+        }
+    }
+}
+
+// The straightforward way, kept here as the reference: every packet is made from the pad state and the sample on its own, with
+// a bitwise CRC, and sent by itself.
+static uint32_t ReferenceCRC32(const std::vector<uint8_t> & bytes){
+    uint32_t crc = 0xFFFFFFFFu;
+    for (uint8_t byte: bytes){
+        crc ^= byte;
+        for (int bit = 0; bit < 8; bit++){
+            crc = (crc >> 1) ^ (crc & 1 ? 0xEDB88320u : 0u);
+        }
+    }
+    return ~crc;
+}
+
+static void ReferenceSend(SOCKET socketHandle, const sockaddr_in & client, int pad, const SDLGamepadState & state, const float gyro[3],
+    uint64_t timestamp, uint32_t & packetNumber){
+    std::vector<uint8_t> packet(DSUProtocol::dataPacketSize, 0);
+    DSUProtocol::writeHeader(packet.data(), DSUProtocol::dataPacketSize, 1, DSUProtocol::dataMessage);
+    packet[20] = uint8_t(pad);
+    packet[21] = DSUProtocol::slotConnected;
+    packet[22] = DSUProtocol::modelFullGyro;
+    packet[31] = 1;
+    DSUProtocol::write32(packet.data() + 32, packetNumber++);
+    packet[36] = uint8_t((state.DPadLeft ? 0x80 : 0) | (state.DPadDown ? 0x40 : 0) | (state.DPadRight ? 0x20 : 0) | (state.DPadUp ? 0x10 : 0)
+        | (state.Start ? 0x08 : 0) | (state.RightStickClick ? 0x04 : 0) | (state.LeftStickClick ? 0x02 : 0) | (state.Back ? 0x01 : 0));
+    packet[37] = uint8_t((state.X ? 0x80 : 0) | (state.A ? 0x40 : 0) | (state.B ? 0x20 : 0) | (state.Y ? 0x10 : 0)
+        | (state.RightShoulder ? 0x08 : 0) | (state.LeftShoulder ? 0x04 : 0) | (state.RightTrigger > SDLGamepad::deadzones.trigger ? 0x02 : 0)
+        | (state.LeftTrigger > SDLGamepad::deadzones.trigger ? 0x01 : 0));
+    packet[40] = uint8_t(128.0f + state.LeftStick.x * 127.0f + 0.5f);
+    packet[41] = uint8_t(128.0f - state.LeftStick.y * 127.0f + 0.5f);
+    packet[54] = uint8_t(state.RightTrigger * 255.0f + 0.5f);
+    DSUProtocol::write64(packet.data() + 68, timestamp);
+    DSUProtocol::writeFloat(packet.data() + 80, 1.0f);
+    for (int axis = 0; axis < 3; axis++){
+        DSUProtocol::writeFloat(packet.data() + 88 + axis * 4, gyro[axis] * 57.2957795f);
+    }
+    DSUProtocol::write32(packet.data() + 8, ReferenceCRC32(packet));
+    sendto(socketHandle, (const char *)packet.data(), int(packet.size()), 0, (const sockaddr *)&client, sizeof(client));
+}
+
+int main(int argc, char * argv[]){
+    uint16_t port = 26761;
+    int frames = 2000;
+    int samples = 17;
+    for (int i = 1; i < argc; i++){
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc){
+            port = uint16_t(atoi(argv[++i]));
+        }
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc){
+            frames = std::max(1, atoi(argv[++i]));
+        }
+        if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc){
+            samples = std::max(1, std::min(DSUServer::maxSamples, atoi(argv[++i])));
+        }
+    }
+    DSUServer server("127.0.0.1", port);
+    if (!server.open()){
+        std::cout << "Could not open UDP port " << port << std::endl;
+        return 1;
+    }
+    SOCKET client = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    sockaddr_in clientAddress{};
+    clientAddress.sin_family = AF_INET;
+    inet_pton(AF_INET, "127.0.0.1", &clientAddress.sin_addr);
+    bind(client, (const sockaddr *)&clientAddress, sizeof(clientAddress));
+#ifdef _WIN32
+    int addressSize = sizeof(clientAddress);
+    u_long nonBlocking = 1;
+    ioctlsocket(client, FIONBIO, &nonBlocking);
+#else
+    socklen_t addressSize = sizeof(clientAddress);
+#endif
+    getsockname(client, (sockaddr *)&clientAddress, &addressSize);
+    int bufferSize = 4 << 20;
+    setsockopt(client, SOL_SOCKET, SO_RCVBUF, (const char *)&bufferSize, sizeof(bufferSize));
+    sockaddr_in serverAddress{};
+    serverAddress.sin_family = AF_INET;
+    serverAddress.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &serverAddress.sin_addr);
+
+    for (int pad = 0; pad < padCount; pad++){
+        const uint8_t mac[6] = {0x02, 0, 0, 0, 0, uint8_t(pad)};
+        server.connectSlot(pad, 100 + pad, mac, true);
+    }
+    std::vector<SDLGamepadTouchpad> touchpads;
+
+    // The handshake, and a subscription to every slot.
+    SendRequest(client, serverAddress, DSUProtocol::versionMessage, {});
+    SendRequest(client, serverAddress, DSUProtocol::infoMessage, {4, 0, 0, 0, 0, 1, 2, 3});
+    SendRequest(client, serverAddress, DSUProtocol::dataMessage, {0, 0, 0, 0, 0, 0, 0, 0});
+    ClientCheck check;
+    for (int frame = 0; frame < frames; frame++){
+        for (int pad = 0; pad < padCount; pad++){
+            server.setInput(pad, MakeState(pad, frame), touchpads, SDL_JOYSTICK_POWER_WIRED);
+        }
+        FeedSamples(server, frame, samples);
+        server.serve();
+        memset(check.samplesOfFrame, 0, sizeof(check.samplesOfFrame));
+        Drain(client, &check, frame);
+        if (frame % 50 == 49){
+            SendRequest(client, serverAddress, DSUProtocol::dataMessage, {0, 0, 0, 0, 0, 0, 0, 0});
+        }
+    }
+    const uint64_t expected = uint64_t(frames) * padCount * uint64_t(samples);
+    if (check.errors || check.data != expected || check.versions != 1 || check.infos != 4 || check.connectedInfos != 4
+        || server.getClientCount() != 1){
+        std::cout << check.errors << " bad packets, " << check.data << " of " << expected << " data packets, " << check.versions
+            << " version and " << check.infos << " info answers!" << std::endl;
+        return 1;
+    }
+    std::cout << "All " << check.data << " data packets are right (" << padCount << " pads, " << samples << " samples per frame)" << std::endl;
+
+    // The timed part only counts the sending side. The client reads the packets between frames, so that its socket buffer
+    // doesn't fill up.
+    double served = 0.0;
+    double reference = 0.0;
+    for (int frame = 0; frame < frames; frame++){
+        auto start = std::chrono::steady_clock::now();
+        for (int pad = 0; pad < padCount; pad++){
+            server.setInput(pad, MakeState(pad, frame), touchpads, SDL_JOYSTICK_POWER_WIRED);
+        }
+        FeedSamples(server, frame, samples);
+        server.serve();
+        served += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        Drain(client, nullptr, frame);
+        if (frame % 50 == 49){
+            SendRequest(client, serverAddress, DSUProtocol::dataMessage, {0, 0, 0, 0, 0, 0, 0, 0});
+        }
+    }
+    SOCKET referenceSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    uint32_t packetNumber = 0;
+    for (int frame = 0; frame < frames; frame++){
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < samples; i++){
+            for (int pad = 0; pad < padCount; pad++){
+                const float gyro[3] = {SampleValue(pad, frame, i) / 57.2957795f, 0.0f, 0.0f};
+                ReferenceSend(referenceSocket, clientAddress, pad, MakeState(pad, frame), gyro, uint64_t(frame * samples + i), packetNumber);
+            }
+        }
+        reference += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        Drain(client, nullptr, frame);
+    }
+    CloseSocket(referenceSocket);
+    CloseSocket(client);
+    std::cout << "Packet per sendto(): " << reference / double(frames) << " us per frame" << std::endl;
+    std::cout << "DSUServer:           " << served / double(frames) << " us per frame" << std::endl;
+    return 0;
+}
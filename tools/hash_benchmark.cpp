@@ -0,0 +1,155 @@
+// Compares ImHashStr and ImHashData against the original byte-at-a-time CRC32, both for speed and for giving the exact same IDs
+// (any difference would break the window settings saved in imgui.ini).
+//
+// Usage: HashBenchmark [--iterations N]
+#include "../src/imgui/imgui.h"
+#include "../src/imgui/imgui_internal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// The hashing from Dear ImGui 1.82, kept here as the reference.
+static ImU32 reference_table[256];
+
+static void BuildReferenceTable(){
+    for (ImU32 i = 0; i < 256; i++){
+        ImU32 crc = i;
+        for (int bit = 0; bit < 8; bit++){
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+        }
+        reference_table[i] = crc;
+    }
+}
+
+static ImGuiID ReferenceHashData(const void * data_p, size_t data_size, ImU32 seed){
+    ImU32 crc = ~seed;
+    const unsigned char * data = (const unsigned char *)data_p;
+    while (data_size-- != 0){
+        crc = (crc >> 8) ^ reference_table[(crc & 0xFF) ^ *data++];
+    }
+    return ~crc;
+}
+
+static ImGuiID ReferenceHashStr(const char * data_p, size_t data_size, ImU32 seed){
+    seed = ~seed;
+    ImU32 crc = seed;
+    const unsigned char * data = (const unsigned char *)data_p;
+    if (data_size != 0){
+        while (data_size-- != 0){
+            unsigned char c = *data++;
+            if (c == '#' && data_size >= 2 && data[0] == '#' && data[1] == '#'){
+                crc = seed;
+            }
+            crc = (crc >> 8) ^ reference_table[(crc & 0xFF) ^ c];
+        }
+    }
+    else {
+        while (unsigned char c = *data++){
+            if (c == '#' && data[0] == '#' && data[1] == '#'){
+                crc = seed;
+            }
+            crc = (crc >> 8) ^ reference_table[(crc & 0xFF) ^ c];
+        }
+    }
+    return ~crc;
+}
+
+// The labels that the test app hashes every frame, for a few pads.
+static std::vector<std::string> MakeAppLabels(){
+    const char * names[] = {"Xbox One Controller", "PS5 Controller", "Nintendo Switch Pro Controller", "PS4 Controller"};
+    std::vector<std::string> labels = {"SDL Game Controller Test/Example App", "Touchpads", "Fingers", "Gyroscope", "Accelerometer", "Touchpad Polling"};
+    for (int pad = 0; pad < 4; pad++){
+        labels.push_back(std::string(names[pad]) + ": #" + std::to_string(pad));
+        labels.push_back(std::string(names[pad]) + " (Index: " + std::to_string(pad) + ")");
+        labels.push_back("Touchpad: " + std::to_string(pad));
+        for (const char * label: {"LED Color", "Left Motor", "Right Motor", "Left Trigger Motor", "Right Trigger Motor", "##R", "##G", "##B"}){
+            labels.push_back(label);
+        }
+    }
+    return labels;
+}
+
+// Edge cases of the ### and ## operators, plus random labels with lots of them mixed in.
+static std::vector<std::string> MakeRandomLabels(){
+    std::vector<std::string> labels = {
+        "", "#", "##", "###", "####", "#####", "a###b", "a###b###c", "Rumble##0", "Xbox One Controller###pad3", "Accelerometer:##123456789",
+    };
+    const char alphabet[] = "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJ0123456789:_-####";
+    srand(1234);
+    for (int i = 0; i < 2000; i++){
+        std::string label;
+        int length = rand() % 48;
+        for (int c = 0; c < length; c++){
+            label += alphabet[rand() % (sizeof(alphabet) - 1)];
+        }
+        labels.push_back(label);
+    }
+    return labels;
+}
+
+template <typename Function> static double TimeNs(int iterations, size_t hashes, Function && function){
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++){
+        function();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / (double(iterations) * double(hashes));
+}
+
+int main(int argc, char * argv[]){
+    int iterations = 2000;
+    for (int i = 1; i < argc; i++){
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc){
+            iterations = std::max(1, atoi(argv[++i]));
+        }
+    }
+
+    BuildReferenceTable();
+    std::vector<std::string> app_labels = MakeAppLabels();
+    std::vector<std::string> labels = MakeRandomLabels();
+    labels.insert(labels.end(), app_labels.begin(), app_labels.end());
+
+    int mismatches = 0;
+    for (const std::string & label: labels){
+        for (ImU32 seed: {0u, 0x12345678u, 0xFFFFFFFFu}){
+            if (ImHashStr(label.c_str(), 0, seed) != ReferenceHashStr(label.c_str(), 0, seed)
+                || ImHashStr(label.c_str(), label.size(), seed) != ReferenceHashStr(label.c_str(), label.size(), seed)
+                || ImHashData(label.data(), label.size(), seed) != ReferenceHashData(label.data(), label.size(), seed)){
+                mismatches++;
+            }
+        }
+    }
+    if (mismatches){
+        std::cout << mismatches << " hashes differ from the reference, IDs would change!" << std::endl;
+        return 1;
+    }
+    std::cout << "All " << labels.size() * 3 << " hashes match the reference" << std::endl;
+
+    // The sums keep the compiler from optimizing the hashing away.
+    ImU32 sink = 0;
+    for (const std::vector<std::string> * set: {&app_labels, &labels}){
+        const std::vector<std::string> & timed = *set;
+        double reference_str = TimeNs(iterations, timed.size(), [&]{
+            for (const std::string & label: timed) sink += ReferenceHashStr(label.c_str(), 0, 0);
+        });
+        double fast_str = TimeNs(iterations, timed.size(), [&]{
+            for (const std::string & label: timed) sink += ImHashStr(label.c_str(), 0, 0);
+        });
+        double reference_data = TimeNs(iterations, timed.size(), [&]{
+            for (const std::string & label: timed) sink += ReferenceHashData(label.data(), label.size(), 0);
+        });
+        double fast_data = TimeNs(iterations, timed.size(), [&]{
+            for (const std::string & label: timed) sink += ImHashData(label.data(), label.size(), 0);
+        });
+
+        std::cout << (set == &app_labels ? "Test app labels:" : "All labels (lots of ### and ##):") << std::endl;
+        std::cout << "  ImHashStr:  " << fast_str << " ns per label (reference " << reference_str << " ns)" << std::endl;
+        std::cout << "  ImHashData: " << fast_data << " ns per label (reference " << reference_data << " ns)" << std::endl;
+    }
+    return sink == 42 ? 2 : 0;
+}
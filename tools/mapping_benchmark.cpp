@@ -0,0 +1,184 @@
+// Compares loading a gamecontrollerdb.txt through SDL_GameControllerAddMappingsFromFile() with ControllerMappingDatabase,
+// which indexes the file once and maps that index on later starts. Also checks that the index has the same mapping as the
+// text for every GUID (for this platform, the last line of a GUID wins), and that an edit which doesn't change the size of the
+// file is picked up by update() right away (with the made up database only, a file given with --mappings isn't touched).
+//
+// Usage: MappingBenchmark [--mappings <gamecontrollerdb.txt>] [--iterations N]
+// Without --mappings, a database of 2000 made up mappings (for several platforms, with some duplicate GUIDs, some lower case
+// platform names and some lines without a platform) is written to the current directory and used instead.
+#include "../src/mapping_database.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+static std::string MakeDatabase(int count){
+    const char * platforms[] = {"Windows", "Mac OS X", "Linux", "Android", "iOS", "windows", "mac os x", "linux"};
+    std::string text = "# Game Controller DB for SDL, made up for the benchmark\n\n";
+    srand(1234);
+    for (int i = 0; i < count; i++){
+        char guid[33];
+        for (int c = 0; c < 32; c++){
+            guid[c] = "0123456789abcdef"[rand() % 16];
+        }
+        guid[32] = '\0';
+        if (i > 0 && i % 50 == 0){
+            // Same GUID as an earlier line, which the later line replaces
+            size_t previous = text.rfind('\n', text.size() - 2);
+            memcpy(guid, text.c_str() + previous + 1, 32);
+        }
+        text += std::string(guid) + ",Made Up Pad " + std::to_string(i) + ",a:b0,b:b1,back:b6,dpdown:h0.4,dpleft:h0.8,dpright:h0.2,dpup:h0.1,"
+            "guide:b8,leftshoulder:b4,leftstick:b9,lefttrigger:a2,leftx:a0,lefty:a1,rightshoulder:b5,rightstick:b10,righttrigger:a5,"
+            "rightx:a3,righty:a4,start:b7,x:b2,y:b3," + (i % 9 == 8 ? std::string() : std::string("platform:") + platforms[i % 9] + ",") + "\n";
+    }
+    return text;
+}
+
+static bool WriteFile(const std::string & path, const std::string & text){
+    FILE * file = fopen(path.c_str(), "wb");
+    if (!file){
+        return false;
+    }
+    bool ok = fwrite(text.data(), 1, text.size(), file) == text.size();
+    return (fclose(file) == 0) && ok;
+}
+
+static bool ReadFile(const std::string & path, std::string & text){
+    FILE * file = fopen(path.c_str(), "rb");
+    if (!file){
+        return false;
+    }
+    char buffer[16 * 1024];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0){
+        text.append(buffer, read);
+    }
+    fclose(file);
+    return true;
+}
+
+static std::string Lower(std::string text){
+    for (char & c: text){
+        c = char(tolower((unsigned char)c));
+    }
+    return text;
+}
+
+// The mapping each GUID should end up with, read the simple way. Like SDL, only lines for this platform count, ignoring case.
+static std::map<std::string, std::string> ReferenceMappings(const std::string & text){
+    std::map<std::string, std::string> mappings;
+    const std::string platform = Lower(std::string("platform:") + SDL_GetPlatform() + ",");
+    size_t lineStart = 0;
+    while (lineStart < text.size()){
+        size_t lineEnd = std::min(text.find('\n', lineStart), text.size());
+        std::string line = text.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ')){
+            line.pop_back();
+        }
+        if (line.size() < 33 || line[0] == '#' || line[32] != ','){
+            continue;
+        }
+        if (Lower(line).find(platform) == std::string::npos){
+            continue;
+        }
+        mappings[line.substr(0, 32)] = line;
+    }
+    return mappings;
+}
+
+template <typename Function> static double TimeMs(int iterations, Function && function){
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++){
+        function();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / double(iterations);
+}
+
+int main(int argc, char * argv[]){
+    std::string path = "";
+    int iterations = 20;
+    for (int i = 1; i < argc; i++){
+        if (strcmp(argv[i], "--mappings") == 0 && i + 1 < argc){
+            path = argv[++i];
+        }
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc){
+            iterations = std::max(1, atoi(argv[++i]));
+        }
+    }
+    const bool madeUp = path.empty();
+    if (madeUp){
+        path = "mapping_benchmark_db.txt";
+        if (!WriteFile(path, MakeDatabase(2000))){
+            std::cout << "Could not write " << path << std::endl;
+            return 1;
+        }
+    }
+    std::string text;
+    if (!ReadFile(path, text)){
+        std::cout << "Could not read " << path << std::endl;
+        return 1;
+    }
+    SDL_Init(SDL_INIT_GAMECONTROLLER);
+
+    remove((path + ".index").c_str());
+    double build = TimeMs(1, [&]{
+        ControllerMappingDatabase database(path);
+        database.load();
+    });
+
+    ControllerMappingDatabase database(path);
+    database.load();
+    std::map<std::string, std::string> reference = ReferenceMappings(text);
+    int mismatches = int(reference.size()) - database.size();
+    for (const auto & mapping: reference){
+        SDL_JoystickGUID guid = SDL_JoystickGetGUIDFromString(mapping.first.c_str());
+        const char * indexed = database.mapping(guid);
+        if (!indexed || mapping.second != indexed){
+            mismatches++;
+        }
+    }
+    if (mismatches){
+        std::cout << mismatches << " mappings differ from the text file!" << std::endl;
+        return 1;
+    }
+    std::cout << "All " << reference.size() << " mappings for " << SDL_GetPlatform() << " match the text file" << std::endl;
+
+    // Change the name of a mapping without changing the size of the file, within the same second as the load.
+    if (madeUp){
+        const std::string & edited = reference.begin()->second;
+        const size_t name = text.rfind(edited) + 33;
+        std::string changed = text;
+        changed[name] = 'X';
+        database.checkIntervalMs = 0;
+        if (!WriteFile(path, changed) || !database.update() || database.mapping(SDL_JoystickGetGUIDFromString(edited.substr(0, 32).c_str()))[33] != 'X'){
+            std::cout << "An edit that kept the size of the file was missed!" << std::endl;
+            return 1;
+        }
+        if (!WriteFile(path, text) || !database.update()){
+            std::cout << "Could not write " << path << " back" << std::endl;
+            return 1;
+        }
+    }
+
+    double sdl = TimeMs(iterations, [&]{
+        SDL_GameControllerAddMappingsFromFile(path.c_str());
+    });
+    double mapped = TimeMs(iterations, [&]{
+        ControllerMappingDatabase warm(path);
+        warm.load();
+    });
+    std::cout << "SDL_GameControllerAddMappingsFromFile: " << sdl << " ms" << std::endl;
+    std::cout << "Index build (first start):             " << build << " ms" << std::endl;
+    std::cout << "Index mapped (later starts):           " << mapped << " ms" << std::endl;
+
+    SDL_Quit();
+    return 0;
+}
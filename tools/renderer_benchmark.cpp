@@ -0,0 +1,161 @@
+// Replays ImDrawData frames recorded with "SDL2GamepadTest --record <file>" through the SDL renderer backend, using SDL's software renderer,
+// so that backend optimizations can be compared reproducibly without a display.
+//
+// Usage: RendererBenchmark <capture file> [--repeat N] [--tiled] [--threads N] [--a8]
+//   --repeat N    replays the whole capture N times (the caches stay warm between repeats)
+//   --tiled       uses the tiled software rasterizer, with --threads worker threads (0 = one per CPU)
+//   --a8          keeps the font atlas as alpha only
+#include "../src/imgui/imgui.h"
+#include "../src/imgui/imgui_impl_sdl_renderer.h"
+#include "../src/draw_data_capture.h"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// The frames are loaded before the renderer (and with it the font texture) exists, so the tags are kept in the texture ids for now.
+static ImTextureID TextureForTag(uint32_t tag){
+    return (ImTextureID)(intptr_t)(tag + 1);
+}
+
+static double Percentile(std::vector<double> values, double percentile){
+    std::sort(values.begin(), values.end());
+    size_t index = size_t(percentile * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+static double Ratio(int hits, int misses){
+    return (hits + misses) ? 100.0 * hits / (hits + misses) : 0.0;
+}
+
+int main(int argc, char * argv[]){
+    if (argc < 2){
+        std::cout << "Usage: " << argv[0] << " <capture file> [--repeat N] [--tiled] [--threads N] [--a8]" << std::endl;
+        return 1;
+    }
+
+    int repeat = 1;
+    int threads = 0;
+    bool tiled = false;
+    bool alpha_only = false;
+    for (int i = 2; i < argc; i++){
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc){
+            repeat = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc){
+            threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--tiled") == 0){
+            tiled = true;
+        }
+        else if (strcmp(argv[i], "--a8") == 0){
+            alpha_only = true;
+        }
+    }
+
+    SDL_Init(0);
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGui::GetIO().IniFilename = nullptr;
+
+    // Everything is loaded up front, so that reading the file isn't part of the measurements.
+    DrawDataCaptureReader reader(argv[1]);
+    if (!reader.isOpen()){
+        std::cout << reader.getError() << std::endl;
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<DrawDataCaptureFrame>> frames;
+    int width = 1, height = 1;
+    while (true){
+        auto frame = std::make_unique<DrawDataCaptureFrame>();
+        if (!reader.readFrame(*frame, TextureForTag)){
+            break;
+        }
+        width = std::max(width, int(frame->drawData.DisplaySize.x));
+        height = std::max(height, int(frame->drawData.DisplaySize.y));
+        frames.push_back(std::move(frame));
+    }
+    if (!reader.getError().empty() || frames.empty()){
+        std::cout << (frames.empty() ? "The capture has no frames" : reader.getError()) << std::endl;
+        return 1;
+    }
+
+    SDL_Surface * target = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+    SDL_Renderer * renderer = SDL_CreateSoftwareRenderer(target);
+    ImGui_ImplSDLRenderer_Init(renderer, alpha_only);
+    if (tiled){
+        ImGui_ImplSDLRenderer_SetTiledRasterization(true, threads);
+    }
+
+    // Textures other than the font atlas weren't saved, so they are all replaced with a single white texture.
+    SDL_Texture * placeholder_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, 1, 1);
+    Uint32 white = 0xffffffff;
+    SDL_UpdateTexture(placeholder_texture, nullptr, &white, 4);
+    for (auto & frame: frames){
+        for (auto & list: frame->lists){
+            for (ImDrawCmd & command: list->CmdBuffer){
+                const bool is_font = command.TextureId == TextureForTag(DrawDataCapture::fontTextureTag);
+                command.TextureId = is_font ? ImGui::GetIO().Fonts->TexID : (ImTextureID)placeholder_texture;
+            }
+        }
+    }
+
+    if (reader.getAtlasWidth() != ImGui::GetIO().Fonts->TexWidth || reader.getAtlasHeight() != ImGui::GetIO().Fonts->TexHeight){
+        std::cout << "Warning: the font atlas differs from the one used while recording, text will sample the wrong glyphs." << std::endl;
+    }
+
+    std::vector<double> frame_times;
+    ImGui_ImplSDLRenderer_Stats totals;
+    const double ticks_per_ms = double(SDL_GetPerformanceFrequency()) / 1000.0;
+
+    ImGui_ImplSDLRenderer_ResetStats();
+    for (int pass = 0; pass < repeat; pass++){
+        for (auto & frame: frames){
+            SDL_SetRenderDrawColor(renderer, 240, 240, 240, 255);
+            SDL_RenderClear(renderer);
+
+            Uint64 start = SDL_GetPerformanceCounter();
+            ImGui_ImplSDLRenderer_RenderDrawData(&frame->drawData);
+            SDL_RenderPresent(renderer);
+            Uint64 end = SDL_GetPerformanceCounter();
+
+            frame_times.push_back(double(end - start) / ticks_per_ms);
+        }
+    }
+    totals = ImGui_ImplSDLRenderer_GetStats();
+
+    double total_time = 0.0;
+    for (double time: frame_times){
+        total_time += time;
+    }
+    const double frame_count = double(frame_times.size());
+
+    std::cout << "Replayed " << frames.size() << " frames x " << repeat << " at " << width << "x" << height
+              << (tiled ? " (tiled)" : "") << (alpha_only ? " (A8 atlas)" : "") << std::endl;
+    std::cout << "Frame time (ms): avg " << total_time / frame_count
+              << ", min " << Percentile(frame_times, 0.0)
+              << ", p50 " << Percentile(frame_times, 0.5)
+              << ", p95 " << Percentile(frame_times, 0.95)
+              << ", max " << Percentile(frame_times, 1.0)
+              << ", first " << frame_times.front() << std::endl;
+    std::cout << "Draw calls per frame: " << totals.DrawCalls / frame_count << std::endl;
+    std::cout << "Uniform color triangle cache: " << Ratio(totals.UniformColorTriangleCacheHits, totals.UniformColorTriangleCacheMisses) << "% hits ("
+              << totals.UniformColorTriangleCacheHits << " hits, " << totals.UniformColorTriangleCacheMisses << " misses)" << std::endl;
+    std::cout << "Generic triangle cache: " << Ratio(totals.GenericTriangleCacheHits, totals.GenericTriangleCacheMisses) << "% hits ("
+              << totals.GenericTriangleCacheHits << " hits, " << totals.GenericTriangleCacheMisses << " misses)" << std::endl;
+    std::cout << "Texture creations: " << totals.TextureCreations << std::endl;
+    std::cout << "Glyph runs per frame: " << totals.GlyphRuns / frame_count << " (" << totals.Glyphs / frame_count << " glyphs)" << std::endl;
+
+    SDL_DestroyTexture(placeholder_texture);
+    ImGui_ImplSDLRenderer_Shutdown();
+    ImGui::DestroyContext();
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(target);
+    SDL_Quit();
+    return 0;
+}
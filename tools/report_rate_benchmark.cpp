@@ -0,0 +1,203 @@
+// Checks ReportRateAnalyzer against simulated pads: each sends reports at a fixed rate (250 Hz like a pad over USB, 800 Hz like
+// one over Bluetooth, 1000 Hz like a fast wired one), they arrive with some jitter, some pads' reports are read in bunches by a
+// thread that wakes up every millisecond (like ReportRateMonitor's), and bursts of reports are lost along the way.
+// The streaming statistics must match a reference that keeps every timestamp and works them out afterwards, and the dropouts
+// it finds must be the ones that were simulated. Then times adding a report to the analyzer, and to the reference.
+//
+// Usage: ReportRateBenchmark [--pads N] [--seconds N] [--passes N]
+#include "../src/report_rate_analyzer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+struct SimulatedPad{
+    double interval; // ms
+    double jitter; // ms
+    bool bunched;
+    std::vector<uint64_t> arrivals; // ns
+    uint64_t dropouts = 0;
+    uint64_t lostReports = 0;
+    uint64_t bursts[ReportRateAnalyzer::burstBins] = {};
+};
+
+static SimulatedPad MakePad(std::mt19937 & random, int p, double seconds){
+    static const double intervals[] = {4.0, 1.25, 1.0};
+    SimulatedPad pad;
+    pad.interval = intervals[p % 3];
+    // Bunching by a 1 ms reader is already all the jitter a 1000 Hz pad can have and still be told apart.
+    pad.bunched = (p / 3) % 2 == 1 && pad.interval > 1.0;
+    pad.jitter = pad.bunched ? 0.02 : pad.interval * 0.05;
+    std::normal_distribution<double> jitter(0.0, pad.jitter);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    static const uint64_t burstLengths[] = {1, 1, 1, 2, 2, 3, 4, 6, 10, 25, 80};
+    std::uniform_int_distribution<int> burst(0, int(sizeof(burstLengths) / sizeof(burstLengths[0])) - 1);
+    // The reader wakes up a little later than asked every time, like a sleeping thread does.
+    std::uniform_real_distribution<double> oversleep(0.0, 0.08);
+    double wakeUp = 0.0;
+    const double start = 1000.0 + double(p);
+    const uint64_t sent = uint64_t(seconds * 1000.0 / pad.interval);
+    uint64_t previous = 0;
+    uint64_t good = 0;
+    for (uint64_t report = 0; report < sent; report++, good++){
+        // Loss only starts once the analyzer had time to learn the rate, and every burst is followed by a few good reports.
+        if (report > 2 * ReportRateAnalyzer::warmupReports && good > 2 * ReportRateAnalyzer::dropoutMerge && chance(random) < 0.0025){
+            good = 0;
+            const uint64_t lost = burstLengths[burst(random)];
+            pad.dropouts++;
+            pad.lostReports += lost;
+            int bin = 0;
+            while (bin < ReportRateAnalyzer::burstBins - 1 && (uint64_t(1) << bin) < lost){
+                bin++;
+            }
+            pad.bursts[bin]++;
+            report += lost;
+        }
+        double arrival = start + double(report) * pad.interval + jitter(random);
+        if (pad.bunched){
+            while (wakeUp < arrival){
+                wakeUp += 1.0 + oversleep(random);
+            }
+            arrival = wakeUp;
+        }
+        const uint64_t time = std::max(previous, uint64_t(arrival * 1e6));
+        pad.arrivals.push_back(time);
+        previous = time;
+    }
+    return pad;
+}
+
+// Keeps every timestamp, and works out the statistics from all of them at once.
+struct ReferenceAnalyzer{
+    std::vector<uint64_t> arrivals;
+
+    void addReport(uint64_t time){
+        arrivals.push_back(time);
+    }
+
+    uint64_t countSince(uint64_t from) const{
+        return uint64_t(arrivals.end() - std::lower_bound(arrivals.begin(), arrivals.end(), from));
+    }
+
+    void histogram(uint64_t * bins) const{
+        for (size_t i = 1; i < arrivals.size(); i++){
+            bins[ReportRateAnalyzer::binOf(double(arrivals[i] - arrivals[i - 1]) / 1e6)]++;
+        }
+    }
+
+    double averageRate() const{
+        return double(arrivals.size() - 1) * 1e9 / double(arrivals.back() - arrivals.front());
+    }
+
+    double longestGap() const{
+        uint64_t longest = 0;
+        for (size_t i = 1; i < arrivals.size(); i++){
+            longest = std::max(longest, arrivals[i] - arrivals[i - 1]);
+        }
+        return double(longest) / 1e6;
+    }
+};
+
+int main(int argc, char * argv[]){
+    int padCount = 12;
+    double seconds = 60.0;
+    int passes = 20;
+    for (int i = 1; i < argc; i++){
+        if (strcmp(argv[i], "--pads") == 0 && i + 1 < argc){
+            padCount = std::max(1, atoi(argv[++i]));
+        }
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc){
+            seconds = std::max(2.0, atof(argv[++i]));
+        }
+        if (strcmp(argv[i], "--passes") == 0 && i + 1 < argc){
+            passes = std::max(1, atoi(argv[++i]));
+        }
+    }
+    std::mt19937 random(1234);
+    std::vector<SimulatedPad> pads;
+    uint64_t simulatedDropouts = 0, foundDropouts = 0, simulatedLost = 0, foundLost = 0;
+    double worstInterval = 0.0;
+    for (int p = 0; p < padCount; p++){
+        pads.push_back(MakePad(random, p, seconds));
+        const SimulatedPad & pad = pads.back();
+        ReportRateAnalyzer analyzer;
+        ReferenceAnalyzer reference;
+        for (uint64_t time: pad.arrivals){
+            analyzer.addReport(time);
+            reference.addReport(time);
+        }
+        const uint64_t now = pad.arrivals.back() + 1;
+
+        // What can be worked out exactly from the timestamps must come out the same.
+        uint64_t bins[ReportRateAnalyzer::histogramBins] = {};
+        reference.histogram(bins);
+        if (!std::equal(bins, bins + ReportRateAnalyzer::histogramBins, analyzer.getHistogram())){
+            std::cout << "Pad " << p << " has a different interval histogram" << std::endl;
+            return 1;
+        }
+        const uint64_t windowStart = (now / ReportRateAnalyzer::bucketLength - (ReportRateAnalyzer::rateBuckets - 1)) * ReportRateAnalyzer::bucketLength;
+        const double referenceRate = double(reference.countSince(windowStart)) * 1e9 / double(now - windowStart);
+        if (std::fabs(analyzer.getRate(now) - referenceRate) > 1e-6 * referenceRate
+            || std::fabs(analyzer.getAverageRate() - reference.averageRate()) > 1e-6 * reference.averageRate()
+            || std::fabs(analyzer.getLongestGap() - reference.longestGap()) > 1e-9){
+            std::cout << "Pad " << p << " has a different rate (" << analyzer.getRate(now) << " / " << referenceRate
+                << ", " << analyzer.getAverageRate() << " / " << reference.averageRate() << ")" << std::endl;
+            return 1;
+        }
+
+        // The dropouts must be the simulated ones.
+        if (analyzer.getDropouts() != pad.dropouts || analyzer.getLostReports() != pad.lostReports
+            || !std::equal(pad.bursts, pad.bursts + ReportRateAnalyzer::burstBins, analyzer.getBursts())){
+            std::cout << "Pad " << p << " (" << 1000.0 / pad.interval << " Hz" << (pad.bunched ? ", bunched" : "") << ") found "
+                << analyzer.getDropouts() << " dropouts losing " << analyzer.getLostReports() << " reports, but "
+                << pad.dropouts << " losing " << pad.lostReports << " were simulated" << std::endl;
+            return 1;
+        }
+        simulatedDropouts += pad.dropouts;
+        foundDropouts += analyzer.getDropouts();
+        simulatedLost += pad.lostReports;
+        foundLost += analyzer.getLostReports();
+        worstInterval = std::max(worstInterval, std::fabs(analyzer.getMeanInterval() - pad.interval) / pad.interval);
+    }
+    std::cout << "Analyzed " << padCount << " pads over " << seconds << " s: found " << foundDropouts << " of "
+        << simulatedDropouts << " dropouts, " << foundLost << " of " << simulatedLost << " lost reports" << std::endl;
+    std::cout << "Mean intervals within " << worstInterval * 100.0 << "% of the simulated ones" << std::endl;
+    if (worstInterval > 0.01){
+        std::cout << "The mean intervals are off!" << std::endl;
+        return 1;
+    }
+
+    // Passes over one pad's reports, and the fastest pass counts. The sums keep the compiler from optimizing the work away.
+    const std::vector<uint64_t> & arrivals = pads[0].arrivals;
+    uint64_t sink = 0;
+    auto time = [&](auto && make, auto && sum){
+        double best = 1e30;
+        for (int pass = 0; pass < passes; pass++){
+            auto analyzer = make();
+            auto start = std::chrono::steady_clock::now();
+            for (uint64_t arrival: arrivals){
+                analyzer.addReport(arrival);
+            }
+            sink += sum(analyzer);
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count() / double(arrivals.size()));
+        }
+        return best;
+    };
+    const double streaming = time([]{ return ReportRateAnalyzer(); }, [](const ReportRateAnalyzer & analyzer){ return analyzer.getDropouts(); });
+    const double reference = time([]{ return ReferenceAnalyzer(); }, [](const ReferenceAnalyzer & analyzer){
+        uint64_t bins[ReportRateAnalyzer::histogramBins] = {};
+        analyzer.histogram(bins);
+        return bins[0];
+    });
+    std::cout << "Streaming analyzer:  " << streaming << " ns per report, " << sizeof(ReportRateAnalyzer) << " bytes per pad" << std::endl;
+    std::cout << "Keeping every report: " << reference << " ns per report (with the histogram), "
+        << arrivals.size() * sizeof(uint64_t) << " bytes per pad for " << seconds << " s" << std::endl;
+    return sink == 42 ? 2 : 0;
+}
@@ -0,0 +1,164 @@
+// Checks SharedPadReader against SharedPadWriter through a real shared memory region: a writer thread keeps rewriting every slot
+// while a reader thread copies them, and every copy must be one whole write (all fields of a write are derived from its number,
+// so a copy that mixes two writes shows) and no older than the copy before it. Then times handing a poll's worth of states over
+// through the region, and through a pipe (not on Windows).
+//
+// Usage: SharedPadBenchmark [--writes N] [--iterations N]
+#include "../src/shared_pad_states.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+static void FillState(SharedPadFormat::PadState & state, int slot, uint64_t write){
+    state.connected = 1;
+    state.instanceId = slot;
+    state.pollCount = write;
+    state.timestamp = write * 3;
+    state.buttons = uint32_t(write) & 0x1FFFFF;
+    for (int i = 0; i < 6; i++){
+        state.axes[i] = float(write % 1000 + uint64_t(i));
+    }
+    state.sensors = SharedPadFormat::accelerometerValid | SharedPadFormat::gyroscopeValid;
+    for (int i = 0; i < 3; i++){
+        state.accelerometer[i] = float(write % 777 + uint64_t(i));
+        state.gyroscope[i] = float(write % 555 + uint64_t(i));
+    }
+    state.touchpadCount = 1;
+    for (int finger = 0; finger < SharedPadFormat::maxFingers; finger++){
+        state.fingers[0][finger] = {uint32_t(write & 1), float(write % 100), float(finger), 0.5f};
+    }
+    snprintf(state.name, sizeof(state.name), "Pad %d, write %llu", slot, (unsigned long long)write);
+}
+
+static bool StateIsWhole(const SharedPadFormat::PadState & state, int slot){
+    SharedPadFormat::PadState expected;
+    memset(&expected, 0, sizeof(expected));
+    FillState(expected, slot, state.pollCount);
+    return memcmp(&expected, &state, sizeof(state)) == 0;
+}
+
+int main(int argc, char * argv[]){
+    uint64_t writes = 2000000;
+    int iterations = 200000;
+    for (int i = 1; i < argc; i++){
+        if (strcmp(argv[i], "--writes") == 0 && i + 1 < argc){
+            writes = uint64_t(std::max(1, atoi(argv[++i])));
+        }
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc){
+            iterations = std::max(1, atoi(argv[++i]));
+        }
+    }
+    const std::string name = "SharedPadBenchmark";
+    SharedPadWriter writer(name);
+    SharedPadReader reader;
+    if (!writer.open() || !reader.open(name)){
+        std::cout << "Could not create the shared memory region" << std::endl;
+        return 1;
+    }
+    // The slots are written with memset first, so that the padding of a state is the same in every write.
+    auto writeSlot = [&](int slot, uint64_t write){
+        writer.write(slot, [&](SharedPadFormat::PadState & state){
+            memset(&state, 0, sizeof(state));
+            FillState(state, slot, write);
+        });
+    };
+
+    std::atomic<bool> writing{true};
+    std::thread writerThread([&]{
+        for (uint64_t write = 1; write <= writes; write++){
+            writeSlot(int(write % SharedPadFormat::maxPads), write);
+        }
+        writing = false;
+    });
+    uint64_t reads = 0;
+    uint64_t torn = 0;
+    uint64_t backwards = 0;
+    uint64_t last[SharedPadFormat::maxPads] = {};
+    SharedPadFormat::PadState state;
+    while (writing){
+        for (int slot = 0; slot < reader.getSlotCount(); slot++){
+            if (!reader.read(slot, state)){
+                continue;
+            }
+            reads++;
+            torn += !StateIsWhole(state, slot);
+            backwards += state.pollCount < last[slot];
+            last[slot] = state.pollCount;
+        }
+    }
+    writerThread.join();
+    if (torn || backwards){
+        std::cout << torn << " of " << reads << " reads mixed two writes, and " << backwards << " went back to an older write!" << std::endl;
+        return 1;
+    }
+    if (!reader.running()){
+        std::cout << "The reader doesn't see the writer running" << std::endl;
+        return 1;
+    }
+    std::cout << "All " << reads << " reads during " << writes << " writes were whole writes" << std::endl;
+
+    // One poll is a write of every slot, and a consumer reads every slot once per poll. Both ways hand over the same, already made,
+    // states. The sums keep the compiler from optimizing the reads away.
+    SharedPadFormat::PadState states[SharedPadFormat::maxPads];
+    SharedPadFormat::PadState received[SharedPadFormat::maxPads];
+    memset(states, 0, sizeof(states));
+    for (int slot = 0; slot < SharedPadFormat::maxPads; slot++){
+        FillState(states[slot], slot, 1);
+    }
+    uint64_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++){
+        for (int slot = 0; slot < SharedPadFormat::maxPads; slot++){
+            states[slot].pollCount = uint64_t(i);
+            writer.write(slot, [&](SharedPadFormat::PadState & shared){
+                memcpy(&shared, &states[slot], sizeof(shared));
+            });
+        }
+        writer.published();
+        for (int slot = 0; slot < reader.getSlotCount(); slot++){
+            reader.read(slot, received[slot]);
+        }
+        sink += received[i % SharedPadFormat::maxPads].pollCount;
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "Shared memory:  " << std::chrono::duration<double, std::nano>(end - start).count() / double(iterations)
+        << " ns per poll of " << SharedPadFormat::maxPads << " pads" << std::endl;
+
+#ifndef _WIN32
+    // The reference: the states written into a pipe and read back out, which is what a pipe or socket based server costs per
+    // consumer, before any waiting for the other process.
+    int pipeEnds[2];
+    if (pipe(pipeEnds) != 0){
+        std::cout << "Could not create a pipe" << std::endl;
+        return 1;
+    }
+    auto pipeStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++){
+        states[0].pollCount = uint64_t(i);
+        if (write(pipeEnds[1], states, sizeof(states)) != ssize_t(sizeof(states))){
+            break;
+        }
+        size_t got = 0;
+        while (got < sizeof(received)){
+            ssize_t count = read(pipeEnds[0], (char *)received + got, sizeof(received) - got);
+            if (count <= 0){
+                break;
+            }
+            got += size_t(count);
+        }
+        sink += received[i % SharedPadFormat::maxPads].pollCount;
+    }
+    auto pipeEnd = std::chrono::steady_clock::now();
+    close(pipeEnds[0]);
+    close(pipeEnds[1]);
+    std::cout << "Through a pipe: " << std::chrono::duration<double, std::nano>(pipeEnd - pipeStart).count() / double(iterations)
+        << " ns per poll of " << SharedPadFormat::maxPads << " pads" << std::endl;
+#endif
+    return sink == 42 ? 2 : 0;
+}
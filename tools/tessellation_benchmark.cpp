@@ -0,0 +1,282 @@
+// Compares the SSE2/NEON tessellation kernels of ImDrawList (ImTessellateSegmentNormals() and friends in imgui_draw.cpp) against the original
+// scalar loops, both for speed and for giving the same geometry, then times AddPolyline() and AddConvexPolyFilled() on stick-like shapes.
+// Normals, miters and bezier points should match exactly. Arcs use a polynomial sin/cos, so they are allowed a few ulps of the coordinates.
+//
+// Usage: TessellationBenchmark [--iterations N]
+#include "../src/imgui/imgui.h"
+#include "../src/imgui/imgui_internal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// The scalar loops from Dear ImGui 1.82, kept here as the reference.
+static void ReferenceSegmentNormals(const ImVec2 * points, int points_count, int count, ImVec2 * out_normals){
+    for (int i1 = 0; i1 < count; i1++){
+        const int i2 = (i1 + 1) == points_count ? 0 : i1 + 1;
+        float dx = points[i2].x - points[i1].x;
+        float dy = points[i2].y - points[i1].y;
+        float d2 = dx * dx + dy * dy;
+        if (d2 > 0.0f){
+            float inv_len = 1.0f / sqrtf(d2);
+            dx *= inv_len;
+            dy *= inv_len;
+        }
+        out_normals[i1].x = dy;
+        out_normals[i1].y = -dx;
+    }
+}
+
+static void ReferenceMiterNormals(const ImVec2 * normals, int points_count, int count, ImVec2 * out_miters){
+    for (int i1 = 0; i1 < count; i1++){
+        const int i2 = (i1 + 1) == points_count ? 0 : i1 + 1;
+        float dm_x = (normals[i1].x + normals[i2].x) * 0.5f;
+        float dm_y = (normals[i1].y + normals[i2].y) * 0.5f;
+        float d2 = dm_x * dm_x + dm_y * dm_y;
+        if (d2 < 0.5f){
+            d2 = 0.5f;
+        }
+        float inv_lensq = 1.0f / d2;
+        out_miters[i2].x = dm_x * inv_lensq;
+        out_miters[i2].y = dm_y * inv_lensq;
+    }
+}
+
+static void ReferenceArcPoints(ImVec2 * out_points, const ImVec2 & center, float radius, float a_min, float a_max, int num_segments){
+    for (int i = 0; i <= num_segments; i++){
+        const float a = a_min + ((float)i / (float)num_segments) * (a_max - a_min);
+        out_points[i] = ImVec2(center.x + cosf(a) * radius, center.y + sinf(a) * radius);
+    }
+}
+
+static void ReferenceBezierCubicPoints(ImVec2 * out_points, const ImVec2 & p1, const ImVec2 & p2, const ImVec2 & p3, const ImVec2 & p4, int num_segments){
+    float t_step = 1.0f / (float)num_segments;
+    for (int i_step = 1; i_step <= num_segments; i_step++){
+        out_points[i_step - 1] = ImBezierCubicCalc(p1, p2, p3, p4, t_step * i_step);
+    }
+}
+
+static float RandomFloat(float min, float max){
+    return min + (max - min) * float(rand()) / float(RAND_MAX);
+}
+
+// Random polylines, with repeated points (zero length segments) and the odd sharp turn mixed in.
+struct Polyline {
+    std::vector<ImVec2> points;
+    bool closed;
+};
+
+static std::vector<Polyline> MakePolylines(){
+    std::vector<Polyline> polylines;
+    srand(1234);
+    for (int i = 0; i < 500; i++){
+        Polyline polyline;
+        polyline.closed = (i % 2) == 0;
+        int count = 2 + rand() % 200;
+        ImVec2 point(RandomFloat(0.0f, 1920.0f), RandomFloat(0.0f, 1080.0f));
+        for (int n = 0; n < count; n++){
+            if (rand() % 10 != 0){
+                point.x += RandomFloat(-40.0f, 40.0f);
+                point.y += RandomFloat(-40.0f, 40.0f);
+            }
+            polyline.points.push_back(point);
+        }
+        polylines.push_back(polyline);
+    }
+    return polylines;
+}
+
+// Scaled so that the error is measured against the magnitude of the coordinates (1 ulp of 1000.0f is about 6e-5).
+static float RelativeError(const ImVec2 & value, const ImVec2 & reference, float scale){
+    return std::max(fabsf(value.x - reference.x), fabsf(value.y - reference.y)) / std::max(scale, 1.0f);
+}
+
+template <typename Function> static double TimeNs(int iterations, size_t points, Function && function){
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++){
+        function();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / (double(iterations) * double(points));
+}
+
+int main(int argc, char * argv[]){
+    int iterations = 200;
+    for (int i = 1; i < argc; i++){
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc){
+            iterations = std::max(1, atoi(argv[++i]));
+        }
+    }
+
+#if defined(IMGUI_ENABLE_SSE)
+    std::cout << "Kernels: SSE2" << std::endl;
+#elif defined(IMGUI_ENABLE_NEON)
+    std::cout << "Kernels: NEON" << std::endl;
+#else
+    std::cout << "Kernels: scalar (IMGUI_DISABLE_SIMD, or no SSE2/NEON on this target)" << std::endl;
+#endif
+
+    std::vector<Polyline> polylines = MakePolylines();
+    size_t total_points = 0;
+    for (const Polyline & polyline: polylines){
+        total_points += polyline.points.size();
+    }
+
+    // Normals and miters, the way AddPolyline() chains them
+    float normal_error = 0.0f, miter_error = 0.0f;
+    std::vector<ImVec2> normals(512), miters(512), reference_normals(512), reference_miters(512);
+    for (const Polyline & polyline: polylines){
+        const int points_count = int(polyline.points.size());
+        const int count = polyline.closed ? points_count : points_count - 1;
+        ImTessellateSegmentNormals(polyline.points.data(), points_count, count, normals.data());
+        ReferenceSegmentNormals(polyline.points.data(), points_count, count, reference_normals.data());
+        for (int i = 0; i < count; i++){
+            normal_error = std::max(normal_error, RelativeError(normals[i], reference_normals[i], 1.0f));
+        }
+        if (!polyline.closed){
+            reference_normals[points_count - 1] = reference_normals[points_count - 2];
+        }
+        ImTessellateMiterNormals(reference_normals.data(), points_count, count, miters.data());
+        ReferenceMiterNormals(reference_normals.data(), points_count, count, reference_miters.data());
+        for (int i = polyline.closed ? 0 : 1; i < points_count; i++){
+            miter_error = std::max(miter_error, RelativeError(miters[i], reference_miters[i], 1.0f));
+        }
+    }
+
+    // Arcs from tiny to screen sized, over all the quadrants and past a full turn
+    float arc_error = 0.0f;
+    size_t arc_points = 0;
+    std::vector<ImVec2> arc(1024), reference_arc(1024);
+    for (int i = 0; i < 2000; i++){
+        const ImVec2 center(RandomFloat(0.0f, 1920.0f), RandomFloat(0.0f, 1080.0f));
+        const float radius = (i % 4 == 0) ? RandomFloat(0.5f, 10.0f) : RandomFloat(10.0f, 2000.0f);
+        const float a_min = RandomFloat(-2.0f * IM_PI, 2.0f * IM_PI);
+        const float a_max = a_min + RandomFloat(0.0f, 3.0f * IM_PI);
+        const int num_segments = 1 + rand() % 1000;
+        ImTessellateArcPoints(arc.data(), center, radius, a_min, a_max, num_segments);
+        ReferenceArcPoints(reference_arc.data(), center, radius, a_min, a_max, num_segments);
+        for (int n = 0; n <= num_segments; n++){
+            arc_error = std::max(arc_error, RelativeError(arc[n], reference_arc[n], std::max(fabsf(center.x), fabsf(center.y)) + radius));
+        }
+        arc_points += num_segments + 1;
+    }
+
+    float bezier_error = 0.0f;
+    std::vector<ImVec2> bezier(256), reference_bezier(256);
+    for (int i = 0; i < 2000; i++){
+        ImVec2 p[4];
+        for (ImVec2 & point: p){
+            point = ImVec2(RandomFloat(0.0f, 1920.0f), RandomFloat(0.0f, 1080.0f));
+        }
+        const int num_segments = 1 + rand() % 256;
+        ImTessellateBezierCubicPoints(bezier.data(), p[0], p[1], p[2], p[3], num_segments);
+        ReferenceBezierCubicPoints(reference_bezier.data(), p[0], p[1], p[2], p[3], num_segments);
+        for (int n = 0; n < num_segments; n++){
+            bezier_error = std::max(bezier_error, RelativeError(bezier[n], reference_bezier[n], 1920.0f));
+        }
+    }
+
+    // 1e-6 of the coordinates is about 8 ulps, and well under a thousandth of a pixel for anything on screen
+    const float tolerance = 1e-6f;
+    std::cout << "Max relative error: normals " << normal_error << ", miters " << miter_error << ", arcs " << arc_error << ", beziers " << bezier_error << std::endl;
+    if (normal_error > tolerance || miter_error > tolerance || arc_error > tolerance || bezier_error > tolerance){
+        std::cout << "The kernels differ from the reference by more than " << tolerance << "!" << std::endl;
+        return 1;
+    }
+    std::cout << "All kernels match the reference within " << tolerance << std::endl;
+
+    // The sums keep the compiler from optimizing the kernels away.
+    float sink = 0.0f;
+    double reference_normals_time = TimeNs(iterations, total_points, [&]{
+        for (const Polyline & polyline: polylines){
+            ReferenceSegmentNormals(polyline.points.data(), int(polyline.points.size()), int(polyline.points.size()), reference_normals.data());
+            sink += reference_normals[0].x;
+        }
+    });
+    double normals_time = TimeNs(iterations, total_points, [&]{
+        for (const Polyline & polyline: polylines){
+            ImTessellateSegmentNormals(polyline.points.data(), int(polyline.points.size()), int(polyline.points.size()), normals.data());
+            sink += normals[0].x;
+        }
+    });
+    double reference_miters_time = TimeNs(iterations, total_points, [&]{
+        for (const Polyline & polyline: polylines){
+            ReferenceMiterNormals(reference_normals.data(), int(polyline.points.size()), int(polyline.points.size()), reference_miters.data());
+            sink += reference_miters[0].x;
+        }
+    });
+    double miters_time = TimeNs(iterations, total_points, [&]{
+        for (const Polyline & polyline: polylines){
+            ImTessellateMiterNormals(reference_normals.data(), int(polyline.points.size()), int(polyline.points.size()), miters.data());
+            sink += miters[0].x;
+        }
+    });
+    double reference_arcs_time = TimeNs(iterations, 100 * 65, [&]{
+        for (int i = 0; i < 100; i++){
+            ReferenceArcPoints(reference_arc.data(), ImVec2(200.0f, 200.0f), 50.0f + i, 0.0f, 2.0f * IM_PI, 64);
+            sink += reference_arc[1].x;
+        }
+    });
+    double arcs_time = TimeNs(iterations, 100 * 65, [&]{
+        for (int i = 0; i < 100; i++){
+            ImTessellateArcPoints(arc.data(), ImVec2(200.0f, 200.0f), 50.0f + i, 0.0f, 2.0f * IM_PI, 64);
+            sink += arc[1].x;
+        }
+    });
+    double reference_beziers_time = TimeNs(iterations, 100 * 32, [&]{
+        for (int i = 0; i < 100; i++){
+            ReferenceBezierCubicPoints(reference_bezier.data(), ImVec2(0.0f, 0.0f), ImVec2(100.0f, float(i)), ImVec2(200.0f, 50.0f), ImVec2(300.0f, 0.0f), 32);
+            sink += reference_bezier[1].x;
+        }
+    });
+    double beziers_time = TimeNs(iterations, 100 * 32, [&]{
+        for (int i = 0; i < 100; i++){
+            ImTessellateBezierCubicPoints(bezier.data(), ImVec2(0.0f, 0.0f), ImVec2(100.0f, float(i)), ImVec2(200.0f, 50.0f), ImVec2(300.0f, 0.0f), 32);
+            sink += bezier[1].x;
+        }
+    });
+
+    std::cout << "Kernels (ns per point):" << std::endl;
+    std::cout << "  Normals: " << normals_time << " (reference " << reference_normals_time << ")" << std::endl;
+    std::cout << "  Miters:  " << miters_time << " (reference " << reference_miters_time << ")" << std::endl;
+    std::cout << "  Arcs:    " << arcs_time << " (reference " << reference_arcs_time << ")" << std::endl;
+    std::cout << "  Beziers: " << beziers_time << " (reference " << reference_beziers_time << ")" << std::endl;
+
+    // Whole shapes the way the stick and trigger visualizations draw them, through a draw list
+    ImGui::CreateContext();
+    ImGuiIO & io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+    unsigned char * pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    ImGui::NewFrame();
+
+    ImDrawList list(ImGui::GetDrawListSharedData());
+    const ImDrawListFlags modes[] = {ImDrawListFlags_None, ImDrawListFlags_AntiAliasedLines | ImDrawListFlags_AntiAliasedFill};
+    std::cout << "Draw list (ns per point):" << std::endl;
+    for (ImDrawListFlags mode: modes){
+        double shapes_time = TimeNs(iterations, 100 * (64 + 64 + 33), [&]{
+            list._ResetForNewFrame();
+            list.Flags = mode;
+            list.PushClipRectFullScreen();
+            list.PushTextureID(io.Fonts->TexID);
+            for (int i = 0; i < 100; i++){
+                const ImVec2 center(100.0f + i * 10.0f, 300.0f);
+                list.AddCircle(center, 60.0f, IM_COL32(255, 255, 255, 255), 64, 2.0f);
+                list.AddCircleFilled(ImVec2(center.x + 10.0f, center.y - 5.0f), 8.0f, IM_COL32(255, 0, 0, 255), 64);
+                list.AddBezierCubic(center, ImVec2(center.x + 40.0f, center.y - 80.0f), ImVec2(center.x + 80.0f, center.y + 80.0f), ImVec2(center.x + 120.0f, center.y), IM_COL32(0, 255, 0, 255), 3.0f, 32);
+            }
+            sink += list.VtxBuffer[0].pos.x;
+        });
+        std::cout << "  " << (mode ? "Anti-aliased" : "Aliased") << " circles, discs and curves: " << shapes_time << std::endl;
+    }
+
+    ImGui::EndFrame();
+    ImGui::DestroyContext();
+    return sink == 42.0f ? 2 : 0;
+}